@@ -30,22 +30,34 @@ AuthFilterWorker::set_customer_info(filter_info_t &filter, const SysDateTime &re
   return false;
 }
 
+// 트랩 번호는 원문의 destinationMdn만 읽고 판단한다.(messageInfo가 첫 섹션이므로 앞부분만 SAX로 읽음)
+// 트랩 결과도 전체 필터를 발행하므로 트랩 번호일때만 여기서 전체 파싱한다.
+bool
+AuthFilterWorker::pre_filter(filter_info_view &view, const std::string &subject, const SysDateTime &recv_time)
+{
+  ap_log.debug() << subject;
+
+  // ASIS: QUERY_TRAP_INFO
+  if (trap_info_list.contains(view.destination_mdn().str()) == false)
+    return false;
+
+  filter_info_t *filter = parse_message(view);
+  if (filter == nullptr || handle_discard(*filter, recv_time) == true)
+    return true;
+
+  filter->resultInfo.spamPattern1 = filter->messageInfo.destinationMdn;
+  to_result_nats(*filter, recv_time, SMPP_RESULT_SPAM, TRANS_RESULT_CODE_SPAM, F01_TRAP_CUST_SPAM);
+  return true;
+}
+
 void
 AuthFilterWorker::handle_filter(filter_info_t &filter, const std::string &subject, const SysDateTime &recv_time)
 {
-  ap_log.debug() << subject;
+  (void)subject;
 
   if (handle_discard(filter, recv_time) == true)
     return;
 
-  // ASIS: QUERY_TRAP_INFO
-  if (trap_info_list.contains(filter.messageInfo.destinationMdn) == true)
-  {
-    filter.resultInfo.spamPattern1 = filter.messageInfo.destinationMdn;
-    to_result_nats(filter, recv_time, SMPP_RESULT_SPAM, TRANS_RESULT_CODE_SPAM, F01_TRAP_CUST_SPAM);
-    return;
-  }
-
   // ASIS: QUERY_CUST_INFO
   if (set_customer_info(filter, recv_time) == false)
     return;
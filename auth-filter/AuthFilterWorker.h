@@ -18,6 +18,7 @@ public:
 
 protected:
   bool set_customer_info(filter_info_t &filter, const SysDateTime &recv_time);
+  bool pre_filter       (filter_info_view &view, const std::string &subject, const SysDateTime &recv_time) override;
   void handle_filter    (filter_info_t &filter, const std::string &subject, const SysDateTime &recv_time) override;
 
 protected:
@@ -5,6 +5,8 @@
 #include "NatsSenders.h"
 #include "AuthFilterRecvers.h"
 
+#include <FilterMetrics.h>
+
 #include <extra/StopWaiter.h>
 #include <csignal>
 #include <unistd.h>
@@ -26,32 +28,94 @@ int main(int argc, char** argv)
 //    return true;
 //  };
 
+  /// 배치 발행. max_count가 0이면(기본값) 사용안함
+  publish_batch_t sender_batch;
+  sender_batch.max_count  = app_conf.nats_sender_batch_max.load();
+  sender_batch.max_us     = app_conf.nats_sender_batch_us.load();
+  sender_batch.max_bytes  = app_conf.nats_sender_batch_bytes.load();
+
+  publish_batch_t result_batch;
+  result_batch.max_count  = app_conf.nats_result_batch_max.load();
+  result_batch.max_us     = app_conf.nats_result_batch_us.load();
+  result_batch.max_bytes  = app_conf.nats_result_batch_bytes.load();
+
+  /// ack 발행. window가 0이면(기본값) 사용안함
+  publish_ack_t sender_ack;
+  sender_ack.window         = app_conf.nats_sender_ack_window.load();
+  sender_ack.max_retries    = app_conf.nats_sender_ack_retries.load();
+  sender_ack.backoff_ms     = app_conf.nats_sender_ack_backoff_ms.load();
+  sender_ack.max_backoff_ms = app_conf.nats_sender_ack_max_backoff_ms.load();
+
+  publish_ack_t result_ack;
+  result_ack.window         = app_conf.nats_result_ack_window.load();
+  result_ack.max_retries    = app_conf.nats_result_ack_retries.load();
+  result_ack.backoff_ms     = app_conf.nats_result_ack_backoff_ms.load();
+  result_ack.max_backoff_ms = app_conf.nats_result_ack_max_backoff_ms.load();
+
   // 기동 순서
   // sender, result, recver
   nats_sender.set_publisher_num     (app_conf.nats_sender_num.load())           /// next filter(송신부) thread num
              .set_queue_size        (app_conf.nats_sender_queue.load())         /// queue size(lockfree queue)
+             .set_wait_strategy     (app_conf.nats_sender_wait.load())          /// idle wait strategy
+             .set_affinity          (app_conf.nats_sender_affinity.load())      /// cpu affinity
+             .set_batch             (sender_batch)                              /// batch publish
+             .set_backpressure      (app_conf.nats_sender_backpressure.load(),
+                                     app_conf.nats_sender_block_ms.load())      /// publish queue full policy
+             .set_select            (app_conf.nats_sender_select.load())        /// publisher selection
+             .set_ack               (sender_ack)                                /// acknowledged publish
              .set_server_urls       (app_conf.nats_sender_urls.load())          /// nats server urls
              .set_subject           (app_conf.nats_sender_subject.load());      /// interest subject
 
   nats_result.set_publisher_num     (app_conf.nats_result_num.load())           /// result_proc(송신부) thread num
              .set_queue_size        (app_conf.nats_result_queue.load())         /// queue size(lockfree queue)
+             .set_wait_strategy     (app_conf.nats_result_wait.load())          /// idle wait strategy
+             .set_affinity          (app_conf.nats_result_affinity.load())      /// cpu affinity
+             .set_batch             (result_batch)                              /// batch publish
+             .set_backpressure      (app_conf.nats_result_backpressure.load(),
+                                     app_conf.nats_result_block_ms.load())      /// publish queue full policy
+             .set_select            (app_conf.nats_result_select.load())        /// publisher selection
+             .set_ack               (result_ack)                                /// acknowledged publish
              .set_server_urls       (app_conf.nats_result_urls.load())          /// nats server urls
              .set_subject           (app_conf.nats_result_subject.load());      /// publish subject
 
+  /// 워커 수 자동조절. min/max가 같으면(기본값) 사용안함
+  AuthFilterWorkerPool::autoscale_t worker_autoscale;
+  worker_autoscale.min_workers  = app_conf.nats_recver_worker_min.load();
+  worker_autoscale.max_workers  = app_conf.nats_recver_worker_max.load();
+  worker_autoscale.grow_depth   = app_conf.nats_recver_worker_scale_depth.load();
+  worker_autoscale.grow_wait_us = app_conf.nats_recver_worker_scale_wait_us.load();
+  worker_autoscale.idle_sec     = app_conf.nats_recver_worker_scale_idle_sec.load();
+  worker_autoscale.wait_probe   = LatencyPercentileProbe(latency_queue_wait, 99);
+
   AuthFilterRecvers nats_recver;
   nats_recver.set_client_num        (app_conf.nats_recver_num.load())           /// nats client(수신부) thread num
              .set_server_urls       (app_conf.nats_recver_urls.load())          /// nats server urls
              .set_subject           (app_conf.nats_recver_subject.load())       /// interest subject
              .set_queue_group_name  (app_conf.nats_recver_group.load())         /// nats queue group name
              .set_worker_num        (app_conf.nats_recver_worker_num.load())    /// worker thread num
-             .set_worker_queue_size (app_conf.nats_recver_worker_queue.load()); /// worker queue size(lockfree queue)
+             .set_worker_queue_size (app_conf.nats_recver_worker_queue.load())  /// worker queue size(lockfree queue)
+             .set_worker_wait_strategy(app_conf.nats_recver_worker_wait.load()) /// worker idle wait strategy
+             .set_worker_stealing   (app_conf.nats_recver_worker_steal.load())  /// idle workers steal queued work
+             .set_worker_autoscale  (worker_autoscale)                          /// grow/shrink workers by queue depth
+             .set_recv_batch        (app_conf.nats_recver_batch_max.load(),     /// recv batch size
+                                     app_conf.nats_recver_full_wait.load(),     /// wait strategy when worker queues are full
+                                     app_conf.nats_recver_full_wait_ms.load())  /// max wait before queue full discard
+             .set_affinity          (app_conf.nats_recver_affinity.load(),      /// cpu affinity (nats callback, worker)
+                                     app_conf.nats_recver_worker_affinity.load());
+
+  FilterMetricsReporter metrics_reporter;
 
   SCOPE_EXIT(
   {
     /// 종료시 거꾸로. 로거는 끝까지 남아야.
     /// 모든 객체들은 stop을 호출하면 수신을 멈추고(unsubscribe)
     /// 수신전까지 가지고 있는 데이터를 처리 후 종료 후 종료됩니다.
+    /// 워커는 nats_recver.stop() 이후에도 살아있고 nats_recver가 파괴될때(이 블럭 이후) 정리됩니다.
+    /// 발행자는 남은 항목의 ack 완료 콜백으로 워커를 참조하므로 워커보다 먼저 멈춰야 합니다.
+    /// 폐기 결과(filter_discarder)는 워커를 참조하며 nats_result로 발행하므로 그 사이에 멈춥니다.
+    metrics_reporter.stop();
     nats_recver   .stop();
+    filter_discarder.stop();
     nats_result   .stop();
     nats_sender   .stop();
     trap_info_list.stop();
@@ -64,7 +128,9 @@ int main(int argc, char** argv)
   if (trap_info_list.start() == false) return -1;
   if (nats_sender   .start() == false) return -1;
   if (nats_result   .start() == false) return -1;
+  if (filter_discarder.start() == false) return -1;
   if (nats_recver   .start() == false) return -1;
+  metrics_reporter.start(app_conf.metrics_report_sec.load());
 
   ap_log.info() << "Start" << app_conf.procname;
 
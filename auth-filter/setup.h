@@ -29,6 +29,7 @@ setup_config(char **argv, int argc)
   if (app_conf.read(filename) == false)
     return false;
 
+  filter_logger_writer.set_affinity(app_conf.logger_affinity.load());
   Logger::start(app_conf.procname,
                 app_conf.log_error.load(),
                 app_conf.log_warn .load(),
@@ -7,7 +7,9 @@
 
 #include "AppConf.h"
 #include <Logger.h>
+#include <Transport.h>
 #include <extra/helper.h>
+#include <algorithm>
 #include <set>
 
 bool
@@ -66,41 +68,82 @@ AppConf::read(const std::string &filename, std::function<bool(const MJsonObject
       // receiver 설정 파싱
       nats.required("recv", [&](const MJsonObject &recv)
       {
-        std::set<std::string> url_arr;
-        recv.required_for("urls", [&](const MJsonArray &urls, size_t index) { url_arr.insert(urls[index].as_str()); });
-        nats_recver_urls    = std::vector<std::string>(url_arr.begin(), url_arr.end());
+        nats_recver_urls    = parse_urls(recv);
         nats_recver_subject = recv["subject"].as_string();
         nats_recver_group   = recv["group"  ].as_string();
         nats_recver_num     = recv["num"    ].as_uint32();
+        nats_recver_affinity= parse_affinity(recv);
+        nats_recver_batch_max = static_cast<uint32_t>(std::max(1, recv["batch_max"].as_int_or(64)));
+        nats_recver_full_wait = parse_wait_strategy(recv, "full_wait", wait_strategy_t::backoff);
+        nats_recver_full_wait_ms = static_cast<uint32_t>(std::max(0, recv["full_wait_ms"].as_int_or(100)));
 
         // worker 설정 파싱
         recv.required("worker", [&](const MJsonObject &worker)
         {
           nats_recver_worker_num  = worker["num"        ].as_uint32();
           nats_recver_worker_queue= worker["queue_size" ].as_uint32();
+          nats_recver_worker_wait = parse_wait_strategy(worker);
+          nats_recver_worker_steal= worker["work_stealing"].as_bool_or(false);
+
+          // autoscale (선택). min/max가 없으면 num 고정
+          int num = static_cast<int>(nats_recver_worker_num.load());
+          int min     = worker["min"           ].as_int_or(num);
+          int max     = worker["max"           ].as_int_or(num);
+          int depth   = worker["scale_depth"   ].as_int_or(1000);
+          int wait_us = worker["scale_wait_us" ].as_int_or(0);
+          int idle    = worker["scale_idle_sec"].as_int_or(60);
+          nats_recver_worker_min            = min     < 0 ? 0 : static_cast<uint32_t>(min    );
+          nats_recver_worker_max            = max     < 0 ? 0 : static_cast<uint32_t>(max    );
+          nats_recver_worker_scale_depth    = depth   < 1 ? 1 : static_cast<uint32_t>(depth  );
+          nats_recver_worker_scale_wait_us  = wait_us < 0 ? 0 : static_cast<uint32_t>(wait_us);
+          nats_recver_worker_scale_idle_sec = idle    < 1 ? 1 : static_cast<uint32_t>(idle   );
+
+          nats_recver_worker_affinity = parse_affinity(worker, "affinity", nats_recver_affinity.load());
         });
       });
 
       // next filter 설정 파싱
       nats.required("next", [&](const MJsonObject &next)
       {
-        std::set<std::string> url_arr;
-        next.required_for("urls", [&](const MJsonArray &urls, size_t index) { url_arr.insert(urls[index].as_str()); });
-        nats_sender_urls    = std::vector<std::string>(url_arr.begin(), url_arr.end());
+        nats_sender_urls    = parse_urls(next);
         nats_sender_subject = next["subject"    ].as_string();
         nats_sender_num     = next["num"        ].as_uint32();
         nats_sender_queue   = next["queue_size" ].as_uint32();
+        nats_sender_wait    = parse_wait_strategy(next);
+        nats_sender_affinity= parse_affinity(next, "affinity", nats_recver_worker_affinity.load());
+        nats_sender_format  = parse_wire_format(next);
+        nats_sender_batch_max   = parse_uint_or_zero(next, "batch_max"  );
+        nats_sender_batch_us    = parse_uint_or_zero(next, "batch_us"   );
+        nats_sender_batch_bytes = parse_uint_or_zero(next, "batch_bytes");
+        nats_sender_backpressure = parse_backpressure(next);
+        nats_sender_block_ms     = static_cast<uint32_t>(std::max(0, next["block_ms"].as_int_or(100)));
+        nats_sender_select       = parse_publisher_select(next);
+        nats_sender_ack_window         = parse_uint_or_zero(next, "ack_window");
+        nats_sender_ack_retries        = static_cast<uint32_t>(std::max(0, next["ack_retries"       ].as_int_or(3)));
+        nats_sender_ack_backoff_ms     = static_cast<uint32_t>(std::max(0, next["ack_backoff_ms"    ].as_int_or(10)));
+        nats_sender_ack_max_backoff_ms = static_cast<uint32_t>(std::max(0, next["ack_max_backoff_ms"].as_int_or(1000)));
       });
 
       // result 설정 파싱
       nats.required("result", [&](const MJsonObject &result)
       {
-        std::set<std::string> url_arr;
-        result.required_for("urls", [&](const MJsonArray &urls, size_t index) { url_arr.insert(urls[index].as_str()); });
-        nats_result_urls    = std::vector<std::string>(url_arr.begin(), url_arr.end());
+        nats_result_urls    = parse_urls(result);
         nats_result_subject = result["subject"    ].as_string();
         nats_result_num     = result["num"        ].as_uint32();
         nats_result_queue   = result["queue_size" ].as_uint32();
+        nats_result_wait    = parse_wait_strategy(result);
+        nats_result_affinity= parse_affinity(result, "affinity", nats_recver_worker_affinity.load());
+        nats_result_format  = parse_wire_format(result);
+        nats_result_batch_max   = parse_uint_or_zero(result, "batch_max"  );
+        nats_result_batch_us    = parse_uint_or_zero(result, "batch_us"   );
+        nats_result_batch_bytes = parse_uint_or_zero(result, "batch_bytes");
+        nats_result_backpressure = parse_backpressure(result);
+        nats_result_block_ms     = static_cast<uint32_t>(std::max(0, result["block_ms"].as_int_or(100)));
+        nats_result_select       = parse_publisher_select(result);
+        nats_result_ack_window         = parse_uint_or_zero(result, "ack_window");
+        nats_result_ack_retries        = static_cast<uint32_t>(std::max(0, result["ack_retries"       ].as_int_or(3)));
+        nats_result_ack_backoff_ms     = static_cast<uint32_t>(std::max(0, result["ack_backoff_ms"    ].as_int_or(10)));
+        nats_result_ack_max_backoff_ms = static_cast<uint32_t>(std::max(0, result["ack_max_backoff_ms"].as_int_or(1000)));
       });
 
       // discard 설정을 required()를 사용하여 파싱
@@ -110,9 +153,19 @@ AppConf::read(const std::string &filename, std::function<bool(const MJsonObject
         discard_queue_size  = discard["queue_size"  ].as_uint32();
         discard_tps_in      = discard["enqueue_tps" ].as_uint32();
         discard_tps_out     = discard["dequeue_tps" ].as_uint32();
+
+        int burst_in  = discard["enqueue_burst"].as_int_or(0);
+        int burst_out = discard["dequeue_burst"].as_int_or(0);
+        discard_burst_in    = burst_in  < 0 ? 0 : static_cast<uint32_t>(burst_in );
+        discard_burst_out   = burst_out < 0 ? 0 : static_cast<uint32_t>(burst_out);
       });
     });
 
+    // 선택 설정
+    int report_sec = config["metrics_report_sec"].as_int_or(10);
+    metrics_report_sec = report_sec < 0 ? 0 : static_cast<uint32_t>(report_sec);
+    logger_affinity    = parse_affinity(config, "logger_affinity", nats_recver_worker_affinity.load());
+
     config.required("log_level", [&](const MJsonObject &log_level)
     {
       log_error  = log_level["ERROR"].as_bool();
@@ -134,6 +187,91 @@ AppConf::read(const std::string &filename, std::function<bool(const MJsonObject
   }
 }
 
+wait_strategy_t
+AppConf::parse_wait_strategy(const MJsonObject &config, const std::string &key, const wait_strategy_t &fallback)
+{
+  std::string name = config[key].as_str_or(::to_string(fallback));
+
+  wait_strategy_t strategy = fallback;
+  if (to_wait_strategy(name, strategy) == false)
+    throw std::runtime_error("unknown " + key + ": " + name);
+
+  return strategy;
+}
+
+CpuAffinity
+AppConf::parse_affinity(const MJsonObject &config, const std::string &key, const CpuAffinity &producer)
+{
+  std::string spec = config[key].as_str_or("");
+
+  CpuAffinity affinity;
+  if (CpuAffinity::parse(spec, affinity) == false)
+    throw std::runtime_error("invalid " + key + ": " + spec);
+
+  // 생산자가 CPU를 지정하지 않으면 생산자가 어느 node에서 실행될지 알 수 없으므로 같은 node로 고정할 수 없다.
+  if (affinity.same_node_as(producer).policy() == CpuAffinity::policy_t::same_node)
+    throw std::runtime_error("invalid " + key + ": same_node requires the producer's affinity to be set to cpus");
+
+  return affinity;
+}
+
+wire_format_t
+AppConf::parse_wire_format(const MJsonObject &config)
+{
+  std::string name = config["format"].as_str_or("json");
+
+  wire_format_t format = wire_format_t::json;
+  if (to_wire_format(name, format) == false)
+    throw std::runtime_error("unknown format: " + name);
+
+  return format;
+}
+
+backpressure_t
+AppConf::parse_backpressure(const MJsonObject &config)
+{
+  std::string name = config["backpressure"].as_str_or("fail");
+
+  backpressure_t policy = backpressure_t::fail;
+  if (to_backpressure(name, policy) == false)
+    throw std::runtime_error("unknown backpressure: " + name);
+
+  return policy;
+}
+
+publisher_select_t
+AppConf::parse_publisher_select(const MJsonObject &config)
+{
+  std::string name = config["select"].as_str_or("round_robin");
+
+  publisher_select_t select = publisher_select_t::round_robin;
+  if (to_publisher_select(name, select) == false)
+    throw std::runtime_error("unknown select: " + name);
+
+  return select;
+}
+
+std::vector<std::string>
+AppConf::parse_urls(const MJsonObject &config)
+{
+  std::set<std::string> url_arr;
+  config.required_for("urls", [&](const MJsonArray &urls, size_t index) { url_arr.insert(urls[index].as_str()); });
+
+  // Transport는 첫번째 URL로 고르므로(make_transport) 같은 호스트용 URL은 하나만 설정해야 한다.
+  for (const auto &url : url_arr)
+    if (url_arr.size() > 1 && is_local_url(url) == true)
+      throw std::runtime_error("local url must be the only url: " + url);
+
+  return std::vector<std::string>(url_arr.begin(), url_arr.end());
+}
+
+uint32_t
+AppConf::parse_uint_or_zero(const MJsonObject &config, const std::string &key)
+{
+  int value = config[key].as_int_or(0);
+  return value < 0 ? 0 : static_cast<uint32_t>(value);
+}
+
 AppConf::db_config_t
 AppConf::get_next_db_config(const std::string &curr_url) const
 {
@@ -13,6 +13,10 @@
 #include <extra/Singleton.h>
 #include <extra/LockedObject.h>
 #include <extra/helper.h>
+#include <extra/WaitStrategy.h>
+#include <extra/CpuAffinity.h>
+#include <extra/BinaryCodec.h>
+#include <PublishPolicy.h>
 #include <cstdlib>
 
 /***
@@ -57,23 +61,66 @@ public:
   LockedObject<std::string> nats_recver_subject;
   LockedObject<std::string> nats_recver_group;
   std::atomic<uint32_t>     nats_recver_num;
+  LockedObject<CpuAffinity> nats_recver_affinity;       ///< NATS 수신 콜백 쓰레드. same_node 불가(생산자가 NATS 라이브러리)
+  std::atomic<uint32_t>     nats_recver_batch_max{64};   ///< 수신 배치: 한번에 워커풀에 넣는 최대 건수
+  std::atomic<wait_strategy_t> nats_recver_full_wait{wait_strategy_t::backoff}; ///< 워커큐가 꽉 찼을때 수신 쓰레드 대기방식
+  std::atomic<uint32_t>     nats_recver_full_wait_ms{100}; ///< 워커큐가 꽉 찼을때 최대 대기시간(ms), 지나면 폐기 결과(queue full)
   std::atomic<uint32_t>     nats_recver_worker_num;
   std::atomic<uint32_t>     nats_recver_worker_queue;
+  std::atomic<wait_strategy_t> nats_recver_worker_wait{wait_strategy_t::adaptive};
+  std::atomic<bool>         nats_recver_worker_steal{false}; ///< 워커간 작업 훔치기
+  std::atomic<uint32_t>     nats_recver_worker_min{0};       ///< autoscale 최소 워커 수 (기본값: num)
+  std::atomic<uint32_t>     nats_recver_worker_max{0};       ///< autoscale 최대 워커 수 (기본값: num, min 이하이면 사용안함)
+  std::atomic<uint32_t>     nats_recver_worker_scale_depth{1000};   ///< 워커당 평균 큐 깊이가 이 값 이상이면 워커 추가
+  std::atomic<uint32_t>     nats_recver_worker_scale_wait_us{0};    ///< 큐 대기시간 p99(us)가 이 값 이상이면 워커 추가. 0이면 사용안함
+  std::atomic<uint32_t>     nats_recver_worker_scale_idle_sec{60};  ///< 큐가 계속 비어있으면 이 시간마다 워커 회수
+  LockedObject<CpuAffinity> nats_recver_worker_affinity; ///< same_node : 수신 쓰레드의 node
 
   LockedObject<std::vector<std::string>> nats_sender_urls;
   LockedObject<std::string> nats_sender_subject;
   std::atomic<uint32_t>     nats_sender_num;
   std::atomic<uint32_t>     nats_sender_queue;
+  std::atomic<wait_strategy_t> nats_sender_wait{wait_strategy_t::adaptive};
+  LockedObject<CpuAffinity> nats_sender_affinity;       ///< same_node : 워커의 node
+  std::atomic<wire_format_t> nats_sender_format{wire_format_t::json}; ///< 다음 필터로 보내는 형식. 받는쪽은 둘 다 받음
+  std::atomic<uint32_t>     nats_sender_batch_max  {0}; ///< 배치 발행 최대 건수, 0이면 사용안함
+  std::atomic<uint32_t>     nats_sender_batch_us   {0}; ///< 배치를 모으는 최대 시간(us)
+  std::atomic<uint32_t>     nats_sender_batch_bytes{0}; ///< 모은 크기가 이 값 이상이면 바로 발행, 0이면 제한없음
+  std::atomic<backpressure_t> nats_sender_backpressure{backpressure_t::fail}; ///< 발행큐가 꽉 찼을때: fail, block, spill
+  std::atomic<uint32_t>     nats_sender_block_ms{100};      ///< backpressure가 block일때 최대 대기시간(ms)
+  std::atomic<publisher_select_t> nats_sender_select{publisher_select_t::round_robin}; ///< round_robin, worker_affine, least_depth
+  std::atomic<uint32_t>     nats_sender_ack_window{0};          ///< ack 대기 최대 건수, 0이면 사용안함
+  std::atomic<uint32_t>     nats_sender_ack_retries{3};         ///< ack 실패시 재시도 횟수
+  std::atomic<uint32_t>     nats_sender_ack_backoff_ms{10};     ///< 첫 재시도 대기시간(ms), 재시도마다 2배
+  std::atomic<uint32_t>     nats_sender_ack_max_backoff_ms{1000}; ///< 재시도 최대 대기시간(ms)
 
   LockedObject<std::vector<std::string>> nats_result_urls;
   LockedObject<std::string> nats_result_subject;
   std::atomic<uint32_t>     nats_result_num;
   std::atomic<uint32_t>     nats_result_queue;
+  std::atomic<wait_strategy_t> nats_result_wait{wait_strategy_t::adaptive};
+  LockedObject<CpuAffinity> nats_result_affinity;       ///< same_node : 워커의 node
+  std::atomic<wire_format_t> nats_result_format{wire_format_t::json}; ///< 결과 처리로 보내는 형식
+  std::atomic<uint32_t>     nats_result_batch_max  {0}; ///< 배치 발행 최대 건수, 0이면 사용안함
+  std::atomic<uint32_t>     nats_result_batch_us   {0}; ///< 배치를 모으는 최대 시간(us)
+  std::atomic<uint32_t>     nats_result_batch_bytes{0}; ///< 모은 크기가 이 값 이상이면 바로 발행, 0이면 제한없음
+  std::atomic<backpressure_t> nats_result_backpressure{backpressure_t::fail}; ///< 발행큐가 꽉 찼을때: fail, block, spill
+  std::atomic<uint32_t>     nats_result_block_ms{100};      ///< backpressure가 block일때 최대 대기시간(ms)
+  std::atomic<publisher_select_t> nats_result_select{publisher_select_t::round_robin}; ///< round_robin, worker_affine, least_depth
+  std::atomic<uint32_t>     nats_result_ack_window{0};          ///< ack 대기 최대 건수, 0이면 사용안함
+  std::atomic<uint32_t>     nats_result_ack_retries{3};         ///< ack 실패시 재시도 횟수
+  std::atomic<uint32_t>     nats_result_ack_backoff_ms{10};     ///< 첫 재시도 대기시간(ms), 재시도마다 2배
+  std::atomic<uint32_t>     nats_result_ack_max_backoff_ms{1000}; ///< 재시도 최대 대기시간(ms)
 
   std::atomic<uint32_t>     discard_timeout_ms{3000};
   std::atomic<uint32_t>     discard_queue_size{1000};
   std::atomic<uint32_t>     discard_tps_in    {1000};
   std::atomic<uint32_t>     discard_tps_out   {1000};
+  std::atomic<uint32_t>     discard_burst_in  {0};    ///< 순간 허용 건수, 0이면 discard_tps_in
+  std::atomic<uint32_t>     discard_burst_out {0};    ///< 순간 허용 건수, 0이면 discard_tps_out
+
+  std::atomic<uint32_t>     metrics_report_sec{10};  ///< 처리량/지연시간 출력 주기(초), 0이면 출력 안함
+  LockedObject<CpuAffinity> logger_affinity;         ///< 로그 출력 쓰레드. same_node : 워커의 node
 
   std::atomic<bool> log_error{true};
   std::atomic<bool> log_warn {true};
@@ -95,6 +142,30 @@ public:
   std::string to_string         () const { return config_str_.load(); }
 
 protected:
+  /// 선택 설정. 없으면 fallback(adaptive), 모르는 이름이면 예외
+  static wait_strategy_t parse_wait_strategy(const MJsonObject &config, const std::string &key = "wait_strategy",
+                                             const wait_strategy_t &fallback = wait_strategy_t::adaptive);
+
+  /// 선택 설정. 없으면 고정하지 않음, 형식 오류이면 예외. @see CpuAffinity::parse
+  /// same_node는 producer(이 쓰레드에 넣는 쓰레드)가 CPU를 지정한 경우에만 그 node의 CPU들로 바뀌며, 아니면 예외
+  static CpuAffinity     parse_affinity(const MJsonObject &config, const std::string &key = "affinity",
+                                        const CpuAffinity &producer = CpuAffinity());
+
+  /// 선택 설정. 없으면 json, 모르는 이름이면 예외
+  static wire_format_t   parse_wire_format(const MJsonObject &config);
+
+  /// 선택 설정. 없으면 fail, 모르는 이름이면 예외
+  static backpressure_t  parse_backpressure(const MJsonObject &config);
+
+  /// 선택 설정. 없으면 round_robin, 모르는 이름이면 예외
+  static publisher_select_t parse_publisher_select(const MJsonObject &config);
+
+  /// 필수 설정. 중복은 제거, loopback://, shm:// 을 다른 URL과 같이 설정하면 예외
+  static std::vector<std::string> parse_urls(const MJsonObject &config);
+
+  /// 선택 설정. 없거나 음수이면 0
+  static uint32_t        parse_uint_or_zero(const MJsonObject &config, const std::string &key);
+
   LockedObject<std::string> config_str_;
 };
 
@@ -0,0 +1,77 @@
+#include "FilterDiscarder.h"
+
+#include <FilterWorker.h>
+
+constexpr size_t FilterDiscarder::queue_size;
+
+int
+FilterDiscarder::push(const FilterWorker *worker, filter_info_view &view, const SysDateTime &recv_time, const discard_reason_t &reason)
+{
+  queueable_t<discard_item_t> item(pool_, discard_item_t(std::move(view), recv_time, reason, worker));
+
+  int res = waiter_.push(item);
+  if (res == 0)
+    return 0;
+
+  // 폐기 결과를 버리지 않도록 호출한 쓰레드에서 발행한다.(수신 쓰레드가 느려지지만 결과는 모두 전달)
+  inlined_.fetch_add(1, std::memory_order_relaxed);
+  if (inline_toggle_.turn_on() == true)
+    sfs_log.error() << "discard queue " << (res == EAGAIN ? "full" : "closed") << ", publishing discard results on the receive thread";
+
+  auto &queued = std::get<0>(*(item.get()));
+  if (publish(queued, recv_time, reason, worker) == false)
+    sfs_log.error() << queued.error();
+
+  item.destroy();
+  return res;
+}
+
+bool
+FilterDiscarder::publish(filter_info_view &view, const SysDateTime &recv_time, const discard_reason_t &reason, const FilterWorker *worker)
+{
+  filter_info_t *filter = view.mutate();
+  if (filter == nullptr)
+    return false;
+
+  worker->discard(*filter, recv_time, reason);
+  return true;
+}
+
+void
+FilterDiscarder::run()
+{
+  queueable_t<discard_item_t> queueable_items[bulk_size];
+
+  sfs_log.info() << "Start FilterDiscarder";
+
+  int count = 0;
+  while ((count = waiter_.pop_bulk(queueable_items, bulk_size)) >= 0)
+  {
+    for (int index = 0; index < count; ++index)
+    {
+      auto item = queueable_items[index].take();
+
+      auto &tuple     = *(item.get()); ///< 복사하지 않고 풀 블럭의 객체를 직접 사용
+      auto &view      = std::get<0>(tuple);
+      auto &recv_time = std::get<1>(tuple);
+      auto &reason    = std::get<2>(tuple);
+      auto &worker    = std::get<3>(tuple);
+
+      // 수신 쓰레드는 수신번호까지만 확인하므로 그 뒤쪽의 형식 오류는 여기서 확인된다.
+      if (publish(view, recv_time, reason, worker) == false)
+      {
+        error_toggle_.turn_on();
+        sfs_log.error() << view.error();
+        continue;
+      }
+
+      if (error_toggle_.turn_off() == true)
+        sfs_log.info() << "discard JSON parse error cleared.";
+    }
+
+    if (count > 0 && inline_toggle_.turn_off() == true)
+      sfs_log.info() << "discard queue recovered. inlined:" << inlined();
+  }
+
+  sfs_log.info() << "Stop FilterDiscarder inlined:" << inlined();
+}
@@ -0,0 +1,86 @@
+/*
+ * FilterDiscarder.h
+ *
+ *  Created on: 2025. 3. 27.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <Logger.h>
+#include <queueable.h>
+#include <filter_info_view.h>
+#include <extra/LockFreeQueueThread.h>
+#include <extra/SysDateTime.h>
+#include <extra/Singleton.h>
+#include <extra/Toggle.h>
+#include <atomic>
+#include <tuple>
+
+class FilterWorker;
+
+/// 워커에 넘기지 못하고 폐기 결과만 보내는 사유
+enum class discard_reason_t : uint8_t
+{
+  tps_in,     ///< 유입 제어(admission_in) 거절 -> FilterWorker::discard_tps_in
+  queue_full, ///< 워커큐 꽉 참 -> FilterWorker::discard_queue_full
+};
+
+/// 원문(지연 파싱), 수신시간, 사유, 폐기 결과를 만들 워커
+using discard_item_t = std::tuple<filter_info_view, SysDateTime, discard_reason_t, const FilterWorker *>;
+
+#define filter_discarder FilterDiscarder::ref()
+
+/**
+ * @class FilterDiscarder
+ * @brief 워커에 넘기지 않은 메세지의 폐기 결과를 발행하는 쓰레드 (프로세스에 하나)
+ * @details
+ * 유입 제어에서 거절된 메세지나 워커큐가 꽉 차서 넘기지 못한 메세지는 원문 그대로 여기에 넣습니다.
+ * 수신 쓰레드는 전체 파싱하지 않고, 워커큐 자리와 워커 시간도 쓰지 않으므로 과부하일때 부하를 덜어냅니다.
+ * 이 쓰레드가 전체 파싱을 한번 하고 넣은 워커의 discard_tps_in / discard_queue_full로 결과를 발행합니다.
+ *
+ * 이 큐도 꽉 찼거나 시작하지 않은(멈춘) 경우에는 호출한 쓰레드에서 바로 파싱하고 폐기 결과를 발행합니다.(이전 push와 같음)
+ * 폐기 결과는 버리지 않으며, 호출 쓰레드에서 발행한 건수만 셉니다.(inlined, 에러로그는 처음 한번)
+ * 큐가 비었을때는 park로 대기합니다.(과부하일때만 일하는 쓰레드이므로)
+ *
+ * 워커를 참조하므로 종료시 수신(NatsRecvers) stop -> FilterDiscarder stop -> 발행자 stop 순서로 멈춥니다.
+ */
+class FilterDiscarder : public LockFreeQueueThread<false, queueable_t<discard_item_t>, queue_backend::bounded_ring>,
+                        public Singleton<FilterDiscarder>
+{
+public:
+  using Base = LockFreeQueueThread<false, queueable_t<discard_item_t>, queue_backend::bounded_ring>;
+
+  static constexpr size_t queue_size = 8192;
+
+  FilterDiscarder()
+  : Base(queue_size), pool_(waiter_.capacity() + bulk_size), inline_toggle_(false, true), error_toggle_(false, false)
+  {
+    set_wait_strategy(wait_strategy_t::park);
+  }
+
+  /**
+   * @brief 폐기 결과 발행 요청. view는 이동됩니다.
+   * @details 큐가 꽉 찼거나 닫혔으면 호출한 쓰레드에서 바로 발행합니다.
+   * @return 0 : 적재, EAGAIN : 꽉 차서 바로 발행, -1 : 시작하지 않았거나 멈춰서 바로 발행
+   */
+  int push(const FilterWorker *worker, filter_info_view &view, const SysDateTime &recv_time, const discard_reason_t &reason);
+
+  /// 큐에 넣지 못하고 호출한 쓰레드에서 발행한 건수 (누적)
+  uint64_t inlined() const { return inlined_.load(std::memory_order_relaxed); }
+
+protected:
+  void run() override;
+
+  /**
+   * @brief 전체 파싱 후 worker의 폐기 결과 발행
+   * @return false : 파싱 오류 (view.error())
+   */
+  static bool publish(filter_info_view &view, const SysDateTime &recv_time, const discard_reason_t &reason, const FilterWorker *worker);
+
+protected:
+  queueable_pool_t<discard_item_t> pool_;
+  std::atomic<uint64_t>            inlined_{0};
+  Toggle                           inline_toggle_; ///< 수신 쓰레드들에서 호출되므로 lock 사용
+  Toggle                           error_toggle_;  ///< 이 쓰레드 전용
+};
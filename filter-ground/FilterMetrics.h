@@ -0,0 +1,160 @@
+/*
+ * FilterMetrics.h
+ *
+ *  Created on: 2025. 3. 12.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <FilterTpsMeter.h>
+#include <NatsSenders.h>
+#include <FilterDiscarder.h>
+#include <Logger.h>
+#include <extra/MThread.h>
+#include <extra/MSignal.h>
+#include <extra/helper.h>
+#include <atomic>
+
+/**
+ * @class FilterMetricsReporter
+ * @brief 처리량과 구간별 지연시간을 주기적으로 로그에 출력하는 쓰레드
+ * @details
+ * 출력 항목
+ *  - in/out tps : 1초(순간), 10초/60초 평균
+ *  - 지연시간(us, 지난 출력 이후 구간의 p50/p99/max)
+ *    recv_enqueue  : NATS 콜백 수신 -> 워커큐 적재
+ *    queue_wait    : 워커큐 적재 -> 워커 꺼냄
+ *    handle_filter : handle_filter 처리(발행큐 적재 포함)
+ *    publish_next  : 발행큐 적재 -> NATS publish (next)
+ *    publish_result: 발행큐 적재 -> NATS publish (result)
+ *  - 배치 발행시 배치당 건수(next_batch, result_batch). 배치를 사용하지 않으면 n=0
+ *  - 발행큐가 꽉 찬 경우의 처리 건수(next_full, result_full). @see NatsPublisherPool::backpressure_stats_t
+ *  - 폐기 결과를 수신 쓰레드에서 발행한 건수(discard_inline). @see FilterDiscarder
+ *  - ack 발행시 발행자별 큐 깊이, in-flight, ack 건수/지연시간(next_ack, result_ack). @see publisher_stats_t
+ *
+ * 기록은 각 지점에서 lock-free로 이루어지며, 이 쓰레드는 주기마다 스냅샷을 읽기만 합니다.
+ *
+ * example)
+ *  FilterMetricsReporter metrics;
+ *  metrics.start(10);  // 10초마다 출력, 0이면 출력하지 않음
+ *  ...
+ *  metrics.stop();
+ */
+class FilterMetricsReporter : public MThread
+{
+public:
+  ~FilterMetricsReporter() { stop(); }
+
+  bool start(const uint32_t &period_sec)
+  {
+    if (period_sec == 0)
+      return true;
+
+    period_ms_ = period_sec * 1000;
+    running_   = true;
+    return MThread::start();
+  }
+
+  bool stop()
+  {
+    if (running_.exchange(false) == false)
+      return true;
+
+    signal_.notify_one();
+    return MThread::join();
+  }
+
+protected:
+  void run() override
+  {
+    while (running_.load() == true)
+    {
+      signal_.wait(period_ms_);
+      if (running_.load() == false)
+        break;
+
+      sfs_log.info() << report();
+    }
+  }
+
+  std::string report()
+  {
+    return "metrics:"
+           " in("             + tps_to_string(tps_meter_in )                               + ")"
+           " out("            + tps_to_string(tps_meter_out)                               + ")"
+           " recv_enqueue("   + interval(latency_recv_enqueue,         prev_recv_enqueue_  ) + ")"
+           " queue_wait("     + interval(latency_queue_wait,           prev_queue_wait_    ) + ")"
+           " handle_filter("  + interval(latency_handle_filter,        prev_handle_filter_ ) + ")"
+           " publish_next("   + interval(nats_sender.publish_latency(), prev_publish_next_  ) + ")"
+           " publish_result(" + interval(nats_result.publish_latency(), prev_publish_result_) + ")"
+           " next_batch("     + interval(nats_sender.publish_batch_size(), prev_next_batch_, "") + ")"
+           " result_batch("   + interval(nats_result.publish_batch_size(), prev_result_batch_, "") + ")"
+           " next_full("      + interval(nats_sender.backpressure_stats(), prev_next_full_    ) + ")"
+           " result_full("    + interval(nats_result.backpressure_stats(), prev_result_full_  ) + ")"
+           " discard_inline(" + interval(filter_discarder.inlined(),       prev_discard_inline_) + ")"
+           + (nats_sender.ack_enabled() ? " next_ack("   + interval(nats_sender.publisher_stats(), prev_next_ack_  ) + ")" : "")
+           + (nats_result.ack_enabled() ? " result_ack(" + interval(nats_result.publisher_stats(), prev_result_ack_) + ")" : "");
+  }
+
+  static std::string tps_to_string(MultiTpsMeter &meter)
+  {
+    return "tps="  + std::to_string(meter.get_tps())
+         + " 10s=" + to_stringf(meter.get_tps_10s(), "%.1f")
+         + " 60s=" + to_stringf(meter.get_tps_60s(), "%.1f");
+  }
+
+  /// 지난 출력 이후 구간의 통계
+  static std::string interval(const LatencyHistogram &histogram, LatencyHistogram::snapshot_t &prev, const char *unit = "us")
+  {
+    auto curr = histogram.snapshot();
+    auto diff = curr - prev;
+    prev = std::move(curr);
+    return diff.to_string(unit);
+  }
+
+  /// 발행자별 구간 통계. 발행자 수가 바뀌면(재시작) 누적값으로 출력
+  static std::string interval(const std::vector<publisher_stats_t> &curr, std::vector<publisher_stats_t> &prev)
+  {
+    prev.resize(curr.size());
+
+    std::string result;
+    for (size_t index = 0; index < curr.size(); ++index)
+      result += (index == 0 ? "" : ", ") + (curr[index] - prev[index]).to_string();
+
+    prev = curr;
+    return result;
+  }
+
+  static std::string interval(const uint64_t &curr, uint64_t &prev)
+  {
+    auto diff = curr - prev;
+    prev = curr;
+    return std::to_string(diff);
+  }
+
+  static std::string interval(const NatsPublisherPool::backpressure_stats_t &curr, NatsPublisherPool::backpressure_stats_t &prev)
+  {
+    auto diff = curr - prev;
+    prev = curr;
+    return diff.to_string();
+  }
+
+protected:
+  std::atomic<bool> running_{false};
+  uint32_t          period_ms_ = 10000;
+  MSignal           signal_;
+
+  LatencyHistogram::snapshot_t prev_recv_enqueue_;
+  LatencyHistogram::snapshot_t prev_queue_wait_;
+  LatencyHistogram::snapshot_t prev_handle_filter_;
+  LatencyHistogram::snapshot_t prev_publish_next_;
+  LatencyHistogram::snapshot_t prev_publish_result_;
+  LatencyHistogram::snapshot_t prev_next_batch_;
+  LatencyHistogram::snapshot_t prev_result_batch_;
+  NatsPublisherPool::backpressure_stats_t prev_next_full_;
+  NatsPublisherPool::backpressure_stats_t prev_result_full_;
+  uint64_t                                prev_discard_inline_ = 0;
+  std::vector<publisher_stats_t>          prev_next_ack_;
+  std::vector<publisher_stats_t>          prev_result_ack_;
+};
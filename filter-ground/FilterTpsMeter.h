@@ -8,12 +8,32 @@
 #pragma once
 
 #include <extra/TpsMeter.h>
+#include <extra/LatencyHistogram.h>
+#include <extra/TokenBucket.h>
 #include <extra/Singleton.h>
 
 #define tps_meter_in  TpsMeterIn ::ref()
 #define tps_meter_out TpsMeterOut::ref()
 
-class TpsMeterIn  : public TpsMeter, public Singleton<TpsMeterIn> {};
-class TpsMeterOut : public TpsMeter, public Singleton<TpsMeterOut> {};
+class TpsMeterIn  : public MultiTpsMeter, public Singleton<TpsMeterIn> {};
+class TpsMeterOut : public MultiTpsMeter, public Singleton<TpsMeterOut> {};
 
+/// 유입 제어 (discard_tps_in / discard_tps_out). @see TokenBucket
+#define admission_in  AdmissionIn ::ref()
+#define admission_out AdmissionOut::ref()
 
+class AdmissionIn   : public TokenBucket, public Singleton<AdmissionIn > {};
+class AdmissionOut  : public TokenBucket, public Singleton<AdmissionOut> {};
+
+/// 구간별 지연시간(us)
+/// 수신(NATS 콜백) -> 워커큐 적재
+/// 워커큐 적재 -> 워커 꺼냄(큐 대기)
+/// handle_filter 처리시간
+/// 발행큐 적재 -> NATS publish 는 NatsPublisherPool::publish_latency() 참조
+#define latency_recv_enqueue  LatencyRecvEnqueue ::ref()
+#define latency_queue_wait    LatencyQueueWait   ::ref()
+#define latency_handle_filter LatencyHandleFilter::ref()
+
+class LatencyRecvEnqueue  : public LatencyHistogram, public Singleton<LatencyRecvEnqueue > {};
+class LatencyQueueWait    : public LatencyHistogram, public Singleton<LatencyQueueWait   > {};
+class LatencyHandleFilter : public LatencyHistogram, public Singleton<LatencyHandleFilter> {};
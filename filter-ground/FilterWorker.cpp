@@ -6,34 +6,48 @@
 #include <extra/SysDateTimeDiff.h>
 #include <extra/ThreadUniqueIndexer.h>
 
+thread_local bool FilterWorker::handle_discard_ = false;
+
 void
 FilterWorker::run()
 {
-  queueable_t<std::tuple<std::string, filter_info_t, SysDateTime>> queueable_item; // = 0;
+  queueable_t<std::tuple<std::string, filter_info_view, SysDateTime, std::chrono::steady_clock::time_point>> queueable_items[bulk_size];
 
   sfs_log.info() << "Start FilterWorker:" << assigned_no_str();
 
-  // 0 : 정상수신
+  // worker_affine인 경우 이 워커의 발행은 항상 같은 발행자(같은 NATS 연결)로 나간다.
+  NatsPublisherPool::bind_worker(publish_key_);
+
+  // 양수 : 꺼낸 개수
   // -1 : 큐 닫힘
-  while (waiter_.pop(queueable_item) == 0)
+  // 풀에서 work_stealing이 설정된 경우 자신의 큐가 비면 다른 워커의 큐에서 가져옵니다.
+  int count = 0;
+  while ((count = pop_or_steal(queueable_items, bulk_size)) > 0)
   {
-    handle_discard_ = false;
-    auto item = queueable_item.take();
-
-    auto tuple      = *(item.get());
-    auto &subject   = std::get<0>(tuple);
-    auto &filter    = std::get<1>(tuple);
-    auto &recv_time = std::get<2>(tuple);
-
-    SCOPE_EXIT({
-      if (handle_discard_ == true) return;
-      tps_meter_out.add_transaction();
-    });
-
-    handle_filter(filter, subject, recv_time);
+    for (int index = 0; index < count; ++index)
+    {
+      handle_discard_ = false;
+      auto item = queueable_items[index].take();
+
+      auto &tuple     = *(item.get()); ///< 복사하지 않고 풀 블럭의 객체를 직접 사용
+      auto &subject   = std::get<0>(tuple);
+      auto &view      = std::get<1>(tuple);
+      auto &recv_time = std::get<2>(tuple);
+
+      auto dequeue_time = std::chrono::steady_clock::now();
+      latency_queue_wait.record(std::get<3>(tuple), dequeue_time);
+
+      SCOPE_EXIT({
+        latency_handle_filter.record_since(dequeue_time);
+        if (handle_discard_ == true) return;
+        tps_meter_out.add_transaction();
+      });
+
+      handle_view(view, subject, recv_time);
+    }
   } // end of while
 
-  sfs_log.info() << "Stop FilterWorker:" << assigned_no_str();
+  sfs_log.info() << "Stop FilterWorker:" << assigned_no_str() << " stolen:" << stolen();
 }
 
 void
@@ -55,78 +69,227 @@ FilterWorker::to_result_nats(filter_info_t &filter,  const SysDateTime &recv_tim
   result.reasonCode = reason_code;
 
   set_filtering_time(result.filteringTime, recv_time);
+
+  wire_format_t format  = get_app_conf().nats_result_format.load();
+  std::string   payload = to_wire(filter, format); ///< JSON이면 로그와 발행에 같이 사용
   sfs_log.info() << "out tps:" << (handle_discard_ ? tps_meter_out.get_tps() : tps_meter_out.get_tps()+1) << ":result nats:"
-                 << (filter_logger_debug_on ? get_app_conf().nats_sender_subject.load()+" "+to_json(filter) : get_app_conf().nats_sender_subject.load());
-  nats_result.publish(to_json(filter));
+                 << (filter_logger_debug_on ? get_app_conf().nats_sender_subject.load()+" "+(format == wire_format_t::json ? payload : to_json(filter))
+                                            : get_app_conf().nats_sender_subject.load());
+  check_published(nats_result.publish(std::move(payload), "", completion("result", nats_result)), "result");
 }
 
 void
 FilterWorker::to_next_nats(filter_info_t &filter, const SysDateTime &recv_time) const
 {
   set_filtering_time(filter.resultInfo.filteringTime, recv_time);
+
+  wire_format_t format  = get_app_conf().nats_sender_format.load();
+  std::string   payload = to_wire(filter, format); ///< JSON이면 로그와 발행에 같이 사용
   sfs_log.info() << "out tps:" << tps_meter_out.get_tps()+1 << ":next nats:"
-                 << (filter_logger_debug_on ? get_app_conf().nats_sender_subject.load()+" "+to_json(filter) : get_app_conf().nats_sender_subject.load());
-  nats_sender.publish(to_json(filter));
+                 << (filter_logger_debug_on ? get_app_conf().nats_sender_subject.load()+" "+(format == wire_format_t::json ? payload : to_json(filter))
+                                            : get_app_conf().nats_sender_subject.load());
+  check_published(nats_sender.publish(std::move(payload), "", completion("next", nats_sender)), "next");
 }
 
-Optional<filter_info_t>
-FilterWorker::parse_message(const std::string &message) const
+void
+FilterWorker::check_published(const int &res, const char *target) const
+{
+  if (res != 0)
+  {
+    if (publish_toggle_.turn_on() == true)
+      sfs_log.error() << target << " nats publish failed:" << (res == ETIMEDOUT ? "timed out" : res == EAGAIN ? "queue full" : "closed");
+    return;
+  }
+
+  if (publish_toggle_.turn_off() == true)
+    sfs_log.info() << target << " nats publish recovered.";
+}
+
+void
+FilterWorker::on_published(const char *target, const int &status) const
+{
+  if (status != 0)
+  {
+    if (ack_toggle_.turn_on() == true)
+      sfs_log.error() << target << " nats ack failed";
+    return;
+  }
+
+  if (ack_toggle_.turn_off() == true)
+    sfs_log.info() << target << " nats ack recovered.";
+}
+
+filter_info_t *
+FilterWorker::parse_message(filter_info_view &view) const
 {
-  auto filter = from_filter_info_json(message);
-  if (filter == false)
+  filter_info_t *filter = view.mutate();
+  if (filter == nullptr)
   {
     error_toggle_.turn_on();
-    sfs_log.error() << filter.error();
-    return nullopt;
+    sfs_log.error() << view.error();
+    return nullptr;
   }
 
   if (error_toggle_.turn_off() == true)
     sfs_log.info() << "JSON parse error cleared.";
 
-  return filter.value();
+  return filter;
+}
+
+Optional<filter_info_t>
+FilterWorker::parse_message(const std::string &message) const
+{
+  filter_info_view view(message);
+  filter_info_t   *filter = parse_message(view);
+  if (filter == nullptr)
+    return nullopt;
+
+  return std::move(*filter);
+}
+
+void
+FilterWorker::handle_view(filter_info_view &view, const std::string &subject, const SysDateTime &recv_time)
+{
+  if (pre_filter(view, subject, recv_time) == true)
+    return;
+
+  filter_info_t *filter = parse_message(view);
+  if (filter == nullptr)
+  {
+    handle_discard_ = true; ///< 처리 건수(out tps)에서 제외
+    return;
+  }
+
+  handle_filter(*filter, subject, recv_time);
+}
+
+void
+FilterWorker::discard(filter_info_t &filter, const SysDateTime &recv_time, const discard_reason_t &reason) const
+{
+  handle_discard_ = true; ///< to_result_nats의 out tps 로그에서 제외
+
+  switch (reason)
+  {
+    case discard_reason_t::tps_in    : discard_tps_in    (filter, recv_time); break;
+    case discard_reason_t::queue_full: discard_queue_full(filter, recv_time); break;
+  }
 }
 
 int
 FilterWorker::push(const std::pair<std::string, std::string> &subject_message)
 {
+  std::string subject = subject_message.first;
+  std::string message = subject_message.second;
+  return push_message(subject, message);
+}
+
+int
+FilterWorker::push(std::pair<std::string, std::string> &&subject_message)
+{
+  return push_message(subject_message.first, subject_message.second);
+}
+
+int
+FilterWorker::push_message(std::string &subject, std::string &message)
+{
+  // 꽉 찬 큐는 유입 제어 전에 확인한다. 다시 넣을 메세지가 토큰과 in tps에 두번 포함되지 않도록.
+  if (waiter_.size() >= static_cast<int64_t>(waiter_.capacity()))
+    return EAGAIN;
+
   SysDateTime recv_time = SysDateTime::now();
+  auto        recv_tick = std::chrono::steady_clock::now();
 
-  auto filter = parse_message(subject_message.second);
-  if (filter.has_value() == false)
+  // 형식 오류는 유입 제어(토큰)와 in tps에 포함하지 않고 버린다.
+  // 수신번호만 SAX로 읽어서 확인하며, 읽은 값은 뷰에 캐시되어 워커에서 다시 읽지 않는다.
+  filter_info_view view(std::move(message));
+  if (view.check_format() == false)
+  {
+    sfs_log.error() << view.error() << ":recv nats:" << subject;
     return 0;
+  }
+
+  // 유입 제어는 전체 파싱 전에 한다. 거절된 메세지는 워커큐에 넣지 않고 FilterDiscarder가 폐기 결과를 보낸다.
+  bool admitted = admission_in.try_acquire(get_app_conf().discard_tps_in.load(),
+                                           get_app_conf().discard_burst_in.load());
 
   {
     SCOPE_EXIT(
     { sfs_log.info() << "in tps:" << tps_meter_in.get_tps()
                      << ":recv nats:"
-                     << (filter_logger_debug_on ? subject_message.first+" "+subject_message.second : subject_message.first); });
+                     << (filter_logger_debug_on ? subject+" "+(view.binary() ? "(binary "+std::to_string(view.raw().size())+" bytes)" : view.raw())
+                                                : subject); });
 
-    if (discard_tps_in(filter.value(), recv_time) == true)
-      return 0;
+    if (admitted == true)
+      tps_meter_in.add_transaction();
+  }
 
-    tps_meter_in.add_transaction();
+  if (admitted == false)
+  {
+    filter_discarder.push(this, view, recv_time, discard_reason_t::tps_in);
+    return 0;
   }
 
-  auto res = try_push({subject_message.first, filter.value(), recv_time}, 1000); ///< 1000 : max_retries
-  if (res < 0)
-    return res;
+  // 이동하여 큐에 넣으므로 복사가 없으며, 실패시에는 item으로 되돌려 받는다.
+  auto item = std::make_tuple(std::move(subject), std::move(view), recv_time, std::chrono::steady_clock::now());
+  auto res  = try_push(std::move(item), 0);
+  if (res == 0)
+  {
+    latency_recv_enqueue.record_since(recv_tick);
+    return 0;
+  }
 
+  // 확인 후 다른 생산자가 채운 경우. 이미 유입 제어와 in tps에 포함했으므로 돌려주지 않고 폐기 결과를 보낸다.
   if (res == EAGAIN)
   {
-    discard_queue_full(filter.value(), recv_time);
+    filter_discarder.push(this, std::get<1>(item), recv_time, discard_reason_t::queue_full);
     return 0;
   }
 
+  subject = std::move(std::get<0>(item));
+  message = std::get<1>(item).release();
   return res;
 }
 
+void
+FilterWorker::overflow(std::pair<std::string, std::string> &&subject_message)
+{
+  filter_info_view view(std::move(subject_message.second));
+  filter_discarder.push(this, view, SysDateTime::now(), discard_reason_t::queue_full);
+}
+
+bool
+FilterWorker::handle_discard(filter_info_view &view, const SysDateTime &recv_time) const
+{
+  ScopeExit rvalue([&](){handle_discard_ = true;});
+
+  if (admission_out.try_acquire(get_app_conf().discard_tps_out.load(),
+                                get_app_conf().discard_burst_out.load()) == false)
+  {
+    filter_info_t *filter = parse_message(view);
+    return filter == nullptr ? true : discard_tps_out(*filter, recv_time);
+  }
+
+  // gwrecv 수신시간부터 지금까지. 제한시간 이내이면 파싱하지 않는다.
+  int64_t duration_millisecs = SysDateTime::now().duration().millisecs() - view.filter_start_time();
+  if (duration_millisecs >= get_app_conf().discard_timeout_ms.load())
+  {
+    filter_info_t *filter = parse_message(view);
+    if (filter == nullptr || discard_timeout(*filter, recv_time) == true)
+      return true;
+  }
+
+  rvalue.ignore();
+  return false;
+}
+
 bool
 FilterWorker::handle_discard(filter_info_t &filter, const SysDateTime &recv_time) const
 {
   ScopeExit rvalue([&](){handle_discard_ = true;});
 
-  if (discard_tps_out(filter, recv_time) == true)
-    return true;
+  if (admission_out.try_acquire(get_app_conf().discard_tps_out.load(),
+                                get_app_conf().discard_burst_out.load()) == false)
+    return discard_tps_out(filter, recv_time);
 
   if (discard_timeout(filter, recv_time) == true)
     return true;
@@ -135,27 +298,21 @@ FilterWorker::handle_discard(filter_info_t &filter, const SysDateTime &recv_time
   return false;
 }
 
-//  제어는 HAM 처리
+//  제어는 HAM 처리. 유입 제어(admission_in)에서 거절된 경우 호출
 bool
 FilterWorker::discard_tps_in(filter_info_t &filter, const SysDateTime &recv_time) const
 {
   auto current = tps_meter_in.get_tps();
-  if (current < get_app_conf().discard_tps_in.load())
-    return false;
-
   filter.resultInfo.spamPattern1 = std::to_string(current) + "/" + std::to_string(get_app_conf().discard_tps_in.load());
   to_result_nats(filter, recv_time, SMPP_DISCARD, TRANS_RESULT_CODE_HAM_FAIL, DISCARD_ENQUEUE_TPS);
   return true;
 }
 
-//  제어는 HAM 처리
+//  제어는 HAM 처리. 유입 제어(admission_out)에서 거절된 경우 호출
 bool
 FilterWorker::discard_tps_out(filter_info_t &filter, const SysDateTime &recv_time) const
 {
   auto current = tps_meter_out.get_tps();
-  if (current < get_app_conf().discard_tps_out.load())
-    return false;
-
   filter.resultInfo.spamPattern1 = std::to_string(current) + "/" + std::to_string(get_app_conf().discard_tps_out.load());
   to_result_nats(filter, recv_time, SMPP_DISCARD, TRANS_RESULT_CODE_HAM_FAIL, DISCARD_DEQUEUE_TPS);
   return true;
@@ -10,19 +10,49 @@
 #include <NatsSenders.h>
 #include <AppConf.h>
 #include <Worker.h>
+#include <WorkerSelector.h>
 #include <FilterTpsMeter.h>
+#include <FilterDiscarder.h>
 #include <filter_info.h>
+#include <filter_info_view.h>
 #include <extra/SysDateTime.h>
 #include <extra/Toggle.h>
 #include <extra/Optional.h>
+#include <chrono>
+
+/**
+ * @brief keyed_selector용 키 추출기. 수신번호(messageInfo.destinationMdn)
+ * @details
+ * 풀에서 호출되므로 전체를 파싱하지 않고 filter_info_view::peek으로 messageInfo 안의 값만 찾습니다.(JSON, 바이너리 모두)
+ * 이스케이프가 있는 값은 해제한 값으로 해시하므로 같은 번호는 표기와 관계없이 같은 워커로 갑니다.
+ *
+ * 워커 고정은 풀 단위입니다. NatsRecvers의 client_num(nats.recv.num)이 1보다 크면 클라이언트마다 풀이 따로 있으므로
+ * 같은 수신번호라도 받은 클라이언트에 따라 다른 워커가 처리하며 순서도 클라이언트 사이에서는 보장되지 않습니다.
+ *
+ * example)
+ *  using AuthFilterWorkerPool = WorkerPool<AuthFilterWorker, std::pair<std::string, std::string>, keyed_selector<destination_mdn_key>>;
+ */
+struct destination_mdn_key
+{
+  bool operator()(const std::pair<std::string, std::string> &message, uint64_t &hash) const
+  {
+    json_str_ref mdn;
+    std::string  unescaped;
+    if (filter_info_view::peek(message.second, "messageInfo", "destinationMdn", mdn, unescaped) == false || mdn.empty() == true)
+      return false;
+
+    hash = selector_key_hash(mdn.data(), mdn.size());
+    return true;
+  }
+};
 
 /**
  * @brief 필터링 작업을 수행하는 워커 기본 클래스
  * @details 메시지 필터링, 폐기 처리, NATS 결과 전송 등의 기본 기능 제공
  *
  * 템플릿 인자 설명.
- * std::tuple<std::string, filter_info_t, SysDateTime> : Worker::waiter_(LockFreeQueue)에서 사용하는 데이터 형식
- *    : subject, filter_01_t, 수신시간
+ * std::tuple<std::string, filter_info_view, SysDateTime, steady_clock::time_point> : Worker::waiter_(LockFreeQueue)에서 사용하는 데이터 형식
+ *    : subject, 필터 JSON 원문(지연 파싱), 수신시간, 큐 적재시간(지연시간 측정용)
  * std::pair<std::string, std::string>> : NATS로부터 받은 메세지 형식
  *    : subject, JSON 형식의 메시지 문자열
  *
@@ -31,9 +61,17 @@
  *
  * FilterWorker를 상속받은 클래스는(ex. XxxFilterWorker)
  * XxxFilterWorker::run()함수를 구현할때 Worker::waiter_에서 데이터를 꺼내서 처리해야 한다.
+ *
+ * JSON은 push에서 파싱하지 않고 원문 그대로 큐에 넣는다.(filter_info_view)
+ * 유입 제어(admission_in)에서 거절된 메세지는 큐에 넣지 않고 FilterDiscarder가 폐기 결과를 보낸다.
+ * run()은 pre_filter(view)를 먼저 호출하고, 처리되지 않은 메세지만 전체 파싱하여 handle_filter를 호출한다.
+ * 몇몇 필드만 보고 판단하는 필터는 pre_filter에서 view.get()으로 판단하고, 필요한 메세지만 전체 파싱한다.
+ * 앞쪽 섹션(messageInfo)의 필드는 SAX로 조금만 읽고 멈추므로 전체 파싱에 비해 싸다.(AuthFilterWorker의 트랩 번호)
+ * 수신번호는 push의 형식 확인(check_format)에서 읽어 캐시하므로 pre_filter의 destination_mdn()은 다시 파싱하지 않는다.
  */
 /// template<typename WOKER_RECV_TYPE, typename POOL_PUSH_TYPE = std::pair<std::string, std::string>>
-class FilterWorker : public Worker<std::tuple<std::string, filter_info_t, SysDateTime>, std::pair<std::string, std::string>> ///< subject, filter_01_t, 수신시간
+class FilterWorker : public Worker<std::tuple<std::string, filter_info_view, SysDateTime, std::chrono::steady_clock::time_point>,
+                                   std::pair<std::string, std::string>> ///< subject, 필터 JSON 원문, 수신시간, 큐 적재시간
 {
 public:
   /**
@@ -41,7 +79,8 @@ public:
    * @param queue_size 작업 큐의 최대 크기 (기본값: 10000)
    */
   FilterWorker(const size_t &queue_size = 10000)
-  : Worker(queue_size) , error_toggle_(false, false) {}
+  : Worker(queue_size) , error_toggle_(false, false), publish_toggle_(false, true), ack_toggle_(false, true),
+    publish_key_(NatsPublisherPool::next_worker_key()) {}
 
   /**
    * @brief 메시지를 워커 큐에 추가
@@ -50,7 +89,31 @@ public:
    */
   int push(const std::pair<std::string, std::string> &message) override;
 
+  /**
+   * @brief 메시지를 워커 큐에 추가 (이동)
+   * @details subject와 message는 큐 항목으로 이동됩니다.
+   * @param message subject, JSON 형식의 메시지 문자열
+   * @return 큐 추가 결과 코드
+   */
+  int push(std::pair<std::string, std::string> &&message) override;
+
+  /**
+   * @brief 큐가 꽉 차서 풀이 넣지 못한 메세지. FilterDiscarder로 넘겨서 폐기 결과(discard_queue_full)를 보냅니다.
+   * @details 유입 제어와 in tps에는 포함하지 않습니다.(push에서 EAGAIN을 리턴한 메세지)
+   */
+  void overflow(std::pair<std::string, std::string> &&message) override;
+
 protected:
+  /**
+   * @brief 전체 파싱 전에 호출 (하위 클래스에서 구현)
+   * @details 원문의 몇몇 필드(view.get, view.destination_mdn)만으로 판단할 수 있는 경우 여기서 처리합니다.
+   *          결과를 보내야 하면 parse_message(view)로 필터 정보를 얻습니다.
+   *          view.get은 필드까지 SAX로 읽으므로 뒤쪽 섹션(resultInfo 등)의 필드는 원문 대부분을 읽습니다.
+   * @return true : 처리 완료(handle_filter를 호출하지 않음), false : handle_filter로 진행
+   */
+  virtual bool pre_filter(filter_info_view &view, const std::string &subject, const SysDateTime &recv_time)
+  { (void)view; (void)subject; (void)recv_time; return false; }
+
   /**
    * @brief 워커 메인 실행 함수 (하위 클래스에서 구현)
    */
@@ -72,11 +135,36 @@ protected:
 
 protected:
   /**
-   * @brief JSON 메시지를 필터 정보 객체로 파싱
-   * @return 파싱된 필터 정보 (Optional)
+   * @brief 원문 전체를 파싱하여 필터 정보를 얻습니다.(이미 파싱했으면 그대로)
+   * @return nullptr : 파싱 오류 (로그 출력됨)
+   */
+  filter_info_t *
+       parse_message      (filter_info_view &view) const;
+
+  /**
+   * @brief 이전 API. 원문을 복사하여 전체 파싱합니다.(parse_message(view)로 전달)
+   * @deprecated 워커는 원문을 filter_info_view로 받으며 이 함수를 호출하지 않습니다.(가상함수가 아님)
+   *             하위 클래스가 같은 이름으로 파싱을 바꿨다면 pre_filter(view) 또는 handle_filter로 옮겨야 합니다.
    */
+  [[gnu::deprecated("use parse_message(filter_info_view &)")]]
   Optional<filter_info_t>
-       parse_message      (const std::string &message)  const;
+       parse_message      (const std::string &message) const;
+
+  /**
+   * @brief push 공통처리. subject와 원문을 이동하여 큐에 추가
+   * @details
+   * 큐가 꽉 찼으면 유입 제어와 in tps에 포함하지 않고 EAGAIN을 리턴합니다.(풀의 push_bulk가 대기 후 다시 넣거나 overflow 호출)
+   * 형식 확인(filter_info_view::check_format, 수신번호만 읽음)을 통과한 메세지만 유입 제어와 in tps에 포함합니다.
+   * 유입 제어(admission_in)는 전체 파싱 전에 합니다. 거절된 메세지는 워커큐에 넣지 않고 FilterDiscarder로 넘기며,
+   * 전체 파싱과 폐기 결과 발행은 그 쓰레드가 합니다.
+   * EAGAIN, 큐가 닫힌 경우 subject와 message는 원래 값으로 되돌려집니다.
+   */
+  int  push_message       (std::string &subject, std::string &message);
+
+  /**
+   * @brief 큐에서 꺼낸 메세지 처리. pre_filter -> (전체 파싱) -> handle_filter
+   */
+  void handle_view        (filter_info_view &view, const std::string &subject, const SysDateTime &recv_time);
 
   /**
    * @brief 필터링 결과를 NATS로 전송
@@ -107,19 +195,36 @@ protected:
    */
   virtual bool handle_discard     (filter_info_t &filter, const SysDateTime &recv_time) const;
 
+  /**
+   * @brief 메시지 폐기 여부 확인 및 처리 (pre_filter용)
+   * @details 원문의 filterStartTime만 읽어서 판단하며, 폐기하는 경우에만 전체 파싱합니다.
+   *          filterStartTime은 마지막 섹션(resultInfo)에 있으므로 원문 대부분을 SAX로 읽습니다.
+   *          폐기되지 않은 메세지를 이어서 전체 파싱한다면 handle_discard(filter)가 더 쌉니다.
+   * @return 폐기 처리 여부
+   */
+  virtual bool handle_discard     (filter_info_view &view, const SysDateTime &recv_time) const;
+
 private:
+  friend class FilterDiscarder;
+
+  /**
+   * @brief 워커에 넘기지 못한 메세지의 폐기 결과 발행. FilterDiscarder 쓰레드에서 호출됩니다.
+   * @details 워커 쓰레드와 동시에 호출되므로 const 함수와 lock을 쓰는 Toggle만 사용합니다.
+   */
+  void discard            (filter_info_t &filter, const SysDateTime &recv_time, const discard_reason_t &reason) const;
+
   /**
    * @brief 큐 가득 참 상태 폐기 처리
    */
   virtual bool discard_queue_full (filter_info_t &filter, const SysDateTime &recv_time) const;
 
   /**
-   * @brief 입력 TPS 초과 폐기 처리
+   * @brief 입력 TPS 초과 폐기 처리 (admission_in 거절시)
    */
   virtual bool discard_tps_in     (filter_info_t &filter, const SysDateTime &recv_time) const;
 
   /**
-   * @brief 출력 TPS 초과 폐기 처리
+   * @brief 출력 TPS 초과 폐기 처리 (admission_out 거절시)
    */
   virtual bool discard_tps_out    (filter_info_t &filter, const SysDateTime &recv_time) const;
 
@@ -128,7 +233,32 @@ private:
    */
   virtual bool discard_timeout    (filter_info_t &filter, const SysDateTime &recv_time) const;
 
+  /**
+   * @brief 발행 결과 확인. 실패하면 처음 한번만 에러로그 (건수는 metrics의 backpressure 통계)
+   */
+  void check_published    (const int &res, const char *target) const;
+
+  /**
+   * @brief ack 발행 완료 처리. 발행자 쓰레드에서 호출됩니다.(nats.next/result.ack_window 설정시)
+   * @param target "next" 또는 "result"
+   * @param status 0 : 서버 확인, -1 : 재시도 후 실패(유실)
+   * @details 기본 구현은 실패를 처음 한번만 에러로그로 남깁니다. 건수는 metrics의 next_ack, result_ack
+   */
+  virtual void on_published(const char *target, const int &status) const;
+
+  /// pool이 ack 모드이면 on_published를 호출하는 콜백, 아니면 nullptr
+  /// 콜백은 이 워커를 참조하므로 워커는 pool이 stop된 후에 파괴되어야 합니다.(NatsRecvers::stop 참고)
+  publish_callback_t completion(const char *target, const NatsPublisherPool &pool) const
+  {
+    if (pool.ack_enabled() == false)
+      return nullptr;
+    return [this, target](const int &status) { on_published(target, status); };
+  }
+
 private:
-  mutable bool   handle_discard_ = false;
+  static thread_local bool handle_discard_; ///< 처리중인 메세지를 폐기함. 워커, FilterDiscarder 쓰레드별
   mutable Toggle error_toggle_;
+  mutable Toggle publish_toggle_; ///< 발행큐 적재 실패 (NatsPublisherPool::publish). FilterDiscarder 쓰레드에서도 호출되므로 lock 사용
+  mutable Toggle ack_toggle_;     ///< ack 실패. 발행자 쓰레드에서 호출되므로 lock 사용
+  size_t         publish_key_;    ///< worker_affine 발행자 선택 키. 모든 풀의 워커 사이에서 고유 (재시작해도 같음)
 };
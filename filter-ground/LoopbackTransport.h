@@ -0,0 +1,225 @@
+/*
+ * LoopbackTransport.h
+ *
+ *  Created on: 2025. 3. 21.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <Transport.h>
+#include <extra/AtomicSptr.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class LoopbackBus
+ * @brief 같은 프로세스 안의 발행자와 구독자를 잇는 이름있는 버스
+ * @details
+ * - subject는 정확히 같은 경우만 전달합니다.(NATS 와일드카드 *, > 는 지원하지 않음)
+ * - 구독 목록은 copy-on-write이므로 publish는 락 없이 목록을 읽습니다.(구독/해제시에만 락)
+ * - queue group은 group마다 구독자를 차례대로 하나씩 고릅니다.
+ * - 구독자가 없으면 버립니다.(NATS와 같음)
+ * - inject_failures(n)으로 다음 n번의 publish를 실패시킬 수 있습니다.(ack 재시도 등 실패 경로 확인용)
+ */
+class LoopbackBus
+{
+public:
+  static const char *scheme() { return "loopback://"; }
+
+  /// 이름의 버스. 없으면 만듭니다. 프로세스가 끝날때까지 유지됩니다.
+  static std::shared_ptr<LoopbackBus> get(const std::string &name)
+  {
+    static std::mutex lock;
+    static std::map<std::string, std::shared_ptr<LoopbackBus>> buses;
+
+    std::lock_guard<std::mutex> guard(lock);
+    auto &bus = buses[name];
+    if (bus == nullptr)
+      bus = std::make_shared<LoopbackBus>();
+    return bus;
+  }
+
+  /// 구독자. drain시 active를 끄고 호출중인 콜백이 끝날때까지 기다립니다.
+  struct member_t
+  {
+    Transport::on_message_t callback;
+    std::atomic<bool>       active {true};
+    std::atomic<int>        calling{0};
+
+    void deliver(const std::string &message)
+    {
+      calling.fetch_add(1, std::memory_order_seq_cst);
+      if (active.load(std::memory_order_seq_cst) == true)
+        callback(message);
+      calling.fetch_sub(1, std::memory_order_release);
+    }
+
+    void deactivate()
+    {
+      active.store(false, std::memory_order_seq_cst);
+      while (calling.load(std::memory_order_acquire) > 0)
+        std::this_thread::yield();
+    }
+  };
+  using member_sptr = std::shared_ptr<member_t>;
+
+  member_sptr subscribe(const std::string &subject, const std::string &group, Transport::on_message_t callback)
+  {
+    auto member = std::make_shared<member_t>();
+    member->callback = std::move(callback);
+
+    update([&](routes_t &routes)
+    {
+      auto &groups = routes[subject];
+      for (auto &item : groups)
+      {
+        if (item->name != group)
+          continue;
+        item = std::make_shared<group_t>(*item);  ///< 다른 publish가 읽고 있을 수 있으므로 복사 후 추가
+        item->members.push_back(member);
+        return;
+      }
+      groups.push_back(std::make_shared<group_t>(group, member));
+    });
+    return member;
+  }
+
+  void unsubscribe(const member_sptr &member)
+  {
+    member->deactivate();
+    update([&](routes_t &routes)
+    {
+      for (auto &route : routes)
+        for (auto &item : route.second)
+        {
+          auto copy = std::make_shared<group_t>(*item);
+          copy->members.erase(std::remove(copy->members.begin(), copy->members.end(), member), copy->members.end());
+          item = copy;
+        }
+    });
+  }
+
+  /// 다음 count번의 publish가 TransportException을 던지게 합니다.(모든 발행자 공통)
+  void inject_failures(const size_t &count) { failures_.store(count); }
+
+  /// 실패시킬 publish이면 남은 횟수를 하나 줄이고 true
+  bool take_failure()
+  {
+    size_t remain = failures_.load(std::memory_order_relaxed);
+    while (remain > 0 && failures_.compare_exchange_weak(remain, remain - 1) == false) {}
+    return remain > 0;
+  }
+
+  /// 구독자 콜백을 호출한 쓰레드에서 바로 호출합니다.
+  void publish(const std::string &subject, const std::string &message)
+  {
+    std::shared_ptr<const routes_t> routes = routes_.load();
+    if (routes == nullptr)
+      return;
+
+    auto found = routes->find(subject);
+    if (found == routes->end())
+      return;
+
+    for (auto &group : found->second)
+    {
+      const size_t count = group->members.size();
+      if (count == 0)
+        continue;
+
+      if (group->name.empty() == true)
+      {
+        for (auto &member : group->members)
+          member->deliver(message);
+        continue;
+      }
+
+      group->members[group->next.fetch_add(1, std::memory_order_relaxed) % count]->deliver(message);
+    }
+  }
+
+protected:
+  struct group_t
+  {
+    std::string              name;
+    std::vector<member_sptr> members;
+    std::atomic<size_t>      next{0};     ///< queue group 순번
+
+    group_t(const std::string &group_name, const member_sptr &member) : name(group_name), members{member} {}
+    group_t(const group_t &rhs) : name(rhs.name), members(rhs.members), next(rhs.next.load()) {}
+  };
+  using routes_t = std::map<std::string, std::vector<std::shared_ptr<group_t>>>;
+
+  template<typename FUNC>
+  void update(FUNC func)
+  {
+    std::lock_guard<std::mutex> guard(update_lock_);
+    auto curr = routes_.load();
+    auto next = curr == nullptr ? std::make_shared<routes_t>() : std::make_shared<routes_t>(*curr);
+    func(*next);
+    routes_.store(std::move(next));
+  }
+
+protected:
+  std::mutex             update_lock_;
+  AtomicSptr<routes_t>   routes_;
+  std::atomic<size_t>    failures_{0};  ///< inject_failures로 남은 실패 횟수
+};
+
+/**
+ * @class LoopbackTransport
+ * @brief LoopbackBus를 사용하는 Transport (URL: loopback://이름)
+ * @details
+ * publish는 구독자 콜백(NatsRecvers라면 워커큐 적재)을 발행자 쓰레드에서 바로 호출하므로
+ * 네트워크와 직렬화 외의 비용이 없고, 워커큐가 꽉 차면 발행자가 기다리게 됩니다.
+ * flush는 할일이 없습니다.(publish가 리턴하면 전달된 것)
+ */
+class LoopbackTransport : public Transport
+{
+public:
+  ~LoopbackTransport() { drain(); }
+
+  void connect(const std::vector<std::string> &urls) override
+  {
+    if (urls.empty() == true || urls.front().compare(0, strlen(LoopbackBus::scheme()), LoopbackBus::scheme()) != 0)
+      throw TransportException("loopback url required: loopback://name");
+
+    bus_ = LoopbackBus::get(urls.front().substr(strlen(LoopbackBus::scheme())));
+  }
+
+  void publish(const std::string &subject, const std::string &message) override
+  {
+    if (bus_ == nullptr)
+      throw TransportException("loopback not connected");
+    if (bus_->take_failure() == true)
+      throw TransportException("loopback injected failure");
+    bus_->publish(subject, message);
+  }
+
+  void flush() override {}
+
+  void subscribe(const std::string &subject, const std::string &group, on_message_t callback) override
+  {
+    if (bus_ == nullptr)
+      throw TransportException("loopback not connected");
+    members_.push_back(bus_->subscribe(subject, group, std::move(callback)));
+  }
+
+  void drain() override
+  {
+    for (auto &member : members_)
+      bus_->unsubscribe(member);
+    members_.clear();
+  }
+
+  bool sync_delivery() const override { return true; }
+
+protected:
+  std::shared_ptr<LoopbackBus>          bus_;
+  std::vector<LoopbackBus::member_sptr> members_;
+};
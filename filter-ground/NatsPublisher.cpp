@@ -9,12 +9,8 @@
 #include <extra/ThreadUniqueIndexer.h>
 #include <Logger.h>
 #include <extra/Toggle.h>
-
-static void
-nats_error_callback(natsConnection *nc, natsSubscription *sub, natsStatus err, void *closure)
-{
-  (void)nc; (void)sub; (void)err; (void)closure;
-}
+#include <algorithm>
+#include <thread>
 
 bool
 NatsPublisher::start()
@@ -23,10 +19,11 @@ NatsPublisher::start()
 
   try
   {
-    client_ = std::unique_ptr<NatsClient>(new NatsClient());
-    client_->connectServers(urls_.load(), nats_error_callback);
+    auto urls = urls_.load();
+    client_ = make_transport(urls);
+    client_->connect(urls);
   }
-  catch (const SfsNatsException &e)
+  catch (const TransportException &e)
   {
     if (error_toggle.turn_on() == true)
       sfs_log.error() << e.what();
@@ -45,33 +42,125 @@ NatsPublisher::start()
   return LockFreeQueueThread::start();
 }
 
+void
+NatsPublisher::publish_item(publish_item_t &item, Toggle &error_toggle)
+{
+  try
+  {
+    client_->publish(item.subject, item.message);
+    if (latency_ != nullptr)
+      latency_->record_since(item.enqueue_time);
+  }
+  catch (const TransportException &e)
+  {
+    if (error_toggle.turn_on() == true)
+      sfs_log.error() << item.message + ": " + e.what();
+    if (item.on_complete != nullptr)
+      item.on_complete(-1);
+    return;
+  }
+
+  if (item.on_complete != nullptr)
+    item.on_complete(0);
+
+  if (error_toggle.turn_off() == true)
+    sfs_log.info() << item.message + ": NATS transmission error cleared.";
+}
+
 void
 NatsPublisher::run()
 {
+  if (ack_.window > 0)
+  {
+    run_ack();
+    return;
+  }
+
+  if (batch_.max_count > 0)
+  {
+    run_batch();
+    return;
+  }
+
   Toggle error_toggle(false, false);
 
   sfs_log.info() << "Start Publisher:" << to_stringf(assigned_no_, "%02d");
 
-  queueable_pair item;// = 0;
+  queueable_publish items[bulk_size];
 
-  while (waiter_.pop(item) >= 0)
+  int count = 0;
+  while ((count = waiter_.pop_bulk(items, bulk_size)) >= 0)
   {
-    // subject, message(json)
-    std::shared_ptr<std::pair<std::string, std::string>> pair = item.take();
+    for (int index = 0; index < count; ++index)
+    {
+      // subject, message(json), 적재시간
+      std::shared_ptr<publish_item_t> item = items[index].take();
+      publish_item(*item, error_toggle);
+    }
+  }
+
+  client_->flush();
+  client_.reset();
+
+  sfs_log.info() << "Stop Publisher:" << to_stringf(assigned_no_, "%02d");
+}
+
+void
+NatsPublisher::run_batch()
+{
+  Toggle error_toggle(false, false);
+
+  sfs_log.info() << "Start Publisher:" << to_stringf(assigned_no_, "%02d")
+                 << " batch:" << batch_.max_count << "/" << batch_.max_us << "us/" << batch_.max_bytes << "bytes";
+
+  std::vector<queueable_publish>               items(batch_.max_count);
+  std::vector<std::shared_ptr<publish_item_t>> batch;
+  batch.reserve(batch_.max_count);
+
+  bool closed = false;
+  while (closed == false)
+  {
+    // 첫 항목은 기다린다.
+    int count = waiter_.pop_bulk(items.data(), items.size());
+    if (count < 0)
+      break;
+
+    auto   deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(batch_.max_us);
+    size_t bytes    = 0;
+    while (true)
+    {
+      for (int index = 0; index < count; ++index)
+      {
+        batch.emplace_back(items[index].take());
+        bytes += batch.back()->message.size();
+      }
+
+      if (batch.size() >= batch_.max_count || (batch_.max_bytes > 0 && bytes >= batch_.max_bytes))
+        break;
+
+      // 이후 항목은 deadline까지만 기다린다. max_us가 0이면 큐에 있는 만큼만
+      count = waiter_.pop_bulk_until(items.data(), batch_.max_count - batch.size(),
+                                     batch_.max_us == 0 ? std::chrono::steady_clock::now() : deadline);
+      if (count < 0) { closed = true; break; }
+      if (count == 0) break;
+    }
+
+    for (auto &item : batch)
+      publish_item(*item, error_toggle);
 
     try
     {
-      client_->publish(pair->first, pair->second);
+      client_->flush(); ///< 배치마다 한번
     }
-    catch (const SfsNatsException &e)
+    catch (const TransportException &e)
     {
       if (error_toggle.turn_on() == true)
-        sfs_log.error() << pair->second + ": " + e.what();
-      continue;
+        sfs_log.error() << std::string("flush: ") + e.what();
     }
 
-    if (error_toggle.turn_off() == true)
-      sfs_log.info() << pair->second + ": NATS transmission error cleared.";
+    if (batch_histogram_ != nullptr)
+      batch_histogram_->record(batch.size());
+    batch.clear();
   }
 
   client_->flush();
@@ -80,9 +169,85 @@ NatsPublisher::run()
   sfs_log.info() << "Stop Publisher:" << to_stringf(assigned_no_, "%02d");
 }
 
+void
+NatsPublisher::run_ack()
+{
+  Toggle error_toggle(false, false);
+
+  sfs_log.info() << "Start Publisher:" << to_stringf(assigned_no_, "%02d")
+                 << " ack:" << ack_.window << " retries:" << ack_.max_retries
+                 << " backoff:" << ack_.backoff_ms << "~" << ack_.max_backoff_ms << "ms";
+
+  std::vector<queueable_publish>               items(ack_.window);
+  std::vector<std::shared_ptr<publish_item_t>> window;
+  window.reserve(ack_.window);
+
+  // 큐가 닫혀도 남은 항목은 모두 꺼내서 처리한다.(콜백 누락 방지)
+  int count = 0;
+  while ((count = waiter_.pop_bulk(items.data(), items.size())) >= 0)
+  {
+    for (int index = 0; index < count; ++index)
+      window.emplace_back(items[index].take());
+
+    in_flight_.store(window.size(), std::memory_order_relaxed);
+    ack_window(window, error_toggle);
+    in_flight_.store(0, std::memory_order_relaxed);
+    window.clear();
+  }
+
+  client_.reset();
+
+  sfs_log.info() << "Stop Publisher:" << to_stringf(assigned_no_, "%02d");
+}
+
+void
+NatsPublisher::ack_window(std::vector<std::shared_ptr<publish_item_t>> &window, Toggle &error_toggle)
+{
+  uint32_t backoff_ms = ack_.backoff_ms;
+  int      status     = -1;
+
+  for (uint32_t attempt = 0; ; ++attempt)
+  {
+    try
+    {
+      for (auto &item : window)
+        client_->publish(item->subject, item->message);
+      client_->flush(); ///< 서버가 window를 모두 받았는지 확인 (PING/PONG)
+      status = 0;
+      break;
+    }
+    catch (const TransportException &e)
+    {
+      if (error_toggle.turn_on() == true)
+        sfs_log.error() << std::string("ack: ") + e.what();
+    }
 
+    // 종료중에는 기다리지 않는다.
+    if (attempt >= ack_.max_retries || waiter_.is_open() == false)
+      break;
 
+    ++retried_;
+    std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+    backoff_ms = std::min(backoff_ms * 2, ack_.max_backoff_ms);
+  }
 
+  if (status == 0 && error_toggle.turn_off() == true)
+    sfs_log.info() << "ack: NATS transmission error cleared.";
 
+  if (status == 0) acked_  += window.size();
+  else             failed_ += window.size();
 
+  auto now = std::chrono::steady_clock::now();
+  for (auto &item : window)
+  {
+    if (status == 0)
+    {
+      ack_latency_.record(item->enqueue_time, now);
+      if (latency_ != nullptr)
+        latency_->record(item->enqueue_time, now);
+    }
 
+    if (item->on_complete != nullptr)
+      item->on_complete(status);
+  }
+}
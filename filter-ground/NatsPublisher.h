@@ -11,9 +11,12 @@
 
 #include <extra/LockedObject.h>
 #include <extra/LockFreeQueueThread.h>
-#include <sfs_nats_cli.h>
-
-using NatsClient = SfsNatsClient<std::string>;
+#include <extra/LatencyHistogram.h>
+#include <extra/Toggle.h>
+#include <Transport.h>
+#include <PublishPolicy.h>
+#include <atomic>
+#include <functional>
 
 /**
  * @class NatsPublisher
@@ -21,9 +24,77 @@ using NatsClient = SfsNatsClient<std::string>;
  *
  * @details LockFreeQueueThread를 상속받아 스레드 안전한 메시지 큐잉 기능을 제공합니다.
  */
-using queueable_pair = queueable_t<std::pair<std::string, std::string>>; ///< subject, message
+/**
+ * @brief 발행 완료 콜백. 발행자 쓰레드에서 호출됩니다.
+ * @details status 0 : 성공(ack 모드이면 서버 확인), -1 : 실패(ack 모드이면 재시도 후 실패)
+ */
+using publish_callback_t = std::function<void(const int &status)>;
+
+struct publish_item_t
+{
+  std::string subject;
+  std::string message;  ///< json
+  std::chrono::steady_clock::time_point enqueue_time;  ///< 발행큐 적재시간(지연시간 측정용)
+  publish_callback_t on_complete;                      ///< 발행 완료 콜백. 없으면 nullptr
+};
 
-class NatsPublisher : public LockFreeQueueThread<false, queueable_pair, boost::lockfree::fixed_sized<true>>
+using queueable_publish = queueable_t<publish_item_t>;
+
+/// 배치 발행 설정 (NatsPublisher::set_batch)
+struct publish_batch_t
+{
+  size_t   max_count = 0;   ///< 배치당 최대 건수. 0이면 배치 사용안함
+  uint32_t max_us    = 0;   ///< 첫 항목 이후 더 모으는 최대 시간(us). 0이면 큐에 있는 만큼만
+  size_t   max_bytes = 0;   ///< 모은 메세지 크기 합이 이 값 이상이면 더 기다리지 않음. 0이면 제한없음
+};
+
+/// ack 발행 설정 (NatsPublisher::set_ack)
+struct publish_ack_t
+{
+  size_t   window         = 0;    ///< ack를 기다리는 최대 건수(in-flight). 0이면 사용안함
+  uint32_t max_retries    = 3;    ///< ack 실패시 재시도 횟수
+  uint32_t backoff_ms     = 10;   ///< 첫 재시도 대기시간. 재시도마다 2배
+  uint32_t max_backoff_ms = 1000; ///< 재시도 최대 대기시간
+};
+
+/**
+ * @struct publisher_stats_t
+ * @brief 발행자별 통계 (NatsPublisher::stats)
+ * @details queued, in_flight는 현재값이며 나머지는 누적값입니다. 구간 통계는 operator-로 구합니다.
+ */
+struct publisher_stats_t
+{
+  size_t   no        = 0;
+  int64_t  queued    = 0;  ///< 발행큐 깊이
+  uint64_t in_flight = 0;  ///< 발행 후 ack 대기
+  uint64_t acked     = 0;  ///< ack 완료
+  uint64_t failed    = 0;  ///< 재시도 후 실패
+  uint64_t retried   = 0;  ///< 재시도 횟수(window 단위)
+  LatencyHistogram::snapshot_t ack_latency; ///< 발행큐 적재 -> ack (us)
+
+  publisher_stats_t operator-(const publisher_stats_t &rhs) const
+  {
+    publisher_stats_t diff = *this;
+    diff.acked       = acked   - rhs.acked;
+    diff.failed      = failed  - rhs.failed;
+    diff.retried     = retried - rhs.retried;
+    diff.ack_latency = ack_latency - rhs.ack_latency;
+    return diff;
+  }
+
+  std::string to_string() const
+  {
+    return "#"           + std::to_string(no)
+         + " queued="    + std::to_string(queued)
+         + " in_flight=" + std::to_string(in_flight)
+         + " acked="     + std::to_string(acked)
+         + " failed="    + std::to_string(failed)
+         + " retried="   + std::to_string(retried)
+         + " ack("       + ack_latency.to_string() + ")";
+  }
+};
+
+class NatsPublisher : public LockFreeQueueThread<false, queueable_publish, boost::lockfree::fixed_sized<true>>
 {
 public:
   /**
@@ -37,7 +108,7 @@ public:
 
   /**
    * @brief NATS 서버 URL 설정
-   * @param url NATS 서버 URL
+   * @param url NATS 서버 URL. loopback://이름 이면 같은 프로세스 안에서 전달 @see make_transport
    * @return 현재 객체에 대한 참조 (메서드 체이닝용)
    */
   NatsPublisher &set_server_urls(const std::vector<std::string> &urls)
@@ -52,6 +123,59 @@ public:
     return *this;
   }
 
+  /// 발행큐 적재 -> NATS publish 지연시간을 기록할 히스토그램. nullptr이면 기록하지 않음
+  NatsPublisher &set_latency_histogram(LatencyHistogram *histogram)
+  {
+    latency_ = histogram;
+    return *this;
+  }
+
+  /**
+   * @brief 배치 발행 설정. start 전에 설정해야 합니다.
+   * @param batch 최대 개수/대기시간/크기. max_count가 0이면 사용안함(항목마다 publish, 종료시에만 flush)
+   * @param histogram 배치 크기(건수)를 기록할 히스토그램. nullptr이면 기록하지 않음
+   * @details
+   * 첫 항목을 꺼낸 후 max_count개, 크기 합 max_bytes 이상, max_us 경과 중 먼저 되는 시점까지 모아서
+   * 연속으로 publish하고 배치마다 한번 flush합니다.(큐에 이미 쌓인 항목은 max_count까지 한번에 꺼냅니다)
+   * max_us는 signal/park 대기방식에서는 1ms 단위로 올림됩니다.
+   */
+  NatsPublisher &set_batch(const publish_batch_t &batch, LatencyHistogram *histogram = nullptr)
+  {
+    batch_           = batch;
+    batch_histogram_ = histogram;
+    return *this;
+  }
+
+
+  /**
+   * @brief ack 발행 설정. start 전에 설정해야 합니다.
+   * @param ack window가 0이면 사용안함
+   * @details
+   * 큐에서 window개까지 꺼내서 publish하고 flush로 서버가 받았는지 확인(ack)한 후 다음 window를 꺼냅니다.
+   * 따라서 발행 후 ack를 기다리는 항목은 최대 window개 입니다.
+   * 실패하면 backoff_ms부터 2배씩(최대 max_backoff_ms) 기다리며 window 전체를 max_retries번 다시 보내므로
+   * 같은 메세지가 두번 이상 전달될 수 있습니다.(at-least-once) 재시도 후에도 실패하면 on_complete(-1)을 호출합니다.
+   * set_batch보다 우선합니다.
+   */
+  NatsPublisher &set_ack(const publish_ack_t &ack)
+  {
+    ack_ = ack;
+    return *this;
+  }
+
+  /// 발행자 통계
+  publisher_stats_t stats() const
+  {
+    publisher_stats_t stats;
+    stats.no          = assigned_no_;
+    stats.queued      = size();
+    stats.in_flight   = in_flight_.load(std::memory_order_relaxed);
+    stats.acked       = acked_    .load(std::memory_order_relaxed);
+    stats.failed      = failed_   .load(std::memory_order_relaxed);
+    stats.retried     = retried_  .load(std::memory_order_relaxed);
+    stats.ack_latency = ack_latency_.snapshot();
+    return stats;
+  }
 
   /**
    * @brief 발행자 시작
@@ -65,12 +189,37 @@ public:
     return LockFreeQueueThread::stop();
   }
 
-  void publish(const std::string &subject, const std::string &message)
+  /// @return push와 같음
+  int publish(const std::string &subject, const std::string &message)
   {
-    queueable_pair item({subject, message});
-    if (waiter_.push(item) == 0)
-      return;
-    item.destroy();
+    return publish(std::string(subject), std::string(message));
+  }
+
+  /**
+   * @brief subject, message를 발행큐 항목으로 이동
+   * @param on_complete 발행 완료 콜백(발행자 쓰레드에서 호출). 큐 적재에 실패하면 호출하지 않습니다.
+   * @return push와 같음. 실패한 경우 subject, message는 원래 값으로 되돌려집니다.
+   */
+  int publish(std::string &&subject, std::string &&message, publish_callback_t on_complete = nullptr)
+  {
+    queueable_publish item(publish_item_t{std::move(subject), std::move(message), std::chrono::steady_clock::now(), std::move(on_complete)});
+    int res = push(item);
+    if (res != 0)
+    {
+      subject = std::move(item.get()->subject);
+      message = std::move(item.get()->message);
+      item.destroy();
+    }
+    return res;
+  }
+
+  /**
+   * @brief 발행큐에 추가. 재시도하거나 다른 발행자에 넣을 수 있도록 실패해도 item을 그대로 둡니다.
+   * @return 0 : 성공, -1 : 큐 닫힘, EAGAIN : 큐 꽉참
+   */
+  int push(queueable_publish &item)
+  {
+    return waiter_.push(item);
   }
 
 protected:
@@ -79,8 +228,30 @@ protected:
    */
   void run() override;
 
+  /// 배치 발행 (batch_.max_count > 0)
+  void run_batch();
+
+  /// ack 발행 (ack_.window > 0)
+  void run_ack();
+
+  /// window 전체를 publish + flush. 실패하면 backoff 후 재시도. 끝나면 항목마다 on_complete 호출
+  void ack_window(std::vector<std::shared_ptr<publish_item_t>> &window, Toggle &error_toggle);
+
+  /// 항목 하나 발행. 실패시 로그
+  void publish_item(publish_item_t &item, Toggle &error_toggle);
+
 protected:
   size_t assigned_no_ = 0;
   LockedObject<std::vector<std::string>> urls_;      ///< 서버 URL
-  std::unique_ptr<NatsClient> client_; ///< NATS 클라이언트
+  std::unique_ptr<Transport> client_;  ///< 전송 (NATS, loopback)
+  LatencyHistogram *latency_ = nullptr; ///< 발행 지연시간(NatsPublisherPool 소유)
+  publish_batch_t   batch_;             ///< 배치 발행 설정
+  LatencyHistogram *batch_histogram_ = nullptr; ///< 배치 크기(NatsPublisherPool 소유)
+  publish_ack_t     ack_;               ///< ack 발행 설정
+
+  std::atomic<uint64_t> in_flight_{0};  ///< @see publisher_stats_t
+  std::atomic<uint64_t> acked_    {0};
+  std::atomic<uint64_t> failed_   {0};
+  std::atomic<uint64_t> retried_  {0};
+  LatencyHistogram      ack_latency_;
 };
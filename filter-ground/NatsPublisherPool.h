@@ -8,18 +8,56 @@
 #pragma once
 
 #include <NatsPublisher.h>
+#include <WorkerSelector.h>
 #include <Logger.h>
+#include <extra/WaitStrategy.h>
+#include <extra/ThreadUniqueIndexer.h>
+#include <algorithm>
+#include <atomic>
 #include <future>
 #include <deque>
+#include <thread>
 
 /**
  * @class NatsPublisherPool
  * @brief 여러 NATS 발행자를 관리하는 풀 클래스
- * @details Round-robin 방식으로 메시지를 분산하여 발행합니다.
+ * @details
+ * 발행자마다 자신의 NATS 연결을 가지며, set_select로 정한 방식으로 메시지를 분산하여 발행합니다.(기본값: round_robin)
+ * 발행큐가 꽉 찬 경우의 처리는 set_backpressure로 정합니다.(기본값: fail)
  */
 class NatsPublisherPool
 {
 public:
+  /**
+   * @struct backpressure_stats_t
+   * @brief 발행큐가 꽉 찬 경우의 처리 결과 건수
+   */
+  struct backpressure_stats_t
+  {
+    uint64_t waited    = 0;  ///< block: 기다린 후 적재
+    uint64_t spilled   = 0;  ///< spill: 다른 발행자에 적재
+    uint64_t timed_out = 0;  ///< block: block_ms가 지나서 실패
+    uint64_t rejected  = 0;  ///< fail/spill: 적재 실패, 또는 큐 닫힘
+
+    backpressure_stats_t operator-(const backpressure_stats_t &rhs) const
+    {
+      backpressure_stats_t diff;
+      diff.waited    = waited    - rhs.waited;
+      diff.spilled   = spilled   - rhs.spilled;
+      diff.timed_out = timed_out - rhs.timed_out;
+      diff.rejected  = rejected  - rhs.rejected;
+      return diff;
+    }
+
+    std::string to_string() const
+    {
+      return "waited="     + std::to_string(waited)
+           + " spilled="   + std::to_string(spilled)
+           + " timed_out=" + std::to_string(timed_out)
+           + " rejected="  + std::to_string(rejected);
+    }
+  };
+
   /**
    * @struct params_t
    * @brief 발행자 풀의 설정 파라미터
@@ -30,8 +68,35 @@ public:
     size_t                    queue_size    = 10000;  ///< 각 발행자의 큐 크기
     std::vector<std::string>  urls;                    ///< NATS 서버 URL
     std::string               subject;                ///< 발행 주제
+    wait_strategy_t           wait = wait_strategy_t::adaptive; ///< 발행자 대기방식
+    CpuAffinity               affinity;               ///< 발행자 쓰레드 CPU 고정
+    publish_batch_t           batch;                  ///< 배치 발행 (기본값: 사용안함)
+    backpressure_t            backpressure = backpressure_t::fail; ///< 발행큐가 꽉 찼을때의 처리
+    uint32_t                  block_ms     = 100;     ///< backpressure_t::block 최대 대기시간
+    publisher_select_t        select       = publisher_select_t::round_robin; ///< 발행자 선택 방식
+    publish_ack_t             ack;                    ///< ack 발행 (기본값: 사용안함)
   };
 
+  NatsPublisherPool() : pool_id_(next_pool_id()++) {}
+
+  /**
+   * @brief 워커 키 발급 (publisher_select_t::worker_affine)
+   * @details 프로세스 전체에서 0부터 차례대로 발급합니다. 워커 생성시 한번 받아서 bind_worker에 사용합니다.
+   *          워커 번호는 워커풀(NatsRecvers의 클라이언트)마다 1부터이므로 키로 쓰면 풀 사이에서 겹칩니다.
+   */
+  static size_t next_worker_key() { return worker_keys().fetch_add(1); }
+
+  /**
+   * @brief 현재 쓰레드를 워커 키에 고정 (publisher_select_t::worker_affine)
+   * @param key next_worker_key()로 받은 키. 워커 쓰레드 시작시 한번 호출합니다.
+   * @details 쓰레드별 값이므로 모든 풀에 같이 적용됩니다.
+   */
+  static void bind_worker(const size_t &key)
+  {
+    worker_key()   = key;
+    worker_bound() = true;
+  }
+
   /**
    * @brief 발행자 수 설정
    * @param num 발행자 수 (기본값: 1)
@@ -54,6 +119,79 @@ public:
     return *this;
   }
 
+  /**
+   * @brief 발행자 대기방식 설정
+   * @param strategy 큐가 비었을때 발행자 쓰레드의 대기방식 (기본값: adaptive)
+   * @return 현재 객체 참조
+   */
+  NatsPublisherPool &set_wait_strategy(const wait_strategy_t &strategy)
+  {
+    params_.wait = strategy;
+    return *this;
+  }
+
+  /**
+   * @brief 발행자 쓰레드 CPU 고정 설정
+   * @param affinity round-robin인 경우 발행자마다 CPU 하나씩 차례로 고정 (기본값: 고정안함)
+   * @return 현재 객체 참조
+   */
+  NatsPublisherPool &set_affinity(const CpuAffinity &affinity)
+  {
+    params_.affinity = affinity;
+    return *this;
+  }
+
+  /**
+   * @brief 배치 발행 설정
+   * @param batch 최대 건수/대기시간(us)/크기. max_count가 0이면 사용안함
+   * @return 현재 객체 참조
+   * @see NatsPublisher::set_batch
+   */
+  NatsPublisherPool &set_batch(const publish_batch_t &batch)
+  {
+    params_.batch = batch;
+    return *this;
+  }
+
+  /**
+   * @brief 발행큐가 꽉 찼을때의 처리 설정
+   * @param policy fail, block, spill (기본값: fail) @see backpressure_t
+   * @param block_ms block인 경우 최대 대기시간(ms)
+   * @return 현재 객체 참조
+   */
+  NatsPublisherPool &set_backpressure(const backpressure_t &policy, const uint32_t &block_ms = 100)
+  {
+    params_.backpressure = policy;
+    params_.block_ms     = block_ms;
+    return *this;
+  }
+
+  /**
+   * @brief 발행자 선택 방식 설정
+   * @param select round_robin, worker_affine, least_depth (기본값: round_robin) @see publisher_select_t
+   * @return 현재 객체 참조
+   */
+  NatsPublisherPool &set_select(const publisher_select_t &select)
+  {
+    params_.select = select;
+    return *this;
+  }
+
+  /**
+   * @brief ack 발행 설정
+   * @param ack window(in-flight 최대 건수)/재시도 횟수/backoff. window가 0이면 사용안함
+   * @return 현재 객체 참조
+   * @see NatsPublisher::set_ack
+   */
+  NatsPublisherPool &set_ack(const publish_ack_t &ack)
+  {
+    params_.ack = ack;
+    return *this;
+  }
+
+  /// ack 발행 사용 여부
+  bool ack_enabled() const { return params_.ack.window > 0; }
+
   /**
    * @brief 서버 URL 설정
    * @param url NATS 서버 URL
@@ -80,17 +218,55 @@ public:
    * @brief 메시지 발행
    * @param message 발행할 메시지
    * @param subject subject
+   * @return 0 : 성공, -1 : subject 없음 또는 큐 닫힘, EAGAIN : 큐 꽉참(fail, spill), ETIMEDOUT : block_ms 초과(block)
+   */
+  int publish(const std::string &message, std::string subject = "", publish_callback_t on_complete = nullptr)
+  {
+    return publish(std::string(message), std::move(subject), std::move(on_complete));
+  }
+
+  /**
+   * @brief 메시지 발행 (이동)
+   * @details message는 복사하지 않고 발행큐 항목으로 이동됩니다.
+   * 실패(0이 아닌 값)한 경우 message는 원래 값으로 되돌려지므로 호출자가 다시 사용할 수 있습니다.
+   * @param on_complete 발행 완료 콜백(발행자 쓰레드에서 호출). ack 모드이면 서버 확인 후 호출됩니다.
+   *                    0이 아닌 값을 리턴한 경우(큐 적재 실패)에는 호출하지 않습니다.
+   * @return publish(const std::string &, std::string)와 같음
    */
-  bool publish(const std::string &message, std::string subject = "")
+  int publish(std::string &&message, std::string subject = "", publish_callback_t on_complete = nullptr)
   {
     if (subject.empty() == true)
     {
-      if (params_.subject.empty() == true) { sfs_log.error() << "subject is empty"; return false; }
+      if (params_.subject.empty() == true) { sfs_log.error() << "subject is empty"; return -1; }
       subject = params_.subject;
     }
 
-    publishers_[sequence_++ % publishers_.size()].publish(subject, message);
-    return true;
+    if (publishers_.empty() == true)
+      return -1;
+
+    queueable_publish item(publish_item_t{std::move(subject), std::move(message), std::chrono::steady_clock::now(), std::move(on_complete)});
+
+    NatsPublisher &publisher = select();
+    int res = publisher.push(item);
+    if (res == EAGAIN)
+    {
+      switch (params_.backpressure)
+      {
+        case backpressure_t::block: res = push_blocked(publisher, item); break;
+        case backpressure_t::spill: res = push_spilled(publisher, item); break;
+        default: break;
+      }
+    }
+
+    if (res == 0)
+      return 0;
+
+    if (res == ETIMEDOUT) ++timed_out_;
+    else                  ++rejected_;
+
+    message = std::move(item.get()->message);
+    item.destroy();
+    return res;
   }
 
   /**
@@ -105,6 +281,11 @@ public:
     {
       publishers_.emplace_back(params_.queue_size);
       publishers_.back().assigned_no(index+1);
+      publishers_.back().set_wait_strategy(params_.wait);
+      publishers_.back().set_latency_histogram(&latency_);
+      publishers_.back().set_affinity(params_.affinity);
+      publishers_.back().set_batch(params_.batch, &batch_size_);
+      publishers_.back().set_ack(params_.ack);
     }
 
     for (auto &publisher : publishers_)
@@ -119,6 +300,40 @@ public:
     return true;
   }
 
+  /**
+   * @brief 발행큐 적재 -> NATS publish 지연시간(us)
+   */
+  const LatencyHistogram &publish_latency() const { return latency_; }
+
+  /**
+   * @brief 배치 발행시 배치당 건수 (LatencyHistogram에 건수로 기록)
+   */
+  const LatencyHistogram &publish_batch_size() const { return batch_size_; }
+
+  /**
+   * @brief 발행자별 큐 깊이, in-flight, ack 통계
+   */
+  std::vector<publisher_stats_t> publisher_stats() const
+  {
+    std::vector<publisher_stats_t> stats;
+    for (auto &publisher : publishers_)
+      stats.push_back(publisher.stats());
+    return stats;
+  }
+
+  /**
+   * @brief 발행큐가 꽉 찬 경우의 처리 결과 누적 건수
+   */
+  backpressure_stats_t backpressure_stats() const
+  {
+    backpressure_stats_t stats;
+    stats.waited    = waited_   .load(std::memory_order_relaxed);
+    stats.spilled   = spilled_  .load(std::memory_order_relaxed);
+    stats.timed_out = timed_out_.load(std::memory_order_relaxed);
+    stats.rejected  = rejected_ .load(std::memory_order_relaxed);
+    return stats;
+  }
+
   /**
    * @brief 발행자 풀 중지
    */
@@ -130,8 +345,86 @@ public:
     publishers_.clear();
   }
 
+protected:
+  /// params_.select에 따라 발행자 선택. publishers_는 1개 이상
+  NatsPublisher &select()
+  {
+    const size_t count = publishers_.size();
+    switch (params_.select)
+    {
+      case publisher_select_t::worker_affine:
+        return publishers_[(worker_bound() == true ? worker_key() : static_cast<size_t>(thread_uindex)) % count];
+      case publisher_select_t::least_depth:
+        return least_loaded_selector().select(publishers_, count, 0);
+      default:
+        break;
+    }
+
+    // 쓰레드별 순번. NatsSender와 NatsResult를 번갈아 호출해도 치우치지 않도록 풀마다 따로 둡니다.
+    static thread_local size_t sequences[max_pools] = { 0, };
+    return publishers_[(static_cast<size_t>(thread_uindex) + sequences[pool_id_ % max_pools]++) % count];
+  }
+
+  static size_t &worker_key  () { static thread_local size_t value = 0;     return value; }
+  static bool   &worker_bound() { static thread_local bool   value = false; return value; }
+  static std::atomic<size_t> &next_pool_id() { static std::atomic<size_t> value{0}; return value; }
+  static std::atomic<size_t> &worker_keys () { static std::atomic<size_t> value{0}; return value; }
+
+  /// 자리가 날때까지 spin 후 1us부터 2배씩 최대 1ms까지 sleep하며 block_ms 동안 재시도
+  int push_blocked(NatsPublisher &publisher, queueable_publish &item)
+  {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(params_.block_ms);
+    int64_t    sleep_us = 1;
+
+    for (size_t spin = 0; ; ++spin)
+    {
+      if (spin < 100)
+        cpu_relax();
+      else
+      {
+        if (std::chrono::steady_clock::now() >= deadline)
+          return ETIMEDOUT;
+        std::this_thread::sleep_for(std::chrono::microseconds(sleep_us));
+        sleep_us = std::min<int64_t>(sleep_us * 2, 1000);
+      }
+
+      int res = publisher.push(item);
+      if (res == 0) { ++waited_; return 0; }
+      if (res != EAGAIN) return res;
+    }
+  }
+
+  /// 큐 깊이가 가장 작은 다른 발행자에 한번 더 시도
+  int push_spilled(NatsPublisher &full, queueable_publish &item)
+  {
+    NatsPublisher *target = nullptr;
+    for (auto &publisher : publishers_)
+    {
+      if (&publisher == &full)
+        continue;
+      if (target == nullptr || publisher.size() < target->size())
+        target = &publisher;
+    }
+
+    if (target == nullptr)
+      return EAGAIN;
+
+    int res = target->push(item);
+    if (res == 0)
+      ++spilled_;
+    return res;
+  }
+
 protected:
   params_t params_;                       ///< 설정 파라미터
   std::deque<NatsPublisher> publishers_;  ///< 발행자 목록
-  size_t sequence_ = 0;                   ///< Round-robin 시퀀스
+  static constexpr size_t max_pools = 16; ///< round_robin 쓰레드별 순번 슬롯 수
+  const size_t pool_id_;                  ///< round_robin 순번 슬롯
+  LatencyHistogram latency_;              ///< 발행 지연시간
+  LatencyHistogram batch_size_;           ///< 배치당 건수
+
+  std::atomic<uint64_t> waited_   {0};    ///< @see backpressure_stats_t
+  std::atomic<uint64_t> spilled_  {0};
+  std::atomic<uint64_t> timed_out_{0};
+  std::atomic<uint64_t> rejected_ {0};
 };
@@ -11,12 +11,13 @@
 #include <FilterTpsMeter.h>
 #include <extra/ScopeExit.h>
 #include <extra/Toggle.h>
+#include <extra/WaitStrategy.h>
+#include <extra/CpuAffinity.h>
 
-#include <sfs_nats_cli.h>
+#include <Transport.h>
 #include <deque>
 #include <future>
-
-using NatsClient = SfsNatsClient<std::string>;
+#include <thread>
 
 // NatsRecvers
 // +---------------+    +-----------------+
@@ -49,6 +50,14 @@ public:
     size_t                    client_num = 1;           ///< 클라이언트 수
     size_t                    worker_num = 1;           ///< nats 클라이언트당 워커 수
     size_t                    worker_queue_size = 10000;///< 워커 큐 크기
+    wait_strategy_t           worker_wait = wait_strategy_t::adaptive; ///< 워커 대기방식
+    bool                      worker_steal = false;     ///< 워커간 작업 훔치기
+    typename WORKER_POOL::autoscale_t worker_autoscale; ///< 워커 수 자동조절
+    size_t                    recv_batch_max = 64;      ///< 한번에 워커풀에 넣는 최대 건수
+    wait_strategy_t           recv_full_wait = wait_strategy_t::backoff; ///< 워커큐가 꽉 찼을때 수신 쓰레드 대기방식
+    uint32_t                  recv_full_wait_ms = 100;  ///< 워커큐가 꽉 찼을때 콜백 한번에서 기다리는 최대 시간(ms)
+    CpuAffinity               affinity;                 ///< NATS 수신 콜백 쓰레드 CPU 고정
+    CpuAffinity               worker_affinity;          ///< 워커 쓰레드 CPU 고정
     std::vector<std::string>  urls;                     ///< 서버 URL
     std::string               subject;                  ///< 구독 주제
     std::string               queue_group;              ///< 큐 그룹명
@@ -91,11 +100,80 @@ public:
     return *this;
   }
 
+  /**
+   * @brief 워커 대기방식 설정
+   * @param strategy 큐가 비었을때 워커의 대기방식 (기본값: adaptive)
+   * @return 현재 객체에 대한 참조 (메서드 체이닝용)
+   */
+  NatsRecvers &set_worker_wait_strategy(const wait_strategy_t &strategy)
+  {
+    params_.worker_wait = strategy;
+    return *this;
+  }
+
+  /**
+   * @brief 워커간 작업 훔치기 설정
+   * @param enable true이면 쉬고있는 워커가 다른 워커의 큐에서 작업을 가져옵니다. (기본값: false)
+   * @return 현재 객체에 대한 참조 (메서드 체이닝용)
+   * @see WorkerPool::work_stealing
+   */
+  NatsRecvers &set_worker_stealing(const bool &enable)
+  {
+    params_.worker_steal = enable;
+    return *this;
+  }
+
+  /**
+   * @brief 워커 수 자동조절 설정
+   * @param autoscale 최소/최대 워커 수, 조절 기준 (기본값: 사용안함)
+   * @return 현재 객체에 대한 참조 (메서드 체이닝용)
+   * @details 워커 풀마다 복사되므로 wait_probe의 상태도 풀별로 유지됩니다. @see WorkerPool::set_autoscale
+   */
+  NatsRecvers &set_worker_autoscale(const typename WORKER_POOL::autoscale_t &autoscale)
+  {
+    params_.worker_autoscale = autoscale;
+    return *this;
+  }
+
+  /**
+   * @brief 수신 배치 설정
+   * @param max 한번에 워커풀에 넣는 최대 건수 (기본값: 64)
+   * @param full_wait 워커큐가 꽉 찼을때 수신 쓰레드의 대기방식 (기본값: backoff) @see WorkerPool::push_bulk
+   * @param full_wait_ms 워커큐가 꽉 찼을때 콜백 한번에서 기다리는 최대 시간(ms) (기본값: 100).
+   *                     지나면 넣지 못한 메세지는 워커의 overflow로 넘깁니다.(FilterWorker는 폐기 결과를 보냄)
+   * @return 현재 객체에 대한 참조 (메서드 체이닝용)
+   * @details
+   * 전송이 한번에 여러건을 줄때만 모입니다. ShmTransport는 링에 쌓인 만큼 한번에 주지만,
+   * NATS와 loopback은 메세지마다 콜백하므로(라이브러리가 쌓인 건수를 알려주지 않음) 항상 한건씩입니다.
+   * 이때도 full_wait / full_wait_ms는 같이 적용되므로 워커가 밀리면 수신 쓰레드는 쉬면서 기다립니다.
+   * busy_spin이면 대기시간 동안 수신 쓰레드가 쉬지 않고 재시도합니다.
+   */
+  NatsRecvers &set_recv_batch(const size_t &max, const wait_strategy_t &full_wait, const uint32_t &full_wait_ms = 100)
+  {
+    params_.recv_batch_max    = max;
+    params_.recv_full_wait    = full_wait;
+    params_.recv_full_wait_ms = full_wait_ms;
+    return *this;
+  }
+
+  /**
+   * @brief CPU 고정 설정
+   * @param affinity NATS 수신 콜백 쓰레드. 쓰레드는 NATS 라이브러리가 만들므로 구독마다 첫 콜백에서 적용합니다.
+   * @param worker_affinity 워커 쓰레드
+   * @return 현재 객체에 대한 참조 (메서드 체이닝용)
+   */
+  NatsRecvers &set_affinity(const CpuAffinity &affinity, const CpuAffinity &worker_affinity)
+  {
+    params_.affinity        = affinity;
+    params_.worker_affinity = worker_affinity;
+    return *this;
+  }
+
   /**
    * @brief NATS 서버 URL 설정
    * @param url NATS 서버 URL
    * @return 현재 객체에 대한 참조 (메서드 체이닝용)
-   * @details NATS 서버 연결에 사용할 URL을 설정합니다.
+   * @details NATS 서버 연결에 사용할 URL을 설정합니다. loopback://이름 이면 같은 프로세스 안에서 수신 @see make_transport
    */
   NatsRecvers &set_server_urls(const std::vector<std::string> &urls)
   {
@@ -148,6 +226,9 @@ public:
    * @details
    * - 모든 NATS 클라이언트의 연결을 종료합니다.
    * - 모든 워커 풀의 작업을 중지시킵니다.
+   * - 워커 객체는 파괴하지 않습니다.(소멸자 또는 다음 start에서 정리)
+   *   워커가 남긴 ack 발행 완료 콜백(FilterWorker::completion)은 발행자 쓰레드에서 워커를 참조하므로
+   *   워커가 마지막으로 발행한 항목을 발행자가 모두 처리(NatsPublisherPool::stop)한 후에 파괴되어야 합니다.
    */
   void stop()
   {
@@ -157,32 +238,18 @@ public:
       auto &client      = pair.first;
       auto &worker_pool = pair.second;
 
+      if (client == nullptr)
+        continue;
+
       client->drain();
       worker_pool.stop();
 
       client.reset();
     }
-
-    clients_.clear();
-  }
-
-protected:
-  /**
-   * @brief NATS 에러 발생시 호출되는 콜백 함수
-   * @param nc NATS 연결 객체
-   * @param sub NATS 구독 객체
-   * @param err 발생한 에러 상태
-   * @param closure 사용자 정의 데이터
-   * @details NATS 서버 연결이나 구독 중 발생하는 에러를 처리합니다.
-   */
-  static void
-  nats_error_callback(natsConnection *nc, natsSubscription *sub, natsStatus err, void *closure)
-  {
-    (void)nc; (void)sub; (void)err; (void)closure;
   }
 
 protected:
-  using NatsClientSptr = std::shared_ptr<NatsClient>;  ///< NATS 클라이언트 스마트 포인터 타입
+  using NatsClientSptr = std::shared_ptr<Transport>;  ///< 전송(NATS, loopback) 스마트 포인터 타입
 
   params_t params_;  ///< 수신자 설정 파라미터
   std::deque<std::pair<NatsClientSptr, WORKER_POOL>> clients_;  ///< NATS 클라이언트와 워커 풀 쌍의 목록
@@ -194,9 +261,10 @@ protected:
  * 1. 설정된 클라이언트 수만큼 clients_ 컨테이너를 초기화합니다.
  * 2. 각 클라이언트-워커풀 쌍에 대해:
  *    - 워커 풀을 설정된 워커 수와 큐 크기로 초기화
+ *    - 구독이 하나면 워커 큐를 SPSC, 여러개면 MPSC로 설정
  *    - NATS 클라이언트 생성 및 서버 연결
  *    - 워커 풀 시작
- *    - 메시지 구독 설정
+ *    - 메시지 구독 설정 (전송이 한번에 준 메세지를 WorkerPool::push_bulk로 넣음)
  * 3. 에러 발생시 적절한 에러 처리 수행
  */
 template<typename WORKER_POOL> bool
@@ -204,8 +272,14 @@ NatsRecvers<WORKER_POOL>::start()
 {
   Toggle error_toggle(false, false);
 
+  clients_.clear();  ///< 이전 stop에서 남겨둔 워커 풀
   clients_.resize(params_.client_num);
 
+  // 클라이언트마다, start마다 params_에 추가하면 같은 주제를 중복 구독하므로 복사본에 한번만 추가한다.
+  auto subjects = params_.subjects;
+  if (params_.subject.empty() == false)
+    subjects.push_front({params_.subject, params_.queue_group});
+
   try
   {
     for (std::pair<NatsClientSptr, WORKER_POOL> &pair : clients_)
@@ -213,34 +287,58 @@ NatsRecvers<WORKER_POOL>::start()
       auto &client     = pair.first;
       auto &worker_pool= pair.second;
 
-      client = std::make_shared<NatsClient>();
+      client = make_transport(params_.urls);
 
-      worker_pool.set_num_of_workers(params_.worker_num, params_.worker_queue_size);
+      worker_pool.set_num_of_workers(params_.worker_num, params_.worker_queue_size)
+                 .set_autoscale(params_.worker_autoscale);
+      // 구독이 하나면 이 워커풀에 push하는 쓰레드는 해당 구독의 콜백 쓰레드 하나뿐이다.
+      // 단, loopback처럼 발행 쓰레드에서 콜백하는 경우에는 발행자 수만큼 push 쓰레드가 있다.
+      worker_pool.single_producer(subjects.size() == 1 && client->sync_delivery() == false);
+      worker_pool.set_wait_strategy(params_.worker_wait);
+      worker_pool.work_stealing(params_.worker_steal);
+      worker_pool.set_affinity(params_.worker_affinity);
       worker_pool.start();
 
-      client->connectServers(params_.urls, NatsRecvers<WORKER_POOL>::nats_error_callback);
-
-      if (params_.subject.empty() == false)
-        params_.subjects.push_front({params_.subject, params_.queue_group});
+      client->connect(params_.urls);
 
-      for (auto &pair : params_.subjects)
+      for (auto &pair : subjects)
       {
         auto &subject = pair.first;
         auto &group   = pair.second;
         // queue group name
-        client->subscribeGroup(subject, group, [&worker_pool, subject](const std::string &message)
+        // loopback처럼 발행 쓰레드에서 콜백하는 경우에는 발행자 쓰레드를 고정하지 않는다.
+        CpuAffinity affinity = client->sync_delivery() == true ? CpuAffinity() : params_.affinity;
+        wait_strategy_t full_wait    = params_.recv_full_wait;
+        uint32_t        full_wait_ms = params_.recv_full_wait_ms;
+        std::thread::id pinned;       ///< 이 구독의 affinity를 적용한 콜백 쓰레드
+        client->subscribe_bulk(subject, group, params_.recv_batch_max,
+                               [&worker_pool, subject, affinity, full_wait, full_wait_ms, pinned](std::vector<std::string> &messages) mutable
         {
-          while (true)
+          // 콜백 쓰레드는 NATS 라이브러리가 만드므로 구독별로 콜백 쓰레드가 바뀔때(첫 콜백) 고정한다.
+          // 쓰레드별(thread_local)로 기억하면 같은 쓰레드의 다른 구독은 자기 affinity를 적용하지 못한다.
+          // affinity가 없으면(loopback 등) 여러 쓰레드에서 동시에 호출될 수 있으므로 확인하지 않는다.
+          if (affinity.empty() == false && pinned != std::this_thread::get_id())
           {
-            int res = worker_pool.push(std::make_pair(subject, message));
-            switch (res)
-            {
-              case      0 : return; // 정상
-              case     -1 : return; // stop 시그널 받을때.
-              case EAGAIN :         // 큐가 꽉 찾을때. 재시도.
-              default     : continue;
-            }
+            pinned = std::this_thread::get_id();
+            affinity.apply();
           }
+
+          // 전송이 넘겨준 메세지는 이동하므로 복사는 subject뿐이다.
+          static thread_local std::vector<std::pair<std::string, std::string>> batch;
+          batch.clear();
+          for (auto &message : messages)
+            batch.emplace_back(subject, std::move(message));
+
+          // 워커큐가 꽉 차면 full_wait 방식으로 쉬면서 재시도하고, full_wait_ms가 지나면 워커의 overflow로 넘긴다.
+          size_t done = worker_pool.push_bulk(batch.data(), batch.size(), full_wait, full_wait_ms);
+          if (done == batch.size())
+            return;
+
+          // stop 중이면 남은 메세지도 overflow로 넘긴다.(FilterWorker는 폐기 결과를 보냄)
+          size_t rest = batch.size() - done;
+          size_t sent = worker_pool.overflow(batch.data() + done, rest);
+          sfs_log.error() << subject << ": worker pool closed, " << rest << " messages not queued"
+                          << (sent == rest ? " (overflowed)" : " (dropped)");
         });
       }
     }
@@ -251,7 +349,7 @@ NatsRecvers<WORKER_POOL>::start()
       sfs_log.error() << params_.subject + ": " + e.what();
     return false;
   }
-  catch (const SfsNatsException &e)
+  catch (const TransportException &e)
   {
     if (error_toggle.turn_on() == true)
       sfs_log.error() << params_.subject + ": " + e.what();
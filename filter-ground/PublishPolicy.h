@@ -0,0 +1,102 @@
+/*
+ * PublishPolicy.h
+ *
+ *  Created on: 2025. 3. 25.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/// NatsPublisherPool의 정책 값들. 설정(AppConf)에서 NatsPublisherPool 전체를 include하지 않도록 분리
+
+/**
+ * @brief 발행큐가 꽉 찼을때의 처리 (NatsPublisherPool::set_backpressure)
+ * @details
+ *  fail  : 바로 EAGAIN을 리턴합니다. 메세지는 호출자에게 되돌려집니다.
+ *  block : 큐에 자리가 날때까지 block_ms 동안 기다립니다. 넘으면 ETIMEDOUT.
+ *          호출한 워커가 느려지므로 워커큐가 차고 수신측에서 유입이 줄어듭니다.
+ *  spill : 큐 깊이가 가장 작은 다른 발행자에 넣습니다. 그것도 꽉 찼으면 EAGAIN.
+ *          넘긴 메세지는 다른 연결로 나가므로 worker_affine의 워커별 순서가 보장되지 않습니다.
+ */
+enum class backpressure_t : uint8_t
+{
+  fail = 0,
+  block,
+  spill,
+};
+
+inline const char *
+to_string(const backpressure_t &policy)
+{
+  switch (policy)
+  {
+    case backpressure_t::fail : return "fail";
+    case backpressure_t::block: return "block";
+    case backpressure_t::spill: return "spill";
+  }
+  return "unknown";
+}
+
+/// 설정 문자열을 backpressure_t로 변환. 모르는 이름이면 false
+inline bool
+to_backpressure(const std::string &name, backpressure_t &policy)
+{
+  static const backpressure_t all[] = { backpressure_t::fail, backpressure_t::block, backpressure_t::spill };
+  for (const auto &item : all)
+  {
+    if (name != to_string(item))
+      continue;
+    policy = item;
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief 메세지를 넣을 발행자 선택 방식 (NatsPublisherPool::set_select)
+ * @details
+ * 여러 워커 쓰레드가 동시에 publish하므로 모두 공유 카운터 없이 동작합니다.
+ *
+ *  round_robin   : 쓰레드별 순번으로 차례대로 선택합니다.
+ *  worker_affine : 워커 키 K(프로세스 전체에서 고유, NatsPublisherPool::next_worker_key)는 항상 발행자 K % P를 사용합니다.
+ *                  같은 워커의 메세지는 같은 연결로 순서대로 나갑니다. 워커가 아닌 쓰레드는 thread_uindex를 사용합니다.
+ *                  backpressure_t::spill과 같이 사용하면 넘긴 메세지는 다른 연결로 나가므로 순서가 보장되지 않습니다.
+ *  least_depth   : 큐가 가장 적게 쌓인 발행자를 선택합니다. publish마다 발행자 수만큼 size()를 읽습니다.
+ */
+enum class publisher_select_t : uint8_t
+{
+  round_robin = 0,
+  worker_affine,
+  least_depth,
+};
+
+inline const char *
+to_string(const publisher_select_t &select)
+{
+  switch (select)
+  {
+    case publisher_select_t::round_robin  : return "round_robin";
+    case publisher_select_t::worker_affine: return "worker_affine";
+    case publisher_select_t::least_depth  : return "least_depth";
+  }
+  return "unknown";
+}
+
+/// 설정 문자열을 publisher_select_t로 변환. 모르는 이름이면 false
+inline bool
+to_publisher_select(const std::string &name, publisher_select_t &select)
+{
+  static const publisher_select_t all[] = { publisher_select_t::round_robin, publisher_select_t::worker_affine,
+                                            publisher_select_t::least_depth };
+  for (const auto &item : all)
+  {
+    if (name != to_string(item))
+      continue;
+    select = item;
+    return true;
+  }
+  return false;
+}
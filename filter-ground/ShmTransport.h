@@ -0,0 +1,256 @@
+/*
+ * ShmTransport.h
+ *
+ *  Created on: 2025. 3. 24.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <Transport.h>
+#include <extra/ShmRing.h>
+#include <extra/MThread.h>
+#include <Logger.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <thread>
+
+/**
+ * @class ShmReceiver
+ * @brief ShmRing에서 꺼내 구독 콜백을 호출하는 수신 쓰레드 (구독마다 하나)
+ * @details 깨어나면 링에 있는 만큼(최대 max건) 꺼내서 한번에 전달합니다.
+ * 생산자가 잡은 채 멈춘 슬롯은 에러로그를 남기고, 생산자가 죽었으면 버리고 진행합니다.(ShmRing::pop)
+ */
+class ShmReceiver : public MThread
+{
+public:
+  static constexpr int64_t wait_ms = 100;   ///< 대기중 종료 확인 주기
+
+  ShmReceiver(std::unique_ptr<ShmRing> ring, const size_t &max, Transport::on_messages_t callback)
+  : ring_(std::move(ring)), max_(std::max<size_t>(max, 1)), callback_(std::move(callback)) {}
+
+  ~ShmReceiver() { stop(); }
+
+  bool start()
+  {
+    running_ = true;
+    return MThread::start();
+  }
+
+  /// 리턴 후에는 콜백이 호출되지 않습니다. 링에 남은 메세지는 다음 구독자가 받습니다.
+  void stop()
+  {
+    if (running_.exchange(false) == false)
+      return;
+
+    ring_->wake_all();
+    MThread::join();
+  }
+
+protected:
+  void run() override
+  {
+    const int64_t            timeout_ms = wait_ms;
+    std::vector<std::string> messages(max_);
+    while (running_.load(std::memory_order_relaxed) == true)
+    {
+      messages.resize(max_);
+      int res = ring_->pop(messages[0], timeout_ms);
+      if (res != 0)
+      {
+        log_stuck(*ring_, res, "producer");
+        continue;
+      }
+
+      size_t count = 1;
+      while (count < max_ && ring_->try_pop(messages[count]) == true)
+        ++count;
+
+      messages.resize(count);
+      callback_(messages);
+    }
+  }
+
+public:
+  /// ShmRing::pop, recover_tail의 EBUSY, EOWNERDEAD 로그
+  static void log_stuck(const ShmRing &ring, const int &res, const char *side)
+  {
+    if (res == EBUSY)
+      sfs_log.warn() << ring.name() + ": " + side + " holds a slot over " + std::to_string(ShmRing::stuck_ms) + "ms";
+    else if (res == EOWNERDEAD)
+      sfs_log.error() << ring.name() + ": dropped a slot held by a dead " + side + " (dropped " + std::to_string(ring.dropped()) + ")";
+  }
+
+protected:
+  std::unique_ptr<ShmRing> ring_;
+  size_t                   max_;
+  Transport::on_messages_t callback_;
+  std::atomic<bool>        running_{false};
+};
+
+/**
+ * @class ShmTransport
+ * @brief 같은 호스트의 필터 프로세스끼리 공유메모리 링(ShmRing)으로 전달하는 Transport (URL: shm://이름)
+ * @details
+ * - subject마다 링 하나(/dev/shm/sfs.이름.subject)를 사용합니다.
+ *   보내는 필터의 nats.next.urls와 받는 필터의 nats.recv.urls를 같은 shm://이름 으로 설정합니다.
+ * - 링은 하나의 queue group처럼 동작합니다. 구독자(프로세스, 구독)들이 나눠서 받으며 group 이름은 구분하지 않습니다.
+ * - 구독마다 수신 쓰레드 하나가 spin 후 futex로 대기하며 콜백을 호출합니다.(subscribe_bulk는 링에 쌓인 만큼 한번에)
+ * - publish는 링이 꽉 차면 full_ms 동안 기다린 후 TransportException을 던집니다.(NatsPublisher의 실패 처리를 따름)
+ *   기다리는 동안 죽은 소비자가 잡은 슬롯이 있으면 풀어줍니다.(ShmRing::recover_tail)
+ * - slot_bytes보다 큰 메세지는 /dev/shm에 따로 써서(spill) 전달하므로 느립니다. slot_bytes는 메세지 크기에 맞춥니다.
+ * - flush는 할일이 없습니다.(publish가 리턴하면 링에 들어간 것)
+ *
+ * URL 옵션 (링을 처음 만드는 프로세스의 slots, slot_bytes가 사용됨)
+ *  shm://이름?slots=8192&slot_bytes=8192&full_ms=1000
+ */
+class ShmTransport : public Transport
+{
+public:
+  static const char *scheme() { return "shm://"; }
+
+  ~ShmTransport() { drain(); }
+
+  void connect(const std::vector<std::string> &urls) override
+  {
+    if (urls.empty() == true || urls.front().compare(0, strlen(scheme()), scheme()) != 0)
+      throw TransportException("shm url required: shm://name");
+
+    parse_url(urls.front().substr(strlen(scheme())));
+  }
+
+  void publish(const std::string &subject, const std::string &message) override
+  {
+    ShmRing &ring = ring_of(subject);
+
+    int res = ring.try_push(message.data(), message.size());
+    if (res == EAGAIN)
+      res = push_waited(ring, message);
+
+    if (res == EAGAIN)
+      throw TransportException("shm ring full: " + ring_name(subject));
+    if (res != 0)
+      throw TransportException("shm spill failed: " + ring_name(subject) + ": " + strerror(res));
+  }
+
+  void flush() override {}
+
+  void subscribe(const std::string &subject, const std::string &group, on_message_t callback) override
+  {
+    subscribe_bulk(subject, group, 1, [callback](std::vector<std::string> &messages)
+    {
+      for (auto &message : messages)
+        callback(message);
+    });
+  }
+
+  void subscribe_bulk(const std::string &subject, const std::string &group, const size_t &max, on_messages_t callback) override
+  {
+    (void)group;
+
+    std::unique_ptr<ShmReceiver> receiver(new ShmReceiver(open_ring(subject), max, std::move(callback)));
+    if (receiver->start() == false)
+      throw TransportException("shm receiver start failed: " + receiver->error());
+
+    receivers_.push_back(std::move(receiver));
+  }
+
+  void drain() override
+  {
+    for (auto &receiver : receivers_)
+      receiver->stop();
+    receivers_.clear();
+  }
+
+protected:
+  /// 이름?key=value&... 형식. 모르는 key이면 예외
+  void parse_url(const std::string &rest)
+  {
+    size_t query = rest.find('?');
+    name_ = rest.substr(0, query);
+    if (name_.empty() == true || name_.find('/') != std::string::npos)
+      throw TransportException("invalid shm name: " + rest);
+
+    while (query != std::string::npos)
+    {
+      size_t      next  = rest.find('&', query + 1);
+      std::string pair  = rest.substr(query + 1, next == std::string::npos ? std::string::npos : next - query - 1);
+      size_t      equal = pair.find('=');
+      std::string key   = pair.substr(0, equal);
+      uint64_t    value = 0;
+
+      try { value = equal == std::string::npos ? 0 : std::stoull(pair.substr(equal + 1)); }
+      catch (const std::exception &) { throw TransportException("invalid shm option: " + pair); }
+
+      if      (key == "slots"     ) slots_      = std::max<uint64_t>(value, 2);
+      else if (key == "slot_bytes") slot_bytes_ = std::max<uint64_t>(value, 1);
+      else if (key == "full_ms"   ) full_ms_    = value;
+      else throw TransportException("unknown shm option: " + pair);
+
+      query = next;
+    }
+  }
+
+  std::string ring_name(const std::string &subject) const
+  {
+    return "sfs." + name_ + "." + subject;
+  }
+
+  std::unique_ptr<ShmRing> open_ring(const std::string &subject)
+  {
+    if (name_.empty() == true)
+      throw TransportException("shm not connected");
+
+    std::unique_ptr<ShmRing> ring(new ShmRing());
+    std::string              error;
+    if (ring->open(ring_name(subject), slots_, slot_bytes_, error) == false)
+      throw TransportException(error);
+    return ring;
+  }
+
+  /// publish는 발행자 쓰레드 하나에서만 호출되므로 잠금 없이 subject별 링을 보관한다.
+  ShmRing &ring_of(const std::string &subject)
+  {
+    auto &ring = rings_[subject];
+    if (ring == nullptr)
+      ring = open_ring(subject);
+    return *ring;
+  }
+
+  /// NatsPublisherPool::push_blocked와 같은 방식으로 full_ms 동안 재시도. 잠들때마다 멈춘 소비자를 확인한다.
+  int push_waited(ShmRing &ring, const std::string &message)
+  {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(full_ms_);
+    int64_t    sleep_us = 1;
+
+    for (size_t spin = 0; ; ++spin)
+    {
+      if (spin < 100)
+        cpu_relax();
+      else
+      {
+        if (std::chrono::steady_clock::now() >= deadline)
+          return EAGAIN;
+        ShmReceiver::log_stuck(ring, ring.recover_tail(), "consumer");
+        std::this_thread::sleep_for(std::chrono::microseconds(sleep_us));
+        sleep_us = std::min<int64_t>(sleep_us * 2, 1000);
+      }
+
+      int res = ring.try_push(message.data(), message.size());
+      if (res != EAGAIN)
+        return res;
+    }
+  }
+
+protected:
+  std::string name_;
+  uint64_t    slots_      = 8192;
+  uint64_t    slot_bytes_ = 8192;
+  uint64_t    full_ms_    = 1000;
+
+  std::map<std::string, std::unique_ptr<ShmRing>> rings_;
+  std::vector<std::unique_ptr<ShmReceiver>>       receivers_;
+};
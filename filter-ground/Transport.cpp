@@ -0,0 +1,29 @@
+/*
+ * Transport.cpp
+ *
+ *  Created on: 2025. 3. 21.
+ *      Author: tys
+ */
+
+#include "Transport.h"
+#include "LoopbackTransport.h"
+#include "ShmTransport.h"
+
+std::unique_ptr<Transport>
+make_transport(const std::vector<std::string> &urls)
+{
+  if (urls.empty() == false && urls.front().compare(0, strlen(LoopbackBus::scheme()), LoopbackBus::scheme()) == 0)
+    return std::unique_ptr<Transport>(new LoopbackTransport());
+
+  if (urls.empty() == false && urls.front().compare(0, strlen(ShmTransport::scheme()), ShmTransport::scheme()) == 0)
+    return std::unique_ptr<Transport>(new ShmTransport());
+
+  return std::unique_ptr<Transport>(new NatsTransport());
+}
+
+bool
+is_local_url(const std::string &url)
+{
+  return url.compare(0, strlen(LoopbackBus::scheme()), LoopbackBus::scheme()) == 0
+      || url.compare(0, strlen(ShmTransport::scheme()), ShmTransport::scheme()) == 0;
+}
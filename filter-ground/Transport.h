@@ -0,0 +1,150 @@
+/*
+ * Transport.h
+ *
+ *  Created on: 2025. 3. 21.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <sfs_nats_cli.h>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @file Transport.h
+ * @brief NatsRecvers, NatsPublisher가 사용하는 메세지 전송 인터페이스
+ * @details
+ * 서버 URL의 scheme으로 구현을 고릅니다. @see make_transport
+ *
+ *  nats://...      : NatsTransport (SfsNatsClient). scheme이 없어도 NATS
+ *  loopback://이름 : LoopbackTransport. 같은 프로세스에서 이름이 같은 버스끼리 전달 (LoopbackTransport.h)
+ *  shm://이름      : ShmTransport. 같은 호스트의 프로세스끼리 공유메모리 링으로 전달 (ShmTransport.h)
+ *
+ * 설정만 바꾸면(ex. nats.next.urls = ["loopback://chain"], 다음 필터의 nats.recv.urls도 같게)
+ * NATS 서버 없이 필터 체인을 한 프로세스에서 실행할 수 있습니다.(벤치마크, 부하 테스트)
+ *
+ * 구현시 주의사항
+ *  - 모든 함수는 실패시 TransportException을 던집니다.
+ *  - publish는 발행자 쓰레드 하나에서만 호출합니다.(NatsPublisher 쓰레드)
+ *  - subscribe 콜백은 여러 쓰레드에서 동시에 호출될 수 있습니다.
+ */
+
+/// 전송 오류
+class TransportException : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+class Transport
+{
+public:
+  using on_message_t  = std::function<void(const std::string &message)>;
+  using on_messages_t = std::function<void(std::vector<std::string> &messages)>;  ///< 문자열은 이동해 가도 됨(크기는 바꾸지 않음)
+
+  virtual ~Transport() {}
+
+  /// 서버 연결. urls는 같은 scheme이어야 합니다.
+  virtual void connect  (const std::vector<std::string> &urls) = 0;
+
+  virtual void publish  (const std::string &subject, const std::string &message) = 0;
+
+  /// 지금까지 publish한 메세지가 상대에게 전달되었는지 확인 (NATS는 PING/PONG)
+  virtual void flush    () = 0;
+
+  /// 구독. group이 같은 구독자 중 하나만 받습니다.(queue group) group이 비어있으면 모두 받습니다.
+  virtual void subscribe(const std::string &subject, const std::string &group, on_message_t callback) = 0;
+
+  /**
+   * @brief 한번에 받은 메세지를 모아서 전달하는 구독 (NatsRecvers의 수신 배치)
+   * @param max 콜백 한번에 전달할 최대 건수
+   * @details 기본 구현은 subscribe 콜백마다 한건씩 전달하며 모으지 않습니다.(NATS, loopback은 메세지마다 콜백)
+   * SfsNatsClient는 구독에 쌓인 건수를 알려주지 않으므로, 모으려면 다음 메세지가 올때까지 앞의 메세지를 붙잡아야 합니다.
+   * 한번 깨어나서 여러건을 꺼낼 수 있는 전송(ShmTransport)만 재정의합니다.
+   */
+  virtual void subscribe_bulk(const std::string &subject, const std::string &group, const size_t &max, on_messages_t callback)
+  {
+    (void)max;
+    subscribe(subject, group, [callback](const std::string &message)
+    {
+      // 콜백은 쓰레드마다 순서대로 호출되므로 쓰레드별 버퍼를 재사용한다.
+      static thread_local std::vector<std::string> messages;
+      messages.resize(1);
+      messages[0] = message;
+      callback(messages);
+    });
+  }
+
+  /// 구독 해제. 리턴 후에는 콜백이 호출되지 않습니다.
+  virtual void drain    () = 0;
+
+  /**
+   * @brief 콜백이 publish한 쓰레드에서 바로 호출되는지 여부
+   * @details true이면 NatsRecvers는 콜백 쓰레드 CPU 고정을 하지 않고(발행자 쓰레드가 고정되므로)
+   * 워커큐를 다중 생산자로 사용합니다.(발행자 쓰레드 여러개가 동시에 콜백하므로)
+   */
+  virtual bool sync_delivery() const { return false; }
+};
+
+/**
+ * @class NatsTransport
+ * @brief SfsNatsClient를 사용하는 Transport. SfsNatsException은 TransportException으로 바꿔 던집니다.
+ */
+class NatsTransport : public Transport
+{
+public:
+  using NatsClient = SfsNatsClient<std::string>;
+
+  void connect(const std::vector<std::string> &urls) override
+  {
+    try { client_.connectServers(urls, nats_error_callback); }
+    catch (const SfsNatsException &e) { throw TransportException(e.what()); }
+  }
+
+  void publish(const std::string &subject, const std::string &message) override
+  {
+    try { client_.publish(subject, message); }
+    catch (const SfsNatsException &e) { throw TransportException(e.what()); }
+  }
+
+  void flush() override
+  {
+    try { client_.flush(); }
+    catch (const SfsNatsException &e) { throw TransportException(e.what()); }
+  }
+
+  void subscribe(const std::string &subject, const std::string &group, on_message_t callback) override
+  {
+    try { client_.subscribeGroup(subject, group, std::move(callback)); }
+    catch (const SfsNatsException &e) { throw TransportException(e.what()); }
+  }
+
+  void drain() override
+  {
+    try { client_.drain(); }
+    catch (const SfsNatsException &e) { throw TransportException(e.what()); }
+  }
+
+protected:
+  static void
+  nats_error_callback(natsConnection *nc, natsSubscription *sub, natsStatus err, void *closure)
+  {
+    (void)nc; (void)sub; (void)err; (void)closure;
+  }
+
+protected:
+  NatsClient client_;
+};
+
+/**
+ * @brief urls의 scheme에 맞는 Transport 생성 (연결은 하지 않음)
+ * @details 첫번째 URL로 판단합니다. 모르는 scheme(nats, tls 등)은 NatsTransport
+ */
+std::unique_ptr<Transport> make_transport(const std::vector<std::string> &urls);
+
+/// 같은 호스트 안에서만 전달하는 URL인지 (loopback://, shm://)
+bool is_local_url(const std::string &url);
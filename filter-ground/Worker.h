@@ -12,6 +12,9 @@
 #include <extra/LockFreeQueueThread.h>
 #include <extra/SysDateTimeDiff.h>
 #include <extra/helper.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
 
 /**
  * @class Worker
@@ -23,29 +26,74 @@
  * 큐잉된 작업을 순차적으로 처리하며, 재시도 메커니즘을 지원합니다.
  * 푸시되는 데이터 형식과 큐에 전송될 데이터 형식을 다르게 할 수 있습니다.
  * 사용자는 virtual int push(const POOL_PUSH_TYPE &message) 를 작성해 주어야 합니다.
+ * 큐는 BoundedRing(기본 MPSC) 백엔드를 사용합니다. 생산자가 하나이면 single_producer(true)로 SPSC로 동작합니다.
+ *
+ * 작업 훔치기(work stealing)
+ *  add_steal_peer로 다른 워커를 등록하면 run에서 pop_or_steal 사용시 자신의 큐가 비었을때 등록된 워커의 큐에서 꺼내옵니다.
+ *  처리가 오래 걸리는 항목(느린 DB 조회 등) 뒤에 쌓인 작업을 쉬고있는 워커가 가져가므로 지연시간 꼬리가 줄어듭니다.
+ *  이때 큐는 MPMC로 동작하며 자신의 큐에서 꺼낼때도 CAS 한번이 추가됩니다.(락 없음)
+ *  WorkerPool::work_stealing(true)로 풀의 모든 워커를 서로 등록합니다.
+ *  자신의 큐는 bulk로 꺼내며, 한가한 워커는 대기방식대로 대기하다가 steal 주기마다 깨어나 peer를 확인합니다.
+ *  (주기는 steal_interval_ms부터 훔칠 것이 없을때마다 두배로 steal_interval_max_ms까지 늘어남)
  */
 template<typename WOKER_RECV_TYPE, typename POOL_PUSH_TYPE = std::pair<std::string, std::string>>
-class Worker : public LockFreeQueueThread<false, queueable_t<WOKER_RECV_TYPE>, boost::lockfree::fixed_sized<true>>
+class Worker : public LockFreeQueueThread<false, queueable_t<WOKER_RECV_TYPE>, queue_backend::bounded_ring>
 {
 public:
-  using Base = LockFreeQueueThread<false, queueable_t<WOKER_RECV_TYPE>, boost::lockfree::fixed_sized<true>>;
+  using Base = LockFreeQueueThread<false, queueable_t<WOKER_RECV_TYPE>, queue_backend::bounded_ring>;
   using Base::waiter_;  // 부모 클래스의 waiter_를 사용하겠다고 명시적으로 선언
 
+  /// 큐에 쌓인 항목 외에 생산자/소비자가 들고 있을 수 있는 항목 수 여유분
+  static constexpr size_t pool_headroom = 256;
+
   /**
    * @brief 생성자
    * @param queue_size 작업 큐의 크기 (기본값: 10000)
-   * @details 지정된 크기의 락프리 큐를 가진 워커를 생성합니다.
+   * @details
+   * 지정된 크기의 락프리 큐를 가진 워커를 생성합니다.
+   * BoundedRing은 크기를 2의 거듭제곱으로 올림하므로 풀은 실제 큐 크기(capacity)로 잡습니다.
    */
   Worker(const size_t &queue_size = 10000)
-  : LockFreeQueueThread<false, queueable_t<WOKER_RECV_TYPE>, boost::lockfree::fixed_sized<true>>(queue_size) {}
+  : LockFreeQueueThread<false, queueable_t<WOKER_RECV_TYPE>, queue_backend::bounded_ring>(queue_size),
+    pool_(waiter_.capacity() + pool_headroom) {}
   virtual ~Worker() {}
 
   /// POOL_PUSH_TYPE형태를 가공해서 WOKER_RECV_TYPE으로 변환하여 처리할 책임이 있다.
   /// 내부 try_push를 호출해야 한다.
   virtual int push(const POOL_PUSH_TYPE &message) = 0;
 
+  /// push(const POOL_PUSH_TYPE &)의 이동 버전. 기본 구현은 복사 버전을 호출합니다.
+  /// 재정의시 EAGAIN을 리턴하는 경우에는 message를 이동하지 않은 상태로 남겨두어야 합니다.(호출자 재시도용)
+  virtual int push(POOL_PUSH_TYPE &&message) { return push(static_cast<const POOL_PUSH_TYPE &>(message)); }
+
+  /// 큐가 꽉 차서 풀이 대기시간(WorkerPool::push_bulk의 full_wait_ms) 안에 넣지 못했거나 stop으로 넣지 못한 메세지.
+  /// 기본 구현은 버립니다.
+  /// 수신 쓰레드에서 호출되므로 폐기 결과 발행 등 오래 걸리는 처리는 다른 쓰레드로 넘겨야 합니다.
+  virtual void overflow(POOL_PUSH_TYPE &&message) { (void)message; }
+
   void assigned_no(const size_t &no) { assigned_no_ = no; }
 
+  /// 생산자 쓰레드가 하나뿐인 경우 true. 반드시 생산자가 push하기 전에 설정해야 합니다.
+  void single_producer(const bool &single) { waiter_.single_producer(single); }
+
+  /// 자신의 큐가 비었을때 훔쳐올 워커 등록. 반드시 start 전에 설정해야 합니다.
+  /// 훔쳐가는 쪽 큐도 여러 소비자가 꺼내게 되므로 peer의 큐도 MPMC로 설정됩니다.
+  void add_steal_peer(Worker *peer)
+  {
+    if (peer == nullptr || peer == this)
+      return;
+
+    waiter_.single_consumer(false);
+    peer->waiter_.single_consumer(false);
+    steal_peers_.push_back(peer);
+  }
+
+  /// 다른 워커에서 훔쳐온 항목 수
+  uint64_t stolen() const { return stolen_.load(std::memory_order_relaxed); }
+
+  /// 큐가 꽉 찼을때 자리가 날때까지 최대 timeout_ms 대기. 0 : 자리 있음, ETIMEDOUT, -1 : 큐 닫힘
+  int wait_space(const int64_t &timeout_ms) { return waiter_.wait_space(timeout_ms); }
+
 protected:
   /**
    * @brief 작업 항목을 큐에 추가 (재시도 지원)
@@ -64,29 +112,109 @@ protected:
    */
   virtual int try_push(const WOKER_RECV_TYPE &item, const size_t &max_retries)
   {
-    queueable_t<WOKER_RECV_TYPE> queue_item(item);
+    queueable_t<WOKER_RECV_TYPE> queue_item(pool_, item);
+
+    int res = push_queueable(queue_item, max_retries);
+    if (res != 0) queue_item.destroy();
+    return res;
+  }
+
+  /**
+   * @brief 작업 항목을 이동하여 큐에 추가 (재시도 지원)
+   * @details
+   * 리턴값은 try_push(const WOKER_RECV_TYPE &)와 같습니다.
+   * item은 풀의 블럭으로 이동 생성되므로 복사와 힙 할당이 발생하지 않습니다.
+   * 실패(0이 아닌 값)한 경우 item은 원래 값으로 되돌려지므로 호출자가 계속 사용할 수 있습니다.
+   */
+  virtual int try_push(WOKER_RECV_TYPE &&item, const size_t &max_retries)
+  {
+    queueable_t<WOKER_RECV_TYPE> queue_item(pool_, std::move(item));
 
-    // 결과를 처리하고 리턴하는 람다 함수
-    // push 결과가 0이면 destroy하지 않고, 그 외에는 destroy 후 결과값 반환
-    static const auto handle_return = [](int result, queueable_t<WOKER_RECV_TYPE> &queue_item) -> int
+    int res = push_queueable(queue_item, max_retries);
+    if (res != 0)
     {
-      if (result != 0) queue_item.destroy();
-      return result;
-    };
+      item = std::move(*(queue_item.get()));
+      queue_item.destroy();
+    }
+    return res;
+  }
 
+  /// try_push 공통처리. 성공(0)이 아니면 queue_item의 정리는 호출자가 합니다.
+  int push_queueable(queueable_t<WOKER_RECV_TYPE> &queue_item, const size_t &max_retries)
+  {
     if (max_retries == 0)
-      return handle_return(waiter_.push(queue_item), queue_item);
+      return waiter_.push(queue_item);
 
     int res = 0;
     for (size_t index = 0; index < max_retries; ++index)
       if ((res = waiter_.push(queue_item)) <= 0)
-        return handle_return(res, queue_item);
+        return res;
+
+    return EAGAIN;
+  }
+
+  /**
+   * @brief 자신의 큐에서 꺼내고, 비어있으면 다른 워커의 큐에서 훔쳐옵니다.
+   * @param out 꺼낸 항목을 저장할 배열. 최소 max개 크기여야 합니다.
+   * @param max 최대 개수
+   * @return 꺼낸 개수(1 ~ max), -1 : 큐 닫힘(남은 데이터 없음)
+   * @details
+   * 등록된 peer가 없으면 waiter_.pop_bulk(out, max)와 같습니다.
+   * 자신의 큐(대기없이, bulk) -> peer 큐(하나) -> 자신의 큐(steal 주기만큼 대기, bulk) 순서로 확인합니다.
+   * 대기는 워커의 대기방식을 따르므로 park/signal이면 주기 사이에 잠들어 있습니다.
+   * 훔칠 것이 없을때마다 주기를 두배로(최대 steal_interval_max_ms) 늘리고, 꺼내면 steal_interval_ms로 되돌립니다.
+   * bulk로 꺼낸 항목은 다른 워커가 훔칠 수 없으므로 느린 항목 뒤의 최대 max-1개는 그 워커가 처리합니다.
+   */
+  int pop_or_steal(queueable_t<WOKER_RECV_TYPE> *out, const size_t &max)
+  {
+    if (steal_peers_.empty() == true)
+      return waiter_.pop_bulk(out, max);
 
-    return handle_return(EAGAIN, queue_item);
+    while (true)
+    {
+      int count = waiter_.pop_bulk_until(out, max, std::chrono::steady_clock::now());
+      if (count == 0 && steal(out[0]) == true)
+        count = 1;
+      if (count == 0)
+        count = waiter_.pop_bulk(out, max, steal_wait_ms_);
+
+      if (count != 0)
+      {
+        steal_wait_ms_ = steal_interval_ms;
+        return count;
+      }
+
+      steal_wait_ms_ = std::min<int64_t>(steal_wait_ms_ * 2, steal_interval_max_ms);
+    }
+  }
+
+  /// peer 큐에서 하나를 꺼냅니다. 마지막으로 훔쳐온 peer부터 확인합니다.
+  bool steal(queueable_t<WOKER_RECV_TYPE> &item)
+  {
+    const size_t count = steal_peers_.size();
+    for (size_t index = 0; index < count; ++index)
+    {
+      const size_t at   = (steal_next_ + index) % count;
+      Worker      *peer = steal_peers_[at];
+      if (peer->waiter_.size() <= 0 || peer->waiter_.try_pop(item) != 0)
+        continue;
+
+      steal_next_ = at;
+      stolen_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
   }
 
   std::string assigned_no_str() const { return to_stringf(assigned_no_, "%02d"); }
 
+  /// 큐와 함께 큐 항목 풀도 소비자(워커 쓰레드)의 node로 옮깁니다.
+  void on_node_bound(const int &node) override
+  {
+    Base::on_node_bound(node);
+    pool_.move_to_node(node);
+  }
+
 protected:
   /**
    * @brief 워커의 메인 실행 함수
@@ -96,6 +224,20 @@ protected:
    */
   virtual void run() override = 0;
   size_t assigned_no_ = 0;
+  queueable_pool_t<WOKER_RECV_TYPE> pool_;  ///< 큐 항목(shared_ptr) 생성용 slab 풀
+
+  /// 자신의 큐가 비었을때 peer 큐를 확인하는 주기(ms). 계속 한가하면 steal_interval_max_ms까지 늘어남
+  static constexpr int64_t steal_interval_ms     = 1;
+  static constexpr int64_t steal_interval_max_ms = 64;
+
+  std::vector<Worker *>  steal_peers_;      ///< 훔쳐올 워커들. start 이후 변경하지 않음
+  size_t                 steal_next_ = 0;   ///< 다음에 먼저 확인할 peer (run 쓰레드 전용)
+  int64_t                steal_wait_ms_ = steal_interval_ms;  ///< 현재 확인 주기 (run 쓰레드 전용)
+  std::atomic<uint64_t>  stolen_{0};
 };
 
+template<typename WOKER_RECV_TYPE, typename POOL_PUSH_TYPE>
+constexpr int64_t Worker<WOKER_RECV_TYPE, POOL_PUSH_TYPE>::steal_interval_ms;
 
+template<typename WOKER_RECV_TYPE, typename POOL_PUSH_TYPE>
+constexpr int64_t Worker<WOKER_RECV_TYPE, POOL_PUSH_TYPE>::steal_interval_max_ms;
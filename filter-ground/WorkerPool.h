@@ -7,7 +7,15 @@
 
 #pragma once
 
+#include <WorkerSelector.h>
+#include <extra/WaitStrategy.h>
 #include <extra/SysDateTime.h>
+#include <extra/ThreadUniqueIndexer.h>
+#include <extra/MThread.h>
+#include <extra/MSignal.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <string>
 #include <deque>
 
@@ -23,14 +31,46 @@
  * @class WorkerPool
  * @brief 워커들을 관리하고 작업을 분배하는 풀 클래스
  * @tparam WORKER 작업을 처리할 워커 클래스 타입
+ * @tparam SELECTOR 워커 선택 정책 (기본값: least_loaded_selector) @see WorkerSelector.h
  * @details
  * 여러 워커 인스턴스를 관리하고 입력된 작업을 워커들에게 분배합니다.
- * Least Loaded 방식을 사용하여 부하가 가장 적은 워커에게 작업을 할당합니다.
+ * 기본은 Least Loaded 방식으로 부하가 가장 적은 워커에게 작업을 할당합니다.
+ * 워커가 많으면 push마다 모든 워커의 큐 크기를 읽으므로 power_of_two_selector 등을 사용합니다.
+ *
+ * autoscale
+ *  set_autoscale로 최대 워커 수만큼 미리 만들어두고 [0, active) 워커에게만 분배합니다.
+ *  autoscale 쓰레드가 주기마다 큐 깊이/대기시간을 보고 워커를 하나씩 시작하거나,
+ *  계속 한가하면 마지막 워커를 분배대상에서 빼고 남은 작업을 처리한 후 종료합니다.
+ *  workers_ 컨테이너는 start 이후 바뀌지 않으므로 push와 동시에 안전합니다.
+ *
+ * example)
+ *  WorkerPool<MyWorker, std::pair<std::string, std::string>, power_of_two_selector> pool;
  */
-template<typename WORKER, typename POOL_PUSH_TYPE = std::pair<std::string, std::string>>
+template<typename WORKER,
+         typename POOL_PUSH_TYPE = std::pair<std::string, std::string>,
+         typename SELECTOR = least_loaded_selector>
 class WorkerPool
 {
 public:
+  /**
+   * @struct autoscale_t
+   * @brief 워커 수 자동조절 설정
+   */
+  struct autoscale_t
+  {
+    size_t    min_workers  = 0;     ///< 최소 워커 수
+    size_t    max_workers  = 0;     ///< 최대 워커 수. min_workers 이하이면 사용하지 않음
+    int64_t   grow_depth   = 1000;  ///< 활성 워커당 평균 큐 깊이가 이 값 이상이면 워커 추가
+    uint64_t  grow_wait_us = 0;     ///< wait_probe 값(us)이 이 값 이상이면 워커 추가. 0이면 사용하지 않음
+    uint32_t  idle_sec     = 60;    ///< 큐가 계속 비어있는 시간이 이 값 이상이면 워커 회수
+    uint32_t  period_ms    = 1000;  ///< 판단 주기
+    std::function<uint64_t()> wait_probe;  ///< 최근 큐 대기시간(us, ex. p99). autoscale 쓰레드에서만 호출
+
+    bool enabled() const { return max_workers > min_workers; }
+  };
+
+  ~WorkerPool() { stop(); }
+
   /**
    * @brief 워커 풀의 워커 수와 각 워커의 큐 크기를 설정
    * @param num 생성할 워커의 수 (기본값: 1)
@@ -45,11 +85,44 @@ public:
     for (size_t index = 0; index < num; ++index)
     {
       workers_.emplace_back(queue_size);
-      workers_.back().assigned_no(index+1);
+      workers_.back().assigned_no(workers_.size());
+    }
+    queue_size_ = queue_size;
+    active_     = workers_.size();
+    return *this;
+  }
+
+  /**
+   * @brief 워커 수 자동조절 설정
+   * @details
+   * set_num_of_workers 직후(single_producer, work_stealing 등 워커 설정 전)에 호출해야 합니다.
+   * max_workers까지 워커를 미리 만들어두며(쓰레드는 시작하지 않음),
+   * 처음 활성 워커 수는 set_num_of_workers의 수를 [min_workers, max_workers]로 맞춘 값입니다.
+   */
+  WorkerPool &set_autoscale(const autoscale_t &autoscale)
+  {
+    autoscale_ = autoscale;
+    if (autoscale_.enabled() == false)
+      return *this;
+
+    size_t active = workers_.size();
+    if (active < autoscale_.min_workers) active = autoscale_.min_workers;
+    if (active > autoscale_.max_workers) active = autoscale_.max_workers;
+    if (active == 0)                     active = 1;
+
+    while (workers_.size() < autoscale_.max_workers)
+    {
+      workers_.emplace_back(queue_size_);
+      workers_.back().assigned_no(workers_.size());
     }
+
+    active_ = active;
     return *this;
   }
 
+  /// 현재 작업을 분배받는 워커 수
+  size_t active_workers() const { return active_.load(); }
+
   /**
    * @brief 작업을 워커 풀에 추가
    * @param message 처리할 메시지
@@ -57,43 +130,387 @@ public:
    * @retval -1 워커가 없는 경우
    * @retval 그 외 선택된 워커의 push 함수 반환값
    * @details
-   * Least Loaded 방식으로 현재 큐의 크기가 가장 작은 워커를 선택하여
-   * 해당 워커에게 작업을 할당합니다.
-   * 주석 처리된 round-robin 방식의 코드도 참고용으로 포함되어 있습니다.
+   * SELECTOR 정책으로 선택한 워커에게 작업을 할당합니다.
    */
   int push(const POOL_PUSH_TYPE &message)
   {
-    // Least Loaded
-    return workers_.empty() ? -1 :
-        std14_min_element(workers_.begin(), workers_.end(),
-                         [](WORKER &a, WORKER &b)
-                         { return a.size() < b.size(); })->push(message);
-    // round robin
-    // return workers_[sequence_++ % workers_.size()].push(message);
+    if (workers_.empty())
+      return -1;
+
+    inflight_guard_t guard(*this);
+    return selector_.select(workers_, active_.load(), message).push(message);
+  }
+
+  /**
+   * @brief 작업을 워커 풀에 추가 (이동)
+   * @details push(const POOL_PUSH_TYPE &)와 같으며 message를 워커로 이동합니다.
+   * 리턴값이 EAGAIN인 경우 message는 이동되지 않은 상태이므로 재시도 할 수 있습니다.
+   */
+  int push(POOL_PUSH_TYPE &&message)
+  {
+    if (workers_.empty())
+      return -1;
+
+    inflight_guard_t guard(*this);
+    WORKER &worker = selector_.select(workers_, active_.load(), static_cast<const POOL_PUSH_TYPE &>(message));
+    return worker.push(std::move(message));
+  }
+
+  /**
+   * @brief 여러 작업을 모두 넣을때까지 워커 풀에 이동하여 추가 (수신 배치용)
+   * @param messages 추가할 작업 배열. 추가된 항목은 이동됩니다.
+   * @param count 개수
+   * @param full_wait 고른 워커의 큐가 꽉 찼을때 대기방식 (기본값: backoff)
+   * @param full_wait_ms 호출 한번에서 꽉 찬 큐를 기다리는 최대 시간(ms) (기본값: 100)
+   * @return 추가한 건수(넘긴 항목 포함). count보다 작으면 워커가 없거나 큐가 닫힘(stop)이며, 남은 항목은 이동되지 않습니다.
+   * @details
+   * - 활성 워커 수로 나눈 만큼씩 워커를 골라서 넣으므로 건건이 push할때보다 선택 비용이 적고 분배도 유지됩니다.
+   *   키 기반 정책(selector_per_message, ex. keyed_selector)은 같은 키의 순서를 위해 건마다 고릅니다.
+   * - 고른 워커의 큐가 꽉 차면 full_wait로 한번 대기한 후 남은 항목부터 다시 고릅니다.
+   *   park(signal)는 워커가 꺼낼때까지 futex로 대기하고(최대 1ms), 그 외는 wait_idle과 같습니다.
+   * - 처음 꽉 찬 시점부터 full_wait_ms가 지나면 이후 꽉 찬 워커에 넣을 항목은 기다리지 않고 그 워커의 overflow로 넘깁니다.
+   *   (FilterWorker는 폐기 결과를 보냄) 수신 쓰레드가 멈춰있는 시간은 호출당 최대 full_wait_ms입니다.
+   * - 대기는 inflight 표시 밖에서 하므로 autoscale의 워커 회수를 막지 않습니다.
+   */
+  size_t push_bulk(POOL_PUSH_TYPE *messages, const size_t &count, const wait_strategy_t &full_wait = wait_strategy_t::backoff,
+                   const uint32_t &full_wait_ms = 100)
+  {
+    if (workers_.empty())
+      return 0;
+
+    const bool per_message = selector_per_message<SELECTOR>::value;
+
+    bool     waited = false;  ///< 꽉 찬 적이 있음. deadline이 설정됨
+    std::chrono::steady_clock::time_point deadline;
+
+    uint32_t fails = 0;
+    size_t   done  = 0;
+    while (done < count)
+    {
+      WORKER *full = nullptr;
+      {
+        inflight_guard_t guard(*this);
+
+        const size_t active = active_.load();
+        const size_t chunk  = per_message ? count - done : (count - done + active - 1) / active;
+        WORKER *worker = nullptr;
+
+        for (size_t index = 0; index < chunk && full == nullptr; ++index)
+        {
+          if (worker == nullptr || per_message)
+            worker = &selector_.select(workers_, active, static_cast<const POOL_PUSH_TYPE &>(messages[done]));
+
+          int res = worker->push(std::move(messages[done]));
+          if      (res == 0) ++done;
+          else if (res <  0) return done;
+          else               full = worker;  // EAGAIN. 이후 항목은 넣지 않으므로 같은 키의 순서가 유지됨
+        }
+      }
+
+      if (full == nullptr)
+      {
+        fails = 0;
+        continue;
+      }
+
+      if (waited == false)
+      {
+        waited   = true;
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(full_wait_ms);
+      }
+
+      // 대기시간을 다 쓰면 꽉 찬 워커에 넣을 항목은 넘긴다.(다음 항목은 다시 고르므로 자리가 난 워커에는 들어감)
+      if (std::chrono::steady_clock::now() >= deadline)
+      {
+        full->overflow(std::move(messages[done]));
+        ++done;
+        continue;
+      }
+
+      wait_full(*full, full_wait, fails);
+    }
+    return done;
+  }
+
+  /**
+   * @brief 넣지 못한 작업을 고른 워커의 overflow로 이동 (push_bulk가 stop으로 중간에 멈췄을때)
+   * @return 넘긴 건수. 워커가 없으면 0
+   */
+  size_t overflow(POOL_PUSH_TYPE *messages, const size_t &count)
+  {
+    if (workers_.empty())
+      return 0;
+
+    inflight_guard_t guard(*this);
+    for (size_t index = 0; index < count; ++index)
+      selector_.select(workers_, active_.load(), static_cast<const POOL_PUSH_TYPE &>(messages[index])).overflow(std::move(messages[index]));
+    return count;
+  }
+
+  /// 선택 정책 (sticky_selector::set_overflow 등 설정용). push가 시작되기 전에 설정해야 합니다.
+  SELECTOR &selector() { return selector_; }
+
+  /**
+   * @brief 모든 워커의 생산자 모드 설정
+   * @param single 이 풀에 push하는 쓰레드가 하나뿐이면 true (SPSC), 아니면 false (MPSC)
+   * @details 반드시 push가 시작되기 전에 호출해야 합니다.
+   */
+  void single_producer(const bool &single)
+  {
+    for (auto &worker : workers_)
+      worker.single_producer(single);
+  }
+
+  /**
+   * @brief 워커간 작업 훔치기(work stealing) 설정
+   * @param enable true이면 각 워커가 자신의 큐가 비었을때 다른 워커의 큐에서 꺼내옵니다.
+   * @details
+   * 느린 항목을 처리중인 워커 뒤에 쌓인 작업을 쉬고있는 워커가 가져갑니다.
+   * 워커의 run이 pop_or_steal을 사용해야 합니다.(FilterWorker는 사용함) start 전에 호출해야 합니다.
+   *
+   * 비용 (Worker::pop_or_steal 참고)
+   * - 모든 큐가 MPMC가 되어 자신의 큐에서 꺼낼때도 CAS가 추가됩니다.
+   * - 한가한 워커는 대기방식(park/signal 포함)대로 잠들지만 steal 주기마다 깨어나 peer 큐를 확인합니다.
+   *   주기는 1ms에서 훔칠 것이 없을때마다 두배로 64ms까지 늘어나므로, 오래 한가했던 워커는 새로 생긴 편중을 최대 64ms 늦게 가져갑니다.
+   * - 자신의 큐는 bulk로 꺼내므로 bulk 안에서 느린 항목 뒤에 있는 항목은 훔쳐갈 수 없습니다.
+   */
+  void work_stealing(const bool &enable)
+  {
+    if (enable == false)
+      return;
+
+    for (auto &worker : workers_)
+      for (auto &peer : workers_)
+        worker.add_steal_peer(&peer);
+  }
+
+  /**
+   * @brief 모든 워커의 CPU 고정 설정
+   * @details round-robin인 경우 워커마다 CPU 하나씩 차례로 고정됩니다. 큐는 워커가 고정된 node로 옮겨집니다. start 전에 호출해야 합니다.
+   */
+  void set_affinity(const CpuAffinity &affinity)
+  {
+    for (auto &worker : workers_)
+      worker.set_affinity(affinity);
+  }
+
+  /**
+   * @brief 모든 워커의 대기방식 설정
+   * @details 큐가 비었을때 워커 쓰레드의 대기방식입니다. start 전에 호출해야 합니다.
+   */
+  void set_wait_strategy(const wait_strategy_t &strategy)
+  {
+    for (auto &worker : workers_)
+      worker.set_wait_strategy(strategy);
   }
 
   /**
    * @brief 모든 워커를 시작
-   * @details 풀 내의 모든 워커의 start() 함수를 호출하여 작업 처리를 시작합니다.
+   * @details 활성 워커의 start() 함수를 호출하여 작업 처리를 시작합니다. autoscale이 설정된 경우 조절 쓰레드도 시작합니다.
    */
   void start()
   {
-    for (auto &worker : workers_)
-      worker.start();
+    for (size_t index = 0; index < active_.load(); ++index)
+      workers_[index].start();
+
+    if (autoscale_.enabled() == true)
+      scaler_.start();
   }
 
   /**
    * @brief 모든 워커를 중지
-   * @details 풀 내의 모든 워커의 stop() 함수를 호출하여 작업 처리를 중지합니다.
+   * @details 조절 쓰레드를 먼저 멈춘 후, 풀 내의 모든 워커의 stop() 함수를 호출하여 작업 처리를 중지합니다.
    */
   void stop()
   {
+    scaler_.stop();
     for (auto &worker : workers_)
       worker.stop();
   }
 
 protected:
-  std::deque<WORKER> workers_;  ///< 워커 인스턴스들을 저장하는 컨테이너
-  //size_t sequence_ = 0;       ///< Round-robin 방식 사용 시의 시퀀스 번호 (현재 미사용)
+  static constexpr size_t inflight_shards = 16;  ///< 2의 거듭제곱
+
+  struct inflight_shard_t
+  {
+    std::atomic<uint64_t> enter{0};
+    std::atomic<uint64_t> leave{0};
+    char                  pad[64 - 2 * sizeof(std::atomic<uint64_t>)];  ///< 인접 샤드와 캐시라인 분리
+  };
+
+  /**
+   * @brief autoscale 판단 (조절 쓰레드에서 주기마다 호출)
+   * @details
+   * - 활성 워커당 평균 큐 깊이 >= grow_depth 또는 wait_probe() >= grow_wait_us : 워커 1개 시작
+   * - 전체 큐 깊이가 0인 상태가 idle_sec 지속 : 마지막 워커 1개 회수
+   */
+  void autoscale()
+  {
+    const size_t active = active_.load();
+
+    int64_t depth = 0;
+    for (size_t index = 0; index < active; ++index)
+      depth += workers_[index].size();
+
+    uint64_t wait_us = 0;
+    if (autoscale_.grow_wait_us > 0 && autoscale_.wait_probe)
+      wait_us = autoscale_.wait_probe();
+
+    const auto now  = std::chrono::steady_clock::now();
+    const bool busy = depth >= autoscale_.grow_depth * static_cast<int64_t>(active)
+                   || (autoscale_.grow_wait_us > 0 && wait_us >= autoscale_.grow_wait_us);
+
+    if (depth > 0 || busy == true)
+      idle_since_ = now;
+
+    if (busy == true && active < autoscale_.max_workers)
+    {
+      grow(active);
+      return;
+    }
+
+    if (active > autoscale_.min_workers && active > 1
+    &&  now - idle_since_ >= std::chrono::seconds(autoscale_.idle_sec))
+    {
+      shrink(active);
+      idle_since_ = now;
+    }
+  }
+
+  /// workers_[active] 시작 후 분배대상에 추가
+  void grow(const size_t &active)
+  {
+    workers_[active].start();
+    active_.store(active + 1);
+  }
+
+  /**
+   * @brief 마지막 활성 워커를 분배대상에서 빼고 종료
+   * @details
+   * active_를 줄인 후, 줄이기 전의 active_로 워커를 선택했을 수 있는 push가 모두 끝나기를 기다립니다.
+   * 이후 워커의 stop()은 남은 작업을 처리한 후 쓰레드를 종료합니다.
+   */
+  void shrink(const size_t &active)
+  {
+    active_.store(active - 1);
+    wait_inflight();
+    workers_[active - 1].stop();
+  }
+
+  /// push_bulk에서 고른 워커의 큐가 꽉 찼을때 한번 대기
+  static void wait_full(WORKER &worker, const wait_strategy_t &strategy, uint32_t &fails)
+  {
+    static constexpr uint32_t spin_limit = 100;
+
+    if (strategy != wait_strategy_t::park && strategy != wait_strategy_t::signal)
+      return wait_idle(strategy, fails);
+
+    if (fails < spin_limit)
+    {
+      ++fails;
+      cpu_relax();
+      return;
+    }
+    worker.wait_space(1);
+  }
+
+  /**
+   * @brief 호출 시점에 진행중이던 push가 모두 끝날때까지 대기
+   * @details
+   * 샤드는 쓰레드 번호로 고르므로 한 샤드를 여러 쓰레드가 같이 씁니다.
+   * 호출 이후에 들어온 push가 먼저 끝나도 leave가 오르므로 "leave >= 호출시 enter"로는 판단할 수 없고,
+   * 샤드마다 진행중인 push가 없는 순간(leave를 읽고 이어서 읽은 enter가 같음)을 확인합니다.
+   * leave는 enter보다 먼저 오를 수 없으므로 두 값이 같으면 leave를 읽은 시점에 진행중인 push가 없었습니다.
+   * 샤드를 쓰는 쓰레드는 push 사이마다 빠지므로 수신 쓰레드가 샤드 수보다 적으면 바로 확인됩니다.
+   */
+  void wait_inflight()
+  {
+    for (auto &shard : inflight_)
+    {
+      uint32_t fails = 0;
+      while (true)
+      {
+        const uint64_t left = shard.leave.load(std::memory_order_acquire);
+        if (shard.enter.load() == left)
+          break;
+        wait_idle(wait_strategy_t::backoff, fails);
+      }
+    }
+  }
+
+  /// push 진행중 표시. autoscale을 사용하는 경우에만 쓰레드별(thread_uindex) 샤드 카운터를 증가시킵니다.
+  struct inflight_guard_t
+  {
+    inflight_guard_t(WorkerPool &pool)
+    : shard_(pool.autoscale_.enabled() == true ? &pool.inflight_[thread_uindex & (inflight_shards - 1)] : nullptr)
+    {
+      if (shard_ != nullptr) shard_->enter.fetch_add(1);
+    }
+
+    ~inflight_guard_t()
+    {
+      if (shard_ != nullptr) shard_->leave.fetch_add(1, std::memory_order_release);
+    }
+
+    inflight_shard_t *shard_;
+  };
+
+  /**
+   * @class scaler_t
+   * @brief autoscale 조절 쓰레드
+   */
+  class scaler_t : public MThread
+  {
+  public:
+    explicit scaler_t(WorkerPool &pool) : pool_(pool) {}
+
+    bool start()
+    {
+      running_ = true;
+      return MThread::start();
+    }
+
+    bool stop()
+    {
+      if (running_.exchange(false) == false)
+        return true;
+
+      signal_.notify_one();
+      return MThread::join();
+    }
+
+  protected:
+    void run() override
+    {
+      pool_.idle_since_ = std::chrono::steady_clock::now();
+      while (running_.load() == true)
+      {
+        signal_.wait(pool_.autoscale_.period_ms);
+        if (running_.load() == false)
+          break;
+
+        pool_.autoscale();
+      }
+    }
+
+  protected:
+    WorkerPool        &pool_;
+    std::atomic<bool>  running_{false};
+    MSignal            signal_;
+  };
+
+protected:
+  std::deque<WORKER>  workers_;           ///< 워커 인스턴스들을 저장하는 컨테이너. start 이후 변경하지 않음
+  SELECTOR            selector_;          ///< 워커 선택 정책
+  std::atomic<size_t> active_{0};         ///< 분배대상 워커 수. workers_[0, active_)
+  size_t              queue_size_ = 10000;
+
+  autoscale_t         autoscale_;
+  inflight_shard_t    inflight_[inflight_shards];
+  std::chrono::steady_clock::time_point idle_since_;  ///< 조절 쓰레드 전용
+  scaler_t            scaler_{*this};
 };
 
+
+template<typename WORKER, typename POOL_PUSH_TYPE, typename SELECTOR>
+constexpr size_t WorkerPool<WORKER, POOL_PUSH_TYPE, SELECTOR>::inflight_shards;
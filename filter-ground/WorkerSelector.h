@@ -0,0 +1,206 @@
+/*
+ * WorkerSelector.h
+ *
+ *  Created on: 2025. 3. 14.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <extra/ThreadUniqueIndexer.h>
+#include <extra/helper.h>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @file WorkerSelector.h
+ * @brief WorkerPool의 워커 선택 정책
+ * @details
+ * WorkerPool<WORKER, POOL_PUSH_TYPE, SELECTOR>의 SELECTOR로 사용합니다.
+ * 정책은 다음 함수를 제공해야 합니다.
+ *
+ *   template<typename WORKERS, typename MESSAGE>
+ *   typename WORKERS::value_type &select(WORKERS &workers, const size_t &count, const MESSAGE &message);
+ *
+ * - workers[0, count)만 선택할 수 있습니다.(count는 활성 워커 수, 1 이상. WorkerPool이 확인)
+ * - 여러 생산자 쓰레드가 동시에 호출하므로 thread-safe 해야 합니다.
+ * - message는 키 기반 선택용이며 아래 정책들은 사용하지 않습니다.
+ * - 메세지마다 워커가 정해지는 정책은 static constexpr bool per_message = true; 를 둡니다.
+ *   WorkerPool::push_bulk가 여러건을 한 워커에 넣지 않고 건마다 select 합니다.(selector_per_message)
+ *
+ * | 정책                   | push당 size() 조회 | 공유 쓰기 | 특징                               |
+ * |------------------------|--------------------|-----------|------------------------------------|
+ * | least_loaded_selector  | 워커 수            | 없음      | 가장 정확, 워커가 많으면 느림      |
+ * | power_of_two_selector  | 2                  | 없음      | 워커 수와 무관하게 거의 균등       |
+ * | sticky_selector        | 1 (넘치면 +2)      | 없음      | 생산자별 워커 고정(캐시 지역성)    |
+ * | round_robin_selector   | 0                  | 없음      | 부하를 보지 않음, 가장 빠름        |
+ * | keyed_selector<KEY>    | 1 (꽉차면 +spill)  | 없음      | 같은 키는 같은 워커(순서 보장)     |
+ */
+
+/**
+ * @class least_loaded_selector
+ * @brief 큐가 가장 적게 쌓인 워커를 선택 (기본 정책)
+ * @details push마다 모든 워커의 size()를 읽습니다. 워커 수가 적을때 사용합니다.
+ */
+struct least_loaded_selector
+{
+  template<typename WORKERS, typename MESSAGE>
+  typename WORKERS::value_type &select(WORKERS &workers, const size_t &count, const MESSAGE &)
+  {
+    using worker_t = typename WORKERS::value_type;
+    return *std14_min_element(workers.begin(), workers.begin() + count,
+                              [](worker_t &a, worker_t &b)
+                              { return a.size() < b.size(); });
+  }
+};
+
+/**
+ * @class power_of_two_selector
+ * @brief 임의의 워커 2개 중 큐가 적은 워커를 선택 (power of two choices)
+ * @details
+ * - 워커 수와 관계없이 size() 조회는 2번이며, 최대 부하는 least_loaded와 거의 같습니다.
+ * - 난수는 쓰레드별 xorshift 이므로 쓰레드간 공유 상태가 없습니다.
+ */
+struct power_of_two_selector
+{
+  template<typename WORKERS, typename MESSAGE>
+  typename WORKERS::value_type &select(WORKERS &workers, const size_t &count, const MESSAGE &)
+  {
+    return workers[pick(workers, count)];
+  }
+
+  /// workers[0, count) 중 임의의 서로 다른 두 워커 중 큐가 적은 워커의 index
+  template<typename WORKERS>
+  static size_t pick(WORKERS &workers, const size_t &count)
+  {
+    if (count == 1)
+      return 0;
+
+    uint64_t rand = next_rand();
+    size_t   a    = static_cast<size_t>(rand % count);
+    size_t   b    = (a + 1 + static_cast<size_t>((rand >> 32) % (count - 1))) % count;
+    return workers[b].size() < workers[a].size() ? b : a;
+  }
+
+  /// 쓰레드별 xorshift64
+  static uint64_t next_rand()
+  {
+    static thread_local uint64_t state = 0x9E3779B97F4A7C15ULL * static_cast<uint64_t>(thread_uindex + 1);
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+};
+
+/**
+ * @class sticky_selector
+ * @brief 생산자 쓰레드마다 고정된 워커를 선택하고, 큐가 넘치면 power of two로 분산
+ * @details
+ * - 고정 워커는 thread_uindex % 워커 수 입니다. 같은 쓰레드의 메세지는 같은 워커로 가므로
+ *   큐 tail 캐시라인을 다른 생산자와 공유하지 않습니다.
+ * - 고정 워커의 큐가 overflow 이상 쌓이면 power_of_two_selector로 선택합니다.
+ * - 생산자 쓰레드가 워커보다 적으면 일부 워커는 넘칠때만 사용됩니다.
+ */
+struct sticky_selector
+{
+  template<typename WORKERS, typename MESSAGE>
+  typename WORKERS::value_type &select(WORKERS &workers, const size_t &count, const MESSAGE &)
+  {
+    auto &home = workers[static_cast<size_t>(thread_uindex) % count];
+    if (home.size() < static_cast<int64_t>(overflow_))
+      return home;
+    return workers[power_of_two_selector::pick(workers, count)];
+  }
+
+  /// 고정 워커의 큐가 이 값 이상이면 다른 워커로 분산 (기본값: 64)
+  void set_overflow(const size_t &overflow) { overflow_ = overflow; }
+
+protected:
+  size_t overflow_ = 64;
+};
+
+/**
+ * @class round_robin_selector
+ * @brief 워커를 순서대로 선택
+ * @details
+ * 순번은 쓰레드별(thread_local)이며 thread_uindex에서 시작하므로 공유 카운터 경합이 없습니다.
+ * 큐 상태를 보지 않으므로 처리시간이 고른 경우에만 사용합니다.
+ */
+struct round_robin_selector
+{
+  template<typename WORKERS, typename MESSAGE>
+  typename WORKERS::value_type &select(WORKERS &workers, const size_t &count, const MESSAGE &)
+  {
+    static thread_local size_t sequence = static_cast<size_t>(thread_uindex);
+    return workers[sequence++ % count];
+  }
+};
+
+/// SELECTOR::per_message가 true이면 true
+template<typename SELECTOR, typename = void>
+struct selector_per_message : std::false_type {};
+
+template<typename SELECTOR>
+struct selector_per_message<SELECTOR, typename std::enable_if<SELECTOR::per_message>::type> : std::true_type {};
+
+/// keyed_selector용 키 해시. FNV-1a + 상위비트 혼합(워커 수로 나눈 나머지가 고르게 분포하도록)
+inline uint64_t
+selector_key_hash(const char *data, const size_t &size)
+{
+  uint64_t value = 0xcbf29ce484222325ULL;
+  for (size_t index = 0; index < size; ++index)
+  {
+    value ^= static_cast<unsigned char>(data[index]);
+    value *= 0x100000001b3ULL;
+  }
+  return value ^ (value >> 32);
+}
+
+/**
+ * @class keyed_selector
+ * @brief 메세지에서 추출한 키의 해시로 워커를 선택 (같은 키는 항상 같은 워커)
+ * @tparam KEY 키 추출기. 다음 함수를 제공해야 합니다.
+ *   bool operator()(const MESSAGE &message, uint64_t &hash) const;  // 키가 없으면 false
+ *   해시는 selector_key_hash로 계산합니다.
+ * @details
+ * - 같은 키(ex. 수신번호)의 메세지는 같은 워커가 순서대로 처리하므로
+ *   워커별 캐시를 락없이 사용할 수 있습니다.
+ * - 키의 워커 큐가 꽉 찬 경우에만 다음 워커로 최대 spill개까지 넘깁니다.(bounded spillover)
+ *   넘긴 메세지는 순서/워커 고정이 보장되지 않습니다. spill이 0이면 넘기지 않습니다.(push가 EAGAIN을 리턴)
+ * - 키가 없는 메세지는 power_of_two_selector로 선택합니다.
+ * - WorkerPool::work_stealing과 같이 사용하거나 autoscale로 활성 워커 수가 바뀌면 순서가 보장되지 않습니다.
+ *
+ * example)
+ *  using MyPool = WorkerPool<MyFilterWorker, std::pair<std::string, std::string>, keyed_selector<destination_mdn_key>>;
+ */
+template<typename KEY>
+struct keyed_selector
+{
+  static constexpr bool per_message = true;   ///< push_bulk도 건마다 선택
+
+  template<typename WORKERS, typename MESSAGE>
+  typename WORKERS::value_type &select(WORKERS &workers, const size_t &count, const MESSAGE &message)
+  {
+    uint64_t key = 0;
+    if (key_(message, key) == false)
+      return workers[power_of_two_selector::pick(workers, count)];
+
+    const size_t home  = static_cast<size_t>(key % count);
+    for (size_t index = 0; index <= spill_ && index < count; ++index)
+    {
+      auto &worker = workers[(home + index) % count];
+      if (worker.size() < static_cast<int64_t>(worker.capacity()))
+        return worker;
+    }
+    return workers[home];
+  }
+
+  /// 키의 워커 큐가 꽉 찼을때 넘길 최대 워커 수 (기본값: 1)
+  void set_spill(const size_t &spill) { spill_ = spill; }
+
+protected:
+  KEY    key_;
+  size_t spill_ = 1;
+};
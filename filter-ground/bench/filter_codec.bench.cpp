@@ -0,0 +1,96 @@
+/*
+ * filter_codec.bench.cpp
+ *
+ *  Created on: 2025. 3. 20.
+ *      Author: tys
+ */
+
+/**
+ * filter_info_t 1건당 인코딩/디코딩 비용: JSON(rapidjson) vs 바이너리(extra/BinaryCodec.h)
+ *
+ * 측정 대상
+ *  - json encode / decode   : to_json / from_filter_info_json (현재 필터간 전송)
+ *  - binary encode / decode : to_binary / from_filter_info_binary (nats.next.format = "binary")
+ *  - view mdn json / binary : filter_info_view로 수신번호만 읽는 경우 (pre_filter, keyed_selector)
+ *
+ * FIELD_REFLECT로 등록되지 않은 섹션(ex. messageInfo)은 바이너리 안에 JSON으로 들어가므로
+ * 해당 섹션은 JSON과 같은 비용입니다. 섹션을 등록하면 바이너리 비용으로 바뀝니다.
+ *
+ * 빌드 (filter-ground 디렉토리에서)
+ *  g++ -O2 -std=c++11 -I./ -I./thirdparty bench/filter_codec.bench.cpp -o filter_codec.bench -pthread
+ */
+
+#include <filter_info_view.h>
+#include "sample_filter_json.h"
+
+#include <chrono>
+#include <iostream>
+
+template<typename F> void
+measure(const char *name, const size_t &count, F func)
+{
+  func(); // warm up
+
+  size_t sink = 0;
+  auto sta = std::chrono::steady_clock::now();
+  for (size_t index = 0; index < count; ++index)
+    sink += func();
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - sta).count();
+
+  std::cout << name << " ns/msg: " << elapsed / static_cast<int64_t>(count)
+            << (sink == 0 ? " (failed)" : "") << std::endl;
+}
+
+int main()
+{
+  const size_t count  = 100000;
+  auto         parsed = from_filter_info_json(make_sample_json());
+  if (parsed == false)
+  {
+    std::cout << "parse error: " << parsed.error() << std::endl;
+    return 1;
+  }
+
+  const filter_info_t &filter = parsed.value();
+  const std::string    json   = to_json(filter);
+  const std::string    binary = to_binary(filter);
+
+  auto back = from_filter_info_binary(binary);
+  std::cout << "json bytes: " << json.size() << " binary bytes: " << binary.size()
+            << " roundtrip: " << (back == true && to_json(back.value()) == json ? "true" : "false") << std::endl;
+
+  measure("json encode   ", count, [&]() { return to_json(filter).size(); });
+  measure("binary encode ", count, [&]() { return to_binary(filter).size(); });
+
+  measure("json decode   ", count, [&]()
+  {
+    auto value = from_filter_info_json(json);
+    return value == false ? 0 : value.value().resultInfo.filteringTime.size();
+  });
+
+  measure("binary decode ", count, [&]()
+  {
+    auto value = from_filter_info_binary(binary);
+    return value == false ? 0 : value.value().resultInfo.filteringTime.size();
+  });
+
+  measure("view mdn json ", count, [&]()
+  {
+    json_str_ref mdn;
+    return filter_info_view::peek(json, "messageInfo", "destinationMdn", mdn) ? mdn.size() : 0;
+  });
+
+  measure("view mdn bin  ", count, [&]()
+  {
+    json_str_ref mdn;
+    return filter_info_view::peek(binary, "messageInfo", "destinationMdn", mdn) ? mdn.size() : 0;
+  });
+
+  measure("view start bin", count, [&]()
+  {
+    filter_info_view view(binary);
+    return view.filter_start_time() > 0 ? 1 : 0;
+  });
+
+  return 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * filter_json.bench.cpp
+ *
+ *  Created on: 2025. 3. 19.
+ *      Author: tys
+ */
+
+/**
+ * filter_info_t -> JSON 1건당 출력 비용: DOM(add_member) vs SAX(write_value)
+ *
+ * 측정 대상
+ *  - dom x2    : 이전 to_json. Document에 이름/값을 복사한 후 새 StringBuffer로 출력. 로그와 발행에 2번 호출
+ *  - dom       : 위를 1번만
+ *  - sax       : 현재 to_json. 쓰레드별 버퍼/Writer 재사용, 로그와 발행이 결과를 같이 사용
+ *
+ * 빌드 (filter-ground 디렉토리에서)
+ *  g++ -O2 -std=c++11 -I./ -I./thirdparty bench/filter_json.bench.cpp -o filter_json.bench -pthread
+ */
+
+#include <filter_info.h>
+#include "sample_filter_json.h"
+
+#include <chrono>
+#include <iostream>
+
+/// 이전 to_json(filter_info_t)
+static std::string
+to_json_dom(const filter_info_t &info)
+{
+  rapidjson::Document doc(rapidjson::kObjectType);
+  rapidjson::Document::AllocatorType &al = doc.GetAllocator();
+
+  add_member(doc, "messageInfo",  info.messageInfo,  al);
+  add_member(doc, "customerInfo", info.customerInfo, al);
+  add_member(doc, "resultInfo",   info.resultInfo,   al);
+
+  return to_json(doc);
+}
+
+template<typename F> void
+measure(const char *name, const size_t &count, F func)
+{
+  func(); // warm up
+
+  size_t sink = 0;
+  auto sta = std::chrono::steady_clock::now();
+  for (size_t index = 0; index < count; ++index)
+    sink += func();
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - sta).count();
+
+  std::cout << name << " ns/msg: " << elapsed / static_cast<int64_t>(count) << " bytes: " << sink / count << std::endl;
+}
+
+int main()
+{
+  const size_t count  = 100000;
+  auto         parsed = from_filter_info_json(make_sample_json());
+  if (parsed == false)
+  {
+    std::cout << "parse error: " << parsed.error() << std::endl;
+    return 1;
+  }
+
+  const filter_info_t &filter = parsed.value();
+
+  std::cout << "dom == sax: " << (to_json_dom(filter) == to_json(filter) ? "true" : "false") << std::endl;
+
+  measure("dom x2", count, [&]() { return to_json_dom(filter).size() + to_json_dom(filter).size(); });
+  measure("dom   ", count, [&]() { return to_json_dom(filter).size(); });
+  measure("sax   ", count, [&]() { return to_json(filter).size(); });
+  return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * filter_view.bench.cpp
+ *
+ *  Created on: 2025. 3. 18.
+ *      Author: tys
+ */
+
+/**
+ * 필터 JSON 1건당 파싱 비용: 전체 파싱(from_filter_info_json) vs 지연 파싱(filter_info_view)
+ *
+ * 측정 대상
+ *  - full parse      : rapidjson::Document + filter_info_t로 전체 복사 (이전 FilterWorker::push)
+ *  - view mdn        : messageInfo.destinationMdn까지만 SAX로 읽고 멈춤 (트랩 번호 판단, AuthFilterWorker::pre_filter)
+ *  - view mdn+start  : + resultInfo.filterStartTime (FilterWorker::handle_discard(view) 후 트랩 번호 판단)
+ *  - view + mutate   : mdn을 읽은 후 전체 파싱 (트랩 번호가 아닌 AuthFilterWorker 메세지). full parse와의 차이가 mdn 확인 비용
+ *
+ * 빌드 (filter-ground 디렉토리에서)
+ *  g++ -O2 -std=c++11 -I./ -I./thirdparty bench/filter_view.bench.cpp -o filter_view.bench -pthread
+ */
+
+#include <filter_info_view.h>
+#include "sample_filter_json.h"
+
+#include <chrono>
+#include <iostream>
+
+template<typename F> void
+measure(const char *name, const size_t &count, F func)
+{
+  func(); // warm up
+
+  size_t sink = 0;
+  auto sta = std::chrono::steady_clock::now();
+  for (size_t index = 0; index < count; ++index)
+    sink += func();
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - sta).count();
+
+  std::cout << name << " ns/msg: " << elapsed / static_cast<int64_t>(count)
+            << (sink == 0 ? " (parse failed)" : "") << std::endl;
+}
+
+int main()
+{
+  const size_t      count   = 100000;
+  const std::string message = make_sample_json();
+
+  std::cout << "sample json bytes: " << message.size() << std::endl;
+
+  measure("full parse     ", count, [&]()
+  {
+    auto filter = from_filter_info_json(message);
+    return filter == false ? 0 : filter.value().messageInfo.destinationMdn.size();
+  });
+
+  // 뷰 생성시 원문을 복사한다. 실제 경로에서는 이동이므로 "string copy" 만큼 빼고 본다.
+  measure("view mdn       ", count, [&]()
+  {
+    filter_info_view view(message);
+    return view.destination_mdn().size();
+  });
+
+  measure("view mdn+start ", count, [&]()
+  {
+    filter_info_view view(message);
+    return view.filter_start_time() > 0 ? view.destination_mdn().size() : 0;
+  });
+
+  measure("view + mutate  ", count, [&]()
+  {
+    filter_info_view view(message);
+    view.destination_mdn();
+    filter_info_t *filter = view.mutate();
+    return filter == nullptr ? 0 : filter->messageInfo.destinationMdn.size();
+  });
+
+  measure("string copy    ", count, [&]()
+  {
+    filter_info_view view(message);
+    return view.raw().size();
+  });
+
+  return 0;
+}
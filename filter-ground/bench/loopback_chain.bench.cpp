@@ -0,0 +1,142 @@
+/*
+ * loopback_chain.bench.cpp
+ *
+ *  Created on: 2025. 3. 21.
+ *      Author: tys
+ */
+
+/**
+ * NATS 서버 없이 필터 체인(NatsPublisherPool -> 전송 -> NatsRecvers -> WorkerPool) 처리량과 지연시간 측정.
+ *
+ * 측정 대상
+ *  - 전송은 loopback://bench (LoopbackTransport) 입니다. URL만 nats://... 로 바꾸면 같은 코드로 NATS를 측정합니다.
+ *    shm://bench 이면 공유메모리 링(ShmTransport)을 거칩니다.(같은 프로세스지만 프로세스간과 같은 경로)
+ *  - 워커는 메세지에 담긴 발행시각으로 발행 -> 워커 처리까지의 지연시간만 기록합니다.(필터 처리 비용 제외)
+ *  - 생산자 PRODUCERS개가 NatsPublisherPool::publish를 동시에 호출합니다.(FilterWorker의 to_next_nats 역할)
+ *
+ * 출력
+ *  - msg/s     : 워커가 받은 처리량
+ *  - e2e(us)   : publish 호출 -> 워커 꺼냄 p50/p99/max
+ *
+ * 빌드 (filter-ground 디렉토리에서)
+ *  g++ -O2 -std=c++11 -I./ -I./thirdparty bench/loopback_chain.bench.cpp NatsPublisher.cpp Transport.cpp extra/MThread.cpp -o loopback_chain.bench -pthread -lnats -lrt
+ */
+
+#include <NatsPublisherPool.h>
+#include <NatsRecvers.h>
+#include <Worker.h>
+#include <WorkerPool.h>
+#include <extra/LatencyHistogram.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static constexpr size_t PRODUCERS             = 4;
+static constexpr size_t MESSAGES_PER_PRODUCER = 500000;
+static constexpr size_t MESSAGE_SIZE          = 1024;
+
+static std::atomic<uint64_t> received{0};
+static LatencyHistogram      e2e_latency;
+
+/// 메세지 앞 8바이트의 발행시각(steady_clock ns)으로 지연시간만 기록하는 워커
+class EchoWorker : public Worker<std::pair<std::string, std::string>>
+{
+public:
+  EchoWorker(const size_t &queue_size = 10000) : Worker(queue_size) {}
+
+  int push(const std::pair<std::string, std::string> &message) override
+  {
+    return try_push(message, 0);
+  }
+
+  int push(std::pair<std::string, std::string> &&message) override
+  {
+    return try_push(std::move(message), 0);
+  }
+
+protected:
+  void run() override
+  {
+    queueable_t<std::pair<std::string, std::string>> items[bulk_size];
+
+    int count = 0;
+    while ((count = waiter_.pop_bulk(items, bulk_size)) >= 0)
+    {
+      auto now = std::chrono::steady_clock::now();
+      for (int index = 0; index < count; ++index)
+      {
+        auto    item  = items[index].take();
+        int64_t stamp = 0;
+        std::memcpy(&stamp, item->second.data(), sizeof(stamp));
+        e2e_latency.record(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(stamp)), now);
+      }
+      received.fetch_add(count, std::memory_order_relaxed);
+    }
+  }
+};
+
+int main(int argc, char *argv[])
+{
+  const std::string url = argc > 1 ? argv[1] : "loopback://bench";
+
+  NatsRecvers<WorkerPool<EchoWorker>> recver;
+  recver.set_client_num       (1)
+        .set_server_urls      ({url})
+        .set_subject          ("bench.chain")
+        .set_queue_group_name ("bench")
+        .set_worker_num       (4)
+        .set_worker_queue_size(8192);
+
+  NatsPublisherPool sender;
+  sender.set_publisher_num(2)
+        .set_queue_size   (8192)
+        .set_backpressure (backpressure_t::block, 1000)
+        .set_server_urls  ({url})
+        .set_subject      ("bench.chain");
+
+  if (recver.start() == false || sender.start() == false)
+  {
+    std::cout << "start failed: " << url << std::endl;
+    return 1;
+  }
+
+  const uint64_t total = PRODUCERS * MESSAGES_PER_PRODUCER;
+  auto           sta   = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> producers;
+  for (size_t no = 0; no < PRODUCERS; ++no)
+  {
+    producers.emplace_back([&sender]()
+    {
+      std::string message(MESSAGE_SIZE, 'x');
+      for (size_t index = 0; index < MESSAGES_PER_PRODUCER; ++index)
+      {
+        int64_t stamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        std::memcpy(&message[0], &stamp, sizeof(stamp));
+        while (sender.publish(message) != 0)
+          std::this_thread::yield();
+      }
+    });
+  }
+
+  for (auto &producer : producers)
+    producer.join();
+
+  while (received.load() < total && std::chrono::steady_clock::now() - sta < std::chrono::seconds(60))
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sta).count();
+
+  sender.stop();
+  recver.stop();
+
+  std::cout << url << " received: " << received.load() << "/" << total
+            << " msg/s: " << static_cast<uint64_t>(static_cast<double>(received.load()) * 1000000.0 / static_cast<double>(elapsed))
+            << " e2e(" << e2e_latency.snapshot().to_string() << ")" << std::endl;
+
+  return received.load() == total ? 0 : 1;
+}
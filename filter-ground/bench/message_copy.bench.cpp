@@ -0,0 +1,160 @@
+/*
+ * message_copy.bench.cpp
+ *
+ *  Created on: 2025. 3. 6.
+ *      Author: tys
+ */
+
+/**
+ * NATS 콜백 -> FilterWorker::handle_filter 까지 메세지 1건당 복사되는 바이트 측정.
+ *
+ * 이전 경로(복사)
+ *  1. NatsRecvers    : std::make_pair(subject, message)            - 재시도 할때마다 복사
+ *  2. parse_message  : Expected -> Optional<filter_info_t>        - filter_info_t 복사
+ *  3. try_push       : {subject, filter, recv_time} + make_shared  - tuple 복사 2회
+ *  4. run            : auto tuple = *(item.get())                  - tuple 복사
+ *
+ * 현재 경로(이동)
+ *  1. NatsRecvers    : make_pair 1회(콜백이 const 참조이므로 필수) 이후 이동
+ *  2. parse_message  : Expected -> Optional 이동
+ *  3. try_push       : queueable_pool_t 블럭으로 이동 생성(힙 할당 없음)
+ *  4. run            : 풀 블럭의 객체를 참조로 사용
+ *
+ * 측정 방법
+ *  - 전역 operator new를 가로채 할당된 바이트를 합산합니다.
+ *    std::string 복사는 SSO(15바이트 이하)를 제외하면 할당 = 복사 바이트이므로 복사량의 근사치로 사용합니다.
+ *  - JSON 파싱 자체의 할당은 양쪽 경로에 동일하므로 따로 측정하여 뺍니다.
+ *
+ * 빌드 (filter-ground 디렉토리에서)
+ *  g++ -O2 -std=c++11 -I./ -I./thirdparty bench/message_copy.bench.cpp -o message_copy.bench -pthread
+ */
+
+#include <queueable.h>
+#include <filter_info.h>
+#include <extra/SysDateTime.h>
+#include <extra/Optional.h>
+#include "sample_filter_json.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <tuple>
+
+static size_t g_alloc_bytes = 0;
+static size_t g_alloc_count = 0;
+
+void *operator new(size_t size)
+{
+  g_alloc_bytes += size;
+  ++g_alloc_count;
+  void *ptr = std::malloc(size);
+  if (ptr == nullptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+using worker_item_t = std::tuple<std::string, filter_info_t, SysDateTime>;
+
+static Optional<filter_info_t>
+parse_copy(const std::string &message)
+{
+  auto filter = from_filter_info_json(message);
+  if (filter == false) return nullopt;
+  return filter.value();
+}
+
+static Optional<filter_info_t>
+parse_move(const std::string &message)
+{
+  auto filter = from_filter_info_json(message);
+  if (filter == false) return nullopt;
+  return std::move(filter).value();
+}
+
+/// 이전 경로
+static size_t
+copy_path(const std::string &subject, const std::string &message)
+{
+  auto subject_message = std::make_pair(subject, message);
+
+  auto filter = parse_copy(subject_message.second);
+
+  const worker_item_t pushed{subject_message.first, filter.value(), SysDateTime::now()};
+  queueable_t<worker_item_t> queue_item(pushed);
+
+  auto item  = queue_item.take();
+  auto tuple = *(item.get());
+  return std::get<1>(tuple).messageInfo.destinationMdn.size();
+}
+
+/// 현재 경로
+static size_t
+move_path(queueable_pool_t<worker_item_t> &pool, const std::string &subject, const std::string &message)
+{
+  auto subject_message = std::make_pair(subject, message);
+
+  auto filter = parse_move(subject_message.second);
+
+  queueable_t<worker_item_t> queue_item(pool, std::make_tuple(std::move(subject_message.first),
+                                                              std::move(filter.value()),
+                                                              SysDateTime::now()));
+
+  auto item   = queue_item.take();
+  auto &tuple = *(item.get());
+  return std::get<1>(tuple).messageInfo.destinationMdn.size();
+}
+
+/// JSON 파싱만의 할당량 (양쪽 경로 공통)
+static size_t
+parse_only(const std::string &message)
+{
+  auto filter = from_filter_info_json(message);
+  return filter == false ? 0 : filter.value().messageInfo.destinationMdn.size();
+}
+
+template<typename F> void
+measure(const char *name, const size_t &count, const size_t &parse_bytes, F func)
+{
+  func(); // warm up
+
+  g_alloc_bytes = 0;
+  g_alloc_count = 0;
+
+  size_t sink = 0;
+  auto sta = std::chrono::steady_clock::now();
+  for (size_t index = 0; index < count; ++index)
+    sink += func();
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - sta).count();
+
+  std::cout << name
+            << " bytes/msg(alloc): "          << g_alloc_bytes / count
+            << " bytes/msg(excluding parse): " << (g_alloc_bytes / count) - parse_bytes
+            << " allocs/msg: "                << g_alloc_count / count
+            << " ns/msg: "                    << elapsed / static_cast<int64_t>(count)
+            << (sink == 0 ? " (parse failed)" : "") << std::endl;
+}
+
+int main()
+{
+  const size_t      count   = 100000;
+  const std::string subject = "/sfs/auth_filter";
+  const std::string message = make_sample_json();
+
+  std::cout << "sample json bytes: " << message.size() << std::endl;
+
+  parse_only(message);
+  g_alloc_bytes = 0;
+  parse_only(message);
+  const size_t parse_bytes = g_alloc_bytes;
+  std::cout << "parse bytes/msg: " << parse_bytes << std::endl;
+
+  queueable_pool_t<worker_item_t> pool(1024);
+
+  measure("copy path", count, parse_bytes, [&]() { return copy_path(subject, message); });
+  measure("move path", count, parse_bytes, [&]() { return move_path(pool, subject, message); });
+
+  std::cout << "pool misses: " << pool.misses() << std::endl;
+  return 0;
+}
@@ -0,0 +1,268 @@
+/*
+ * publish_ack.bench.cpp
+ *
+ *  Created on: 2025. 3. 25.
+ *      Author: tys
+ */
+
+/**
+ * NATS 서버 없이(loopback://) ack 발행(NatsPublisherPool::set_ack)의 처리량과 실패 처리 확인.
+ *
+ * 측정/확인 대상
+ *  - window  : ack_window별 처리량과 발행큐 적재 -> ack 지연시간(p50/p99/max)
+ *  - retry   : LoopbackBus::inject_failures로 publish를 실패시켜 재시도/유실 건수와 콜백 결과가 통계와 맞는지
+ *              (acked + failed == 발행 건수, 콜백 0/-1 건수 == acked/failed, 모두 끝난 후 in_flight == 0)
+ *  - shutdown: auth-filter/main.cpp와 같은 종료 순서(수신 stop -> 발행 stop -> 수신 파괴)에서
+ *              워커를 참조하는 완료 콜백이 모두 호출되는지. -fsanitize=address로 빌드하면 해제된 워커 접근을 잡습니다.
+ *
+ * 출력
+ *  - 항목별 결과와 통계. 맞지 않으면 FAIL을 출력하고 1을 리턴합니다.
+ *
+ * 빌드 (filter-ground 디렉토리에서)
+ *  g++ -O2 -std=c++11 -I./ -I./thirdparty bench/publish_ack.bench.cpp NatsPublisher.cpp Transport.cpp extra/MThread.cpp -o publish_ack.bench -pthread -lnats -lrt
+ */
+
+#include <NatsPublisherPool.h>
+#include <NatsRecvers.h>
+#include <LoopbackTransport.h>
+#include <Worker.h>
+#include <WorkerPool.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static constexpr size_t MESSAGES = 200000;
+
+/// 발행자 풀 통계 합계
+static publisher_stats_t
+sum_stats(const NatsPublisherPool &pool)
+{
+  publisher_stats_t total;
+  for (auto &stats : pool.publisher_stats())
+  {
+    total.in_flight += stats.in_flight;
+    total.acked     += stats.acked;
+    total.failed    += stats.failed;
+    total.retried   += stats.retried;
+  }
+  return total;
+}
+
+static bool
+check(const char *name, const bool &ok, const std::string &detail)
+{
+  std::cout << (ok ? "  ok   " : "  FAIL ") << name << ": " << detail << std::endl;
+  return ok;
+}
+
+/// window별 처리량. 구독자는 없으므로(loopback은 버림) 발행 + ack 처리 비용만 측정합니다.
+static bool
+bench_window(const size_t &window)
+{
+  publish_ack_t ack;
+  ack.window = window;
+
+  NatsPublisherPool pool;
+  pool.set_publisher_num(2)
+      .set_queue_size   (8192)
+      .set_backpressure (backpressure_t::block, 1000)
+      .set_ack          (ack)
+      .set_server_urls  ({"loopback://ack.window"})
+      .set_subject      ("bench.ack");
+  if (pool.start() == false)
+    return check("window", false, "start failed");
+
+  std::atomic<uint64_t> completed{0};
+  auto sta = std::chrono::steady_clock::now();
+  for (size_t index = 0; index < MESSAGES; ++index)
+    while (pool.publish(std::string(256, 'x'), "", [&completed](const int &) { completed.fetch_add(1); }) != 0)
+      std::this_thread::yield();
+
+  while (completed.load() < MESSAGES && std::chrono::steady_clock::now() - sta < std::chrono::seconds(60))
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sta).count();
+  pool.stop();
+
+  std::cout << "  window=" << window
+            << " msg/s: " << static_cast<uint64_t>(static_cast<double>(completed.load()) * 1000000.0 / static_cast<double>(elapsed))
+            << " ack(" << pool.publish_latency().snapshot().to_string() << ")" << std::endl;
+  return completed.load() == MESSAGES;
+}
+
+/**
+ * 재시도 후 성공(failures <= retries)과 유실(failures > retries)의 통계와 콜백 결과
+ * 시도마다 window의 첫 publish가 실패하므로 failures가 (retries + 1)의 배수이면
+ * failures / (retries + 1)개의 window가 유실되고 재시도는 window마다 retries번입니다.
+ */
+static bool
+check_retry(const size_t &failures, const uint32_t &retries)
+{
+  static constexpr size_t count = 1000;
+
+  publish_ack_t ack;
+  ack.window         = 8;
+  ack.max_retries    = retries;
+  ack.backoff_ms     = 1;
+  ack.max_backoff_ms = 4;
+
+  NatsPublisherPool pool;
+  pool.set_publisher_num(1)   ///< 실패가 한 발행자의 연속된 시도에 걸리도록
+      .set_queue_size   (4096)
+      .set_ack          (ack)
+      .set_server_urls  ({"loopback://ack.retry"})
+      .set_subject      ("bench.ack");
+  if (pool.start() == false)
+    return check("retry", false, "start failed");
+
+  LoopbackBus::get("ack.retry")->inject_failures(failures);
+
+  std::atomic<uint64_t> ok{0}, lost{0};
+  for (size_t index = 0; index < count; ++index)
+    while (pool.publish(std::string("x"), "", [&ok, &lost](const int &status) { (status == 0 ? ok : lost).fetch_add(1); }) != 0)
+      std::this_thread::yield();
+
+  // 종료중에는 재시도하지 않으므로 콜백이 모두 올때까지 기다린 후 멈춘다.(통계는 콜백 전에 반영됨)
+  auto sta = std::chrono::steady_clock::now();
+  while (ok.load() + lost.load() < count && std::chrono::steady_clock::now() - sta < std::chrono::seconds(10))
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  publisher_stats_t stats = sum_stats(pool);  ///< stop 후에는 발행자가 없음
+  pool.stop();
+
+  const uint64_t lost_windows   = failures > retries ? failures / (retries + 1) : 0;
+  const uint64_t expect_retried = failures > retries ? lost_windows * retries : failures;
+
+  std::string detail = "failures=" + std::to_string(failures) + " retries=" + std::to_string(retries)
+                     + " ok=" + std::to_string(ok.load()) + " lost=" + std::to_string(lost.load())
+                     + " acked=" + std::to_string(stats.acked) + " failed=" + std::to_string(stats.failed)
+                     + " retried=" + std::to_string(stats.retried) + " in_flight=" + std::to_string(stats.in_flight);
+  return check("retry", ok.load() + lost.load() == count && ok.load() == stats.acked && lost.load() == stats.failed
+                     && lost.load() >= lost_windows && lost.load() <= lost_windows * ack.window
+                     && stats.retried == expect_retried && stats.in_flight == 0, detail);
+}
+
+static std::atomic<uint64_t> forwarded{0};
+static std::atomic<uint64_t> completed{0};
+static NatsPublisherPool    *next_pool = nullptr;
+
+/// 받은 메세지를 ack 모드로 다음 풀에 발행하며, 완료 콜백에서 자신(this)의 카운터를 올리는 워커 (FilterWorker::completion과 같음)
+class ForwardWorker : public Worker<std::pair<std::string, std::string>>
+{
+public:
+  ForwardWorker(const size_t &queue_size = 10000) : Worker(queue_size) {}
+
+  int push(const std::pair<std::string, std::string> &message) override
+  {
+    return try_push(message, 0);
+  }
+
+  int push(std::pair<std::string, std::string> &&message) override
+  {
+    return try_push(std::move(message), 0);
+  }
+
+protected:
+  void run() override
+  {
+    queueable_t<std::pair<std::string, std::string>> items[bulk_size];
+
+    int count = 0;
+    while ((count = waiter_.pop_bulk(items, bulk_size)) >= 0)
+    {
+      for (int index = 0; index < count; ++index)
+      {
+        auto item = items[index].take();
+        while (next_pool->publish(std::move(item->second), "", [this](const int &) { on_published(); }) == EAGAIN)
+          std::this_thread::yield();
+        forwarded.fetch_add(1);
+      }
+    }
+  }
+
+  void on_published()
+  {
+    ++completed_;
+    completed.fetch_add(1);
+  }
+
+protected:
+  std::atomic<uint64_t> completed_{0};  ///< 발행자 쓰레드들에서 변경 (워커가 해제되었으면 ASan이 잡음)
+};
+
+/// 수신 stop -> 발행 stop -> 수신 파괴 순서에서 완료 콜백이 살아있는 워커로 모두 호출되는지
+static bool
+check_shutdown()
+{
+  publish_ack_t ack;
+  ack.window         = 64;
+  ack.backoff_ms     = 20;
+  ack.max_backoff_ms = 80;
+
+  NatsPublisherPool next;
+  next.set_publisher_num(2)
+      .set_queue_size   (32768)   ///< 수신이 멈출때 발행큐에 항목이 남도록 크게
+      .set_ack          (ack)
+      .set_server_urls  ({"loopback://ack.next"})
+      .set_subject      ("bench.ack.next");
+  next_pool = &next;
+
+  NatsPublisherPool source;
+  source.set_publisher_num(1)
+        .set_queue_size   (8192)
+        .set_backpressure (backpressure_t::block, 1000)
+        .set_server_urls  ({"loopback://ack.in"})
+        .set_subject      ("bench.ack.in");
+
+  {
+    NatsRecvers<WorkerPool<ForwardWorker>> recver;
+    recver.set_client_num       (2)
+          .set_server_urls      ({"loopback://ack.in"})
+          .set_subject          ("bench.ack.in")
+          .set_queue_group_name ("bench")
+          .set_worker_num       (4)
+          .set_worker_queue_size(8192);
+
+    if (next.start() == false || recver.start() == false || source.start() == false)
+      return check("shutdown", false, "start failed");
+
+    for (size_t index = 0; index < MESSAGES / 4; ++index)
+      while (source.publish(std::string(64, 'x')) != 0)
+        std::this_thread::yield();
+    source.stop();
+
+    // 다음 풀이 재시도 backoff로 멈춰있게 하여 수신을 멈출때 발행큐와 window에 워커가 남긴 항목이 있도록 한다.
+    LoopbackBus::get("ack.next")->inject_failures(MESSAGES);
+
+    // auth-filter/main.cpp와 같은 순서. 수신 stop에서 워커는 남은 항목을 발행한 후 멈추지만 파괴되지는 않는다.
+    recver.stop();
+    next.stop();  ///< 남은 항목은 재시도 없이 실패(-1)로 콜백
+    LoopbackBus::get("ack.next")->inject_failures(0);
+  } // 여기서 워커 파괴
+
+  std::string detail = "forwarded=" + std::to_string(forwarded.load()) + " completed=" + std::to_string(completed.load());
+  return check("shutdown", forwarded.load() == MESSAGES / 4 && completed.load() == forwarded.load(), detail);
+}
+
+int main()
+{
+  bool ok = true;
+
+  std::cout << "window" << std::endl;
+  for (size_t window : { 1, 16, 256 })
+    ok = bench_window(window) && ok;
+
+  std::cout << "retry" << std::endl;
+  ok = check_retry(0, 3) && ok;
+  ok = check_retry(2, 3) && ok;
+  ok = check_retry(9, 2) && ok;
+
+  std::cout << "shutdown" << std::endl;
+  ok = check_shutdown() && ok;
+
+  std::cout << (ok ? "ok" : "FAIL") << std::endl;
+  return ok ? 0 : 1;
+}
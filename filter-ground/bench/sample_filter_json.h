@@ -0,0 +1,53 @@
+/*
+ * sample_filter_json.h
+ *
+ *  Created on: 2025. 3. 19.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <string>
+
+/// 약 3KB 크기의 필터 JSON. 필드 구성은 FilterLogger.h의 출력 예제를 따릅니다.
+inline std::string
+make_sample_json()
+{
+  std::string url_arr;
+  for (int index = 0; index < 8; ++index)
+  {
+    if (index > 0) url_arr += ",";
+    url_arr += "\"https://short.example.co.kr/campaign/2025/spring/landing?utm_source=sms&id=" + std::to_string(100000 + index) + "\"";
+  }
+
+  std::string media_arr;
+  for (int index = 0; index < 4; ++index)
+  {
+    if (index > 0) media_arr += ",";
+    media_arr += R"({"contentType":1,"contentSize":204800,)"
+                 R"("contentUrl":"https://mms-storage.example.co.kr/contents/2025/03/06/0000000000)" + std::to_string(index) + R"(.jpg",)"
+                 R"("encryptFlag":1,"decodingKey":"3f2a9c0d7b1e4a6f8c5d2e1b0a9f8e7d6c5b4a3f2e1d0c9b8a7f6e5d4c3b2a1f"})";
+  }
+
+  std::string filtering_time;
+  const char *filters[] = { "auth-filter", "smishing-filter", "sensing-filter", "image-filter", "url-filter" };
+  for (int index = 0; index < 5; ++index)
+  {
+    if (index > 0) filtering_time += ",";
+    filtering_time += std::string(R"({"filterName":")") + filters[index] + R"(","startTime":1738079169978,"endTime":1738079169979})";
+  }
+
+  return
+    R"({"messageInfo":{"interfaceFd":0,"interfaceSystemId":0,"messageType":1,"detailType":0,)"
+    R"("messageKey":"MK20250306123456789012345678901234","mfsgwFd":0,"mfsgwId":0,"mfsgwSessionId":0,"sequenceNumber":0,)"
+    R"("smsServiceId":"SVC0001234","messageId":"MSG-2025-03-06-000000000001","originationMdn":"01012345678",)"
+    R"("destinationMdn":"0100010002","callbackMdn":"15881234","messageOrigination":3,)"
+    R"("mediaContent":[)" + media_arr + R"(],"cnnScore":0.0,"anomalCount":0,"traceType":0,)"
+    R"("url":[)" + url_arr + R"(]},)"
+    R"("customerInfo":{"filterFlag":0,"addFlag":0,"traceFlag":0,"impersonateAgree":0,"fsecAgree":0,"kisaFlag":0,"deepmsgFlag":0},)"
+    R"("resultInfo":{"smppResult":0,"resultCode":0,"reasonCode":0,)"
+    R"("spamPattern1":"pattern matched: [free|bonus|event].{0,20}[click|link]",)"
+    R"("spamPattern2":"url reputation: short.example.co.kr score=87 category=phishing",)"
+    R"("filterStartTime":1738079168978,"filterEndTime":1738079169978,)"
+    R"("filteringTime":[)" + filtering_time + R"(]}})";
+}
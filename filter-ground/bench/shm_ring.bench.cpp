@@ -0,0 +1,312 @@
+/*
+ * shm_ring.bench.cpp
+ *
+ *  Created on: 2025. 3. 26.
+ *      Author: tys
+ */
+
+/**
+ * ShmRing 프로세스간(fork) 전달 처리량과 죽은 프로세스 처리 확인.
+ *
+ * 측정/확인 대상
+ *  - transfer : 생산자 프로세스 PRODUCERS개 -> 소비자(부모) 전달 처리량.
+ *               SPILL_EVERY건마다 slot_bytes보다 큰 메세지(spill)를 섞어 내용과 생산자별 순서, 남은 spill 파일을 확인합니다.
+ *  - stale    : 만든 프로세스가 ftruncate 전/초기화 전에 죽은 공유메모리를 다음 open이 지우고 다시 만드는지
+ *  - producer : 슬롯을 잡은 생산자가 살아있는 동안은 EBUSY 한번, 죽은 후에는 EOWNERDEAD로 버리고 다음 메세지를 받는지
+ *  - consumer : 슬롯을 잡은 소비자가 죽어서 꽉 찬 링을 생산자가 recover_tail로 풀어주는지
+ *
+ * 출력
+ *  - 항목별 결과. 맞지 않으면 FAIL을 출력하고 1을 리턴합니다.
+ *
+ * 빌드 (filter-ground 디렉토리에서)
+ *  g++ -O2 -std=c++11 -I./ bench/shm_ring.bench.cpp -o shm_ring.bench -pthread -lrt
+ */
+
+#include <extra/ShmRing.h>
+
+#include <chrono>
+#include <dirent.h>
+#include <iostream>
+#include <sys/wait.h>
+#include <thread>
+#include <vector>
+
+static constexpr size_t PRODUCERS   = 4;
+static constexpr size_t MESSAGES    = 500000;   ///< 생산자마다
+static constexpr size_t SPILL_EVERY = 1000;
+static constexpr size_t SLOT_BYTES  = 256;
+
+/// 슬롯을 잡기만 하고 풀지 않는 링 (죽은 프로세스 흉내)
+class HoldRing : public ShmRing
+{
+public:
+  bool hold_push() { uint64_t pos = 0; return claim(header_->tail, pos, 0) != nullptr; }
+  bool hold_pop () { uint64_t pos = 0; return claim(header_->head, pos, 1) != nullptr; }
+};
+
+static bool
+check(const char *name, const bool &ok, const std::string &detail)
+{
+  std::cout << (ok ? "  ok   " : "  FAIL ") << name << ": " << detail << std::endl;
+  return ok;
+}
+
+static std::string
+ring_name(const char *what)
+{
+  return "sfs.bench." + std::to_string(getpid()) + "." + what;
+}
+
+/// /dev/shm 에 prefix로 시작하는 파일 수
+static size_t
+leftovers(const std::string &prefix)
+{
+  size_t count = 0;
+  DIR   *dir   = opendir("/dev/shm");
+  if (dir == nullptr)
+    return 0;
+  while (struct dirent *entry = readdir(dir))
+    count += std::string(entry->d_name).compare(0, prefix.size(), prefix) == 0;
+  closedir(dir);
+  return count;
+}
+
+/// fork 후 자식에서 body를 실행하고 종료 코드로 끝냅니다.
+template<typename FUNC>
+static pid_t
+spawn(FUNC body)
+{
+  pid_t pid = fork();
+  if (pid == 0)
+    _exit(body());
+  return pid;
+}
+
+static bool
+reap(const pid_t &pid)
+{
+  int status = 0;
+  return waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/// 생산자번호:순번:채움 형식의 메세지
+static std::string
+make_message(const size_t &producer, const size_t &seq)
+{
+  std::string message = std::to_string(producer) + ":" + std::to_string(seq) + ":";
+  message.resize(seq % SPILL_EVERY == 0 ? SLOT_BYTES * 64 : 64, static_cast<char>('a' + seq % 26));
+  return message;
+}
+
+static bool
+check_transfer()
+{
+  const std::string name = ring_name("transfer");
+  std::string       error;
+  ShmRing           ring;
+  if (ring.open(name, 4096, SLOT_BYTES, error) == false)
+    return check("transfer", false, error);
+
+  std::vector<pid_t> producers;
+  for (size_t producer = 0; producer < PRODUCERS; ++producer)
+  {
+    producers.push_back(spawn([&]()
+    {
+      ShmRing     child;
+      std::string child_error;
+      if (child.open(name, 4096, SLOT_BYTES, child_error) == false)
+        return 1;
+      for (size_t seq = 0; seq < MESSAGES; ++seq)
+      {
+        std::string message = make_message(producer, seq);
+        int res = 0;
+        while ((res = child.try_push(message.data(), message.size())) == EAGAIN)
+          cpu_relax();
+        if (res != 0)
+          return 1;
+      }
+      return 0;
+    }));
+  }
+
+  std::vector<size_t> next(PRODUCERS, 0);
+  size_t              received = 0, bad = 0, spilled = 0;
+  std::string         message;
+  auto sta = std::chrono::steady_clock::now();
+  while (received < PRODUCERS * MESSAGES && std::chrono::steady_clock::now() - sta < std::chrono::seconds(60))
+  {
+    if (ring.pop(message, 100) != 0)
+      continue;
+
+    size_t first    = message.find(':');
+    size_t second   = message.find(':', first + 1);
+    size_t producer = std::stoul(message.substr(0, first));
+    size_t seq      = std::stoul(message.substr(first + 1, second - first - 1));
+    bad     += producer >= PRODUCERS || seq != next[producer] || message != make_message(producer, seq);
+    spilled += message.size() > SLOT_BYTES;
+    if (producer < PRODUCERS)
+      next[producer] = seq + 1;
+    ++received;
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sta).count();
+
+  bool exited = true;
+  for (auto pid : producers)
+    exited = reap(pid) && exited;
+
+  ring.close();
+  ShmRing::unlink(name);
+
+  std::string detail = "received=" + std::to_string(received) + " spilled=" + std::to_string(spilled)
+                     + " bad=" + std::to_string(bad) + " left=" + std::to_string(leftovers(name))
+                     + " msg/s=" + std::to_string(static_cast<uint64_t>(static_cast<double>(received) * 1000000.0 / static_cast<double>(elapsed)));
+  return check("transfer", exited && received == PRODUCERS * MESSAGES && bad == 0
+                           && spilled == PRODUCERS * (MESSAGES / SPILL_EVERY) && leftovers(name) == 0, detail);
+}
+
+static bool
+check_stale()
+{
+  bool ok = true;
+
+  // ftruncate 전에 죽음 (크기 0)
+  {
+    const std::string name = ring_name("stale.unsized");
+    pid_t pid = spawn([&]() { return shm_open(("/" + name).c_str(), O_RDWR | O_CREAT | O_EXCL, 0660) >= 0 ? 0 : 1; });
+    reap(pid);
+
+    ShmRing     ring;
+    std::string error;
+    bool opened = ring.open(name, 16, 64, error) && ring.try_push("x", 1) == 0;
+    ring.close();
+    ShmRing::unlink(name);
+    ok = check("stale", opened, "unsized " + error) && ok;
+  }
+
+  // ftruncate 후 초기화 전에 죽음 (ready, creator 0)
+  {
+    const std::string name = ring_name("stale.uninit");
+    pid_t pid = spawn([&]()
+    {
+      int fd = shm_open(("/" + name).c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+      return fd >= 0 && ftruncate(fd, 1 << 20) == 0 ? 0 : 1;
+    });
+    reap(pid);
+
+    ShmRing     ring;
+    std::string error;
+    bool opened = ring.open(name, 16, 64, error) && ring.try_push("x", 1) == 0 && ring.capacity() == 16;
+    ring.close();
+    ShmRing::unlink(name);
+    ok = check("stale", opened, "uninitialized " + error) && ok;
+  }
+
+  return ok;
+}
+
+static bool
+check_dead_producer()
+{
+  const std::string name = ring_name("producer");
+  std::string       error;
+  ShmRing           ring;
+  if (ring.open(name, 16, 64, error) == false)
+    return check("producer", false, error);
+
+  // 메세지 하나 후 슬롯을 잡고 그 뒤에 하나 더 넣은 후 잠시 살아있다가 죽는다.
+  pid_t pid = spawn([&]()
+  {
+    HoldRing    child;
+    std::string child_error;
+    if (child.open(name, 16, 64, child_error) == false
+        || child.try_push("before", 6) != 0 || child.hold_push() == false || child.try_push("after", 5) != 0)
+      return 1;
+    std::this_thread::sleep_for(std::chrono::milliseconds(ShmRing::stuck_ms * 3 / 2));
+    return 0;
+  });
+
+  // 좀비(wait 전)는 살아있는 것으로 보이므로 바로 거둔다.
+  bool        exited = false;
+  std::thread reaper([&]() { exited = reap(pid); });
+
+  std::vector<std::string> received;
+  size_t      busy = 0, dead = 0;
+  std::string message;
+  auto sta = std::chrono::steady_clock::now();
+  while (received.size() < 2 && std::chrono::steady_clock::now() - sta < std::chrono::seconds(10))
+  {
+    int res = ring.pop(message, 100);
+    if (res == 0)     received.push_back(message);
+    if (res == EBUSY) ++busy;
+    if (res == EOWNERDEAD) ++dead;
+  }
+  reaper.join();
+
+  std::string detail = "received=" + std::to_string(received.size()) + " busy=" + std::to_string(busy)
+                     + " dead=" + std::to_string(dead) + " dropped=" + std::to_string(ring.dropped());
+  bool ok = exited && received.size() == 2 && received[0] == "before" && received[1] == "after"
+         && busy == 1 && dead == 1 && ring.dropped() == 1;
+  ring.close();
+  ShmRing::unlink(name);
+  return check("producer", ok, detail);
+}
+
+static bool
+check_dead_consumer()
+{
+  const std::string name = ring_name("consumer");
+  std::string       error;
+  ShmRing           ring;
+  if (ring.open(name, 4, 64, error) == false)
+    return check("consumer", false, error);
+
+  for (int index = 0; index < 4; ++index)
+    ring.try_push("x", 1);
+
+  // 슬롯 하나를 꺼내다가 죽는다.
+  pid_t pid = spawn([&]()
+  {
+    HoldRing    child;
+    std::string child_error;
+    return child.open(name, 4, 64, child_error) == true && child.hold_pop() == true ? 0 : 1;
+  });
+  bool exited = reap(pid);
+
+  size_t full = 0, dead = 0;
+  auto   sta  = std::chrono::steady_clock::now();
+  while (ring.try_push("y", 1) == EAGAIN && std::chrono::steady_clock::now() - sta < std::chrono::seconds(10))
+  {
+    ++full;
+    dead += ring.recover_tail() == EOWNERDEAD;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  // 남은 3건 + 새로 넣은 1건
+  std::string message;
+  size_t      received = 0;
+  while (ring.try_pop(message) == true)
+    ++received;
+
+  std::string detail = "waits=" + std::to_string(full) + " dead=" + std::to_string(dead)
+                     + " received=" + std::to_string(received) + " dropped=" + std::to_string(ring.dropped());
+  bool ok = exited && dead == 1 && received == 4 && ring.dropped() == 1;
+  ring.close();
+  ShmRing::unlink(name);
+  return check("consumer", ok, detail);
+}
+
+int main()
+{
+  bool ok = true;
+
+  std::cout << "transfer" << std::endl;
+  ok = check_transfer() && ok;
+
+  std::cout << "dead process" << std::endl;
+  ok = check_stale() && ok;
+  ok = check_dead_producer() && ok;
+  ok = check_dead_consumer() && ok;
+
+  std::cout << (ok ? "ok" : "FAIL") << std::endl;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+/*
+ * tps_meter.bench.cpp
+ *
+ *  Created on: 2025. 3. 28.
+ *      Author: tys
+ */
+
+/**
+ * TpsMeter 기록 경로의 쓰레드 수(1 ~ 16)별 비용 측정.
+ *
+ * 측정 대상
+ *  - add             : 현재 쓰레드 샤드의 버킷에 CAS 1회 (기록만)
+ *  - add_transaction : add + 현재 쓰레드 샤드의 건수 (다른 샤드는 읽지 않음)
+ *  - add + get_count : add + 모든 샤드의 현재 버킷 읽기 (이전 add_transaction)
+ *    다른 쓰레드가 계속 쓰는 샤드의 캐시라인을 매번 읽으므로 쓰레드가 늘면 코어간 트래픽으로 느려집니다.
+ *
+ * 출력
+ *  - ns/op : 전체 시간 / 쓰레드당 건수 (코어가 쓰레드 수보다 적으면 그만큼 늘어남)
+ *
+ * 빌드 (filter-ground 디렉토리에서)
+ *  g++ -O2 -std=c++11 -I./ bench/tps_meter.bench.cpp -o tps_meter.bench -pthread
+ */
+
+#include <extra/TpsMeter.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static constexpr size_t OPS_PER_THREAD = 5000000;
+
+/// get_count(tick)를 호출하기 위한 측정용 하위 클래스
+class BenchTpsMeter : public TpsMeter
+{
+public:
+  size_t add_and_count() { return get_count(bucket_tick(add())); }
+};
+
+template<typename F> double
+measure(const size_t &threads, F func)
+{
+  BenchTpsMeter         meter;
+  std::atomic<size_t>   ready{0};
+  std::atomic<bool>     go{false};
+  std::atomic<size_t>   sink{0};
+  std::vector<std::thread> workers;
+
+  for (size_t index = 0; index < threads; ++index)
+  {
+    workers.emplace_back([&]()
+    {
+      ready.fetch_add(1);
+      while (go.load() == false) {}
+
+      size_t local = 0;
+      for (size_t op = 0; op < OPS_PER_THREAD; ++op)
+        local += func(meter);
+      sink.fetch_add(local, std::memory_order_relaxed);
+    });
+  }
+
+  while (ready.load() < threads) {}
+  auto sta = std::chrono::steady_clock::now();
+  go.store(true);
+  for (auto &worker : workers)
+    worker.join();
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - sta).count();
+
+  return sink.load() == 0 ? 0.0 : static_cast<double>(elapsed) / static_cast<double>(OPS_PER_THREAD);
+}
+
+int main()
+{
+  std::printf("%8s %12s %18s %18s\n", "threads", "add", "add_transaction", "add + get_count");
+
+  for (size_t threads : {1, 2, 4, 8, 16})
+  {
+    double add   = measure(threads, [](BenchTpsMeter &meter) { return static_cast<size_t>(meter.add() & 1) + 1; });
+    double local = measure(threads, [](BenchTpsMeter &meter) { return meter.add_transaction(); });
+    double all   = measure(threads, [](BenchTpsMeter &meter) { return meter.add_and_count(); });
+
+    std::printf("%8zu %9.1f ns %15.1f ns %15.1f ns\n", threads, add, local, all);
+  }
+
+  return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * worker_select.bench.cpp
+ *
+ *  Created on: 2025. 3. 14.
+ *      Author: tys
+ */
+
+/**
+ * WorkerPool 선택 정책별 push 처리량(워커 수 1 ~ 64) 측정.
+ *
+ * 측정 대상
+ *  - WorkerPool::push -> SELECTOR::select -> WORKER::push 경로의 선택 비용과 캐시라인 경합
+ *  - 큐 자체의 비용을 빼기 위해 워커는 깊이(size) 카운터만 가진 더미입니다.
+ *    push는 깊이를 올리는 RMW 1회(실제 큐의 tail/size 갱신과 같은 쓰기 경합)이고,
+ *    워커마다 소비 쓰레드가 SERVICE_NS마다 하나씩 깊이를 내립니다.(처리시간 흉내)
+ *    깊이가 실제로 쌓이므로 least_loaded, power_of_two가 깊이를 보고 고르는 효과가 나타납니다.
+ *  - 생산자(NATS 클라이언트 쓰레드 역할) PRODUCERS개가 동시에 push 합니다.
+ *  - 생산자가 소비보다 빠르므로 깊이는 계속 쌓입니다.(과부하 상태에서의 분배)
+ *  - 소비 쓰레드도 CPU를 쓰므로 워커 수가 코어 수보다 많은 구간의 Mpush/s는 그만큼 낮게 나옵니다.
+ *
+ * 출력
+ *  - Mpush/s : 전체 push 처리량
+ *  - skew    : 가장 많이 받은 워커의 건수 / 평균 (1.00이 완전 균등)
+ *  - peak    : 워커 큐 깊이의 최대값 (작을수록 대기시간 꼬리가 짧음)
+ *
+ * 빌드 (filter-ground 디렉토리에서)
+ *  g++ -O2 -std=c++11 -I./ bench/worker_select.bench.cpp extra/MThread.cpp -o worker_select.bench -pthread
+ */
+
+#include <WorkerPool.h>
+#include <extra/WaitStrategy.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static constexpr size_t  PRODUCERS           = 4;
+static constexpr size_t  PUSHES_PER_PRODUCER = 2000000;
+static constexpr int64_t SERVICE_NS          = 500;   ///< 항목 하나의 처리시간
+
+/// 깊이 카운터를 가진 더미 워커. 소비 쓰레드가 SERVICE_NS마다 하나씩 꺼냅니다.
+class DummyWorker
+{
+public:
+  DummyWorker(const size_t &) {}
+  ~DummyWorker() { stop(); }
+
+  int push(const int &)
+  {
+    int64_t depth = depth_.fetch_add(1, std::memory_order_relaxed) + 1;
+    pushed_.fetch_add(1, std::memory_order_relaxed);
+
+    int64_t peak = peak_.load(std::memory_order_relaxed);
+    while (depth > peak && peak_.compare_exchange_weak(peak, depth, std::memory_order_relaxed) == false) {}
+    return 0;
+  }
+
+  int64_t  size  () const { return depth_.load(std::memory_order_relaxed); }
+  uint64_t pushed() const { return pushed_.load(std::memory_order_relaxed); }
+  int64_t  peak  () const { return peak_.load(std::memory_order_relaxed); }
+
+  void assigned_no(const size_t &) {}
+  void single_producer(const bool &) {}
+  void set_wait_strategy(const wait_strategy_t &) {}
+
+  void start()
+  {
+    running_  = true;
+    consumer_ = std::thread([this]() { consume(); });
+  }
+
+  void stop()
+  {
+    running_ = false;
+    if (consumer_.joinable() == true)
+      consumer_.join();
+  }
+
+protected:
+  void consume()
+  {
+    while (running_.load(std::memory_order_relaxed) == true)
+    {
+      if (depth_.load(std::memory_order_relaxed) <= 0)
+      {
+        std::this_thread::yield();
+        continue;
+      }
+
+      auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(SERVICE_NS);
+      while (std::chrono::steady_clock::now() < until) cpu_relax();
+      depth_.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+protected:
+  std::atomic<int64_t>  depth_{0};
+  std::atomic<uint64_t> pushed_{0};
+  std::atomic<int64_t>  peak_{0};
+  char                  pad_[64 - 3 * sizeof(int64_t)];  ///< 생산자가 쓰는 카운터와 소비 쓰레드 상태 분리
+  std::atomic<bool>     running_{false};
+  std::thread           consumer_;
+};
+
+template<typename SELECTOR>
+class BenchPool : public WorkerPool<DummyWorker, int, SELECTOR>
+{
+public:
+  double skew() const
+  {
+    uint64_t total = 0, max = 0;
+    for (auto &worker : this->workers_)
+    {
+      total += worker.pushed();
+      if (worker.pushed() > max) max = worker.pushed();
+    }
+    return static_cast<double>(max) * static_cast<double>(this->workers_.size()) / static_cast<double>(total);
+  }
+
+  int64_t peak() const
+  {
+    int64_t max = 0;
+    for (auto &worker : this->workers_)
+      if (worker.peak() > max) max = worker.peak();
+    return max;
+  }
+};
+
+template<typename SELECTOR>
+static void
+bench(const char *name)
+{
+  std::printf("%-14s", name);
+  for (size_t workers = 1; workers <= 64; workers *= 2)
+  {
+    BenchPool<SELECTOR> pool;
+    pool.set_num_of_workers(workers, 0);
+    pool.start();
+
+    std::atomic<bool> go{false};
+    std::vector<std::thread> producers;
+    for (size_t index = 0; index < PRODUCERS; ++index)
+    {
+      producers.emplace_back([&]()
+      {
+        while (go.load() == false) cpu_relax();
+        for (size_t count = 0; count < PUSHES_PER_PRODUCER; ++count)
+          pool.push(static_cast<int>(count));
+      });
+    }
+
+    auto sta = std::chrono::steady_clock::now();
+    go = true;
+    for (auto &producer : producers) producer.join();
+    auto sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - sta).count();
+    pool.stop();
+
+    std::printf(" %6.1f/%4.2f/%-7lld", static_cast<double>(PRODUCERS * PUSHES_PER_PRODUCER) / sec / 1e6, pool.skew(),
+                static_cast<long long>(pool.peak()));
+  }
+  std::printf("\n");
+}
+
+int main()
+{
+  std::printf("producers=%zu pushes=%zu service=%lldns  (Mpush/s / skew / peak)\n", PRODUCERS, PRODUCERS * PUSHES_PER_PRODUCER,
+              static_cast<long long>(SERVICE_NS));
+  std::printf("%-14s", "workers");
+  for (size_t workers = 1; workers <= 64; workers *= 2)
+    std::printf(" %19zu", workers);
+  std::printf("\n");
+
+  bench<least_loaded_selector>("least_loaded");
+  bench<power_of_two_selector>("power_of_two");
+  bench<sticky_selector      >("sticky");
+  bench<round_robin_selector >("round_robin");
+  return 0;
+}
@@ -0,0 +1,692 @@
+/*
+ * BinaryCodec.h
+ *
+ *  Created on: 2025. 3. 20.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <extra/FieldReflect.h>
+#include <extra/rapidjson_helper.h>
+#include <extra/Optional.h>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @file BinaryCodec.h
+ * @brief 필터 단계간 전송용 바이너리 인코딩 (JSON 대체)
+ * @details
+ * FIELD_REFLECT로 등록한 필드 순서(스키마)대로 값만 기록합니다. 필드 이름을 기록하지 않으므로 작고 빠릅니다.
+ *
+ * 메세지 형식
+ *  [magic 4 "\0SFB"][schema hash 8][값]
+ *  - magic은 '\0'으로 시작하므로 JSON과 구분됩니다.(is_binary_message)
+ *  - schema hash는 필드 이름/순서/타입으로 계산합니다. 양쪽 구조체가 다르면 디코딩하지 않고 오류입니다.
+ *
+ * 값 형식
+ *  정수               : zigzag varint
+ *  float, double      : 8 byte (little endian 호스트 기준)
+ *  char               : 1 byte
+ *  std::string        : varint 길이 + 원문 (디코딩 없이 버퍼를 가리킬 수 있음)
+ *  Optional<T>        : 1 byte(0:없음, 1:있음) + T
+ *  std::vector<T>     : varint 개수 + T...
+ *  std::map<K, V>     : varint 개수 + (K, V)...
+ *  FIELD_REFLECT 구조체 : 4 byte 길이 + 필드값... (길이로 구조체를 통째로 건너뛸 수 있음)
+ *  그 외 구조체         : 4 byte 길이 + JSON + '\0' (write_value/set_value 사용. FIELD_REFLECT로 등록하면 바이너리)
+ *
+ * example)
+ *  std::string out;
+ *  bin_encode(out, value);
+ *
+ *  result_info_t back;
+ *  std::string   error;
+ *  if (bin_decode(out, back, error) == false) ...
+ */
+
+/// 타입 구분용 태그 (오버로드 선택)
+template<typename T> struct bin_tag {};
+
+/// 바이너리 출력. 결과는 생성시 전달한 문자열 뒤에 추가됩니다.
+class bin_writer_t
+{
+public:
+  explicit bin_writer_t(std::string &out) : out_(out) {}
+
+  void varint(uint64_t value)
+  {
+    char   buf[10];
+    size_t size = 0;
+    while (value >= 0x80)
+    {
+      buf[size++] = static_cast<char>(value | 0x80);
+      value >>= 7;
+    }
+    buf[size++] = static_cast<char>(value);
+    out_.append(buf, size);
+  }
+
+  void zigzag(const int64_t &value) { varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63)); }
+  void raw   (const void *data, const size_t &size) { out_.append(static_cast<const char *>(data), size); }
+
+  void bytes(const char *data, const size_t &size)
+  {
+    varint(size);
+    out_.append(data, size);
+  }
+
+  /// 4 byte 길이 자리를 잡고 위치를 리턴. 값을 다 쓴 후 end_block으로 길이를 채운다.
+  size_t begin_block()
+  {
+    out_.append(4, '\0');
+    return out_.size();
+  }
+
+  void end_block(const size_t &begin)
+  {
+    uint32_t size = static_cast<uint32_t>(out_.size() - begin);
+    for (size_t index = 0; index < 4; ++index)
+      out_[begin - 4 + index] = static_cast<char>(size >> (8 * index));
+  }
+
+  std::string &out() { return out_; }
+
+protected:
+  std::string &out_;
+};
+
+/// 바이너리 입력. 범위를 벗어나거나 형식이 틀리면 ok()가 false이며 이후 읽기는 모두 실패합니다.
+class bin_reader_t
+{
+public:
+  bin_reader_t() = default;
+  bin_reader_t(const char *begin, const char *end) : pos_(begin), end_(end) {}
+
+  bool varint(uint64_t &value)
+  {
+    value = 0;
+    for (int shift = 0; shift < 64 && ok_ == true; shift += 7)
+    {
+      if (pos_ == end_)
+        break;
+      uint8_t byte = static_cast<uint8_t>(*pos_++);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+        return true;
+    }
+    return fail("invalid varint");
+  }
+
+  bool zigzag(int64_t &value)
+  {
+    uint64_t encoded = 0;
+    if (varint(encoded) == false)
+      return false;
+    value = static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1);
+    return true;
+  }
+
+  bool raw(void *data, const size_t &size)
+  {
+    if (remain() < size)
+      return fail("truncated");
+    std::memcpy(data, pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+  /// 문자열. data는 입력 버퍼를 가리킵니다.
+  bool bytes(const char *&data, size_t &size)
+  {
+    uint64_t length = 0;
+    if (varint(length) == false)
+      return false;
+    if (remain() < length)
+      return fail("truncated string");
+    data = pos_;
+    size = static_cast<size_t>(length);
+    pos_ += size;
+    return true;
+  }
+
+  /// 4 byte 길이의 블록. block은 블록 내용만 읽는 reader
+  bool block(bin_reader_t &block)
+  {
+    uint8_t  buf[4];
+    if (raw(buf, 4) == false)
+      return false;
+
+    uint32_t size = buf[0] | (buf[1] << 8) | (buf[2] << 16) | (static_cast<uint32_t>(buf[3]) << 24);
+    if (remain() < size)
+      return fail("truncated block");
+
+    block = bin_reader_t(pos_, pos_ + size);
+    pos_ += size;
+    return true;
+  }
+
+  bool skip(const size_t &size)
+  {
+    if (remain() < size)
+      return fail("truncated");
+    pos_ += size;
+    return true;
+  }
+
+  /// 하위 reader(block)의 오류를 전달
+  bool fail(const std::string &error)
+  {
+    if (ok_ == true)
+      error_ = error;
+    ok_ = false;
+    pos_ = end_;
+    return false;
+  }
+
+  bool               ok    () const { return ok_;  }
+  const std::string &error () const { return error_; }
+  const char        *pos   () const { return pos_; }
+  size_t             remain() const { return static_cast<size_t>(end_ - pos_); }
+
+protected:
+  const char  *pos_ = nullptr;
+  const char  *end_ = nullptr;
+  bool         ok_  = true;
+  std::string  error_;
+};
+
+/// 스키마 해시 조합
+inline uint64_t
+bin_schema_mix(const uint64_t &hash, const uint64_t &value)
+{
+  uint64_t mixed = (hash ^ value) * 0x100000001b3ULL;
+  return mixed ^ (mixed >> 29);
+}
+
+/// 쓰기 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
+inline void bin_write(bin_writer_t &writer, const char        &value) { writer.raw(&value, 1);      }
+inline void bin_write(bin_writer_t &writer, const int16_t     &value) { writer.zigzag(value);       }
+inline void bin_write(bin_writer_t &writer, const int32_t     &value) { writer.zigzag(value);       }
+inline void bin_write(bin_writer_t &writer, const int64_t     &value) { writer.zigzag(value);       }
+inline void bin_write(bin_writer_t &writer, const long long   &value) { writer.zigzag(value);       }
+inline void bin_write(bin_writer_t &writer, const double      &value) { writer.raw(&value, 8);      }
+inline void bin_write(bin_writer_t &writer, const float       &value) { bin_write(writer, static_cast<double>(value)); }
+inline void bin_write(bin_writer_t &writer, const std::string &value) { writer.bytes(value.data(), value.size()); }
+
+template<typename T> void bin_write(bin_writer_t &writer, const Optional<T>          &value);
+template<typename T> void bin_write(bin_writer_t &writer, const std::vector<T>       &values);
+template<typename K, typename V> void bin_write(bin_writer_t &writer, const std::map<K, V> &values);
+
+template<typename T>
+struct bin_write_field_t
+{
+  bin_writer_t &writer;
+  const T      &value;
+
+  template<typename FIELD> void operator()(const FIELD &field) { bin_write(writer, value.*(field.member)); }
+};
+
+template<typename T> typename std::enable_if<is_field_reflected<T>::value>::type
+bin_write(bin_writer_t &writer, const T &value)
+{
+  size_t begin = writer.begin_block();
+  bin_write_field_t<T> write{writer, value};
+  for_each_field(field_reflect_t<T>::fields(), write);
+  writer.end_block(begin);
+}
+
+/// FIELD_REFLECT로 등록되지 않은 구조체는 JSON으로 기록
+template<typename T> typename std::enable_if<!is_field_reflected<T>::value && std::is_class<T>::value>::type
+bin_write(bin_writer_t &writer, const T &value)
+{
+  static thread_local rapidjson::StringBuffer buffer;
+  static thread_local rapidjson::Writer<rapidjson::StringBuffer> json;
+  buffer.Clear();
+  json.Reset(buffer);
+  write_value(json, value);
+
+  size_t begin = writer.begin_block();
+  writer.raw(buffer.GetString(), buffer.GetSize());
+  writer.raw("", 1); ///< '\0'. 블록 안에서 SAX 파서(StringStream)가 끝을 알 수 있도록
+  writer.end_block(begin);
+}
+
+template<typename T> void
+bin_write(bin_writer_t &writer, const Optional<T> &value)
+{
+  writer.raw(value.has_value() ? "\1" : "\0", 1);
+  if (value.has_value() == true)
+    bin_write(writer, value.value());
+}
+
+template<typename T> void
+bin_write(bin_writer_t &writer, const std::vector<T> &values)
+{
+  writer.varint(values.size());
+  for (auto &value : values)
+    bin_write(writer, value);
+}
+
+template<typename K, typename V> void
+bin_write(bin_writer_t &writer, const std::map<K, V> &values)
+{
+  writer.varint(values.size());
+  for (auto &value : values)
+  {
+    bin_write(writer, value.first);
+    bin_write(writer, value.second);
+  }
+}
+
+/// 읽기 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename T> bool
+bin_read_int(bin_reader_t &reader, T &value)
+{
+  int64_t encoded = 0;
+  if (reader.zigzag(encoded) == false)
+    return false;
+  value = static_cast<T>(encoded);
+  return true;
+}
+
+inline bool bin_read(bin_reader_t &reader, char      &value) { return reader.raw(&value, 1);        }
+inline bool bin_read(bin_reader_t &reader, int16_t   &value) { return bin_read_int(reader, value);  }
+inline bool bin_read(bin_reader_t &reader, int32_t   &value) { return bin_read_int(reader, value);  }
+inline bool bin_read(bin_reader_t &reader, int64_t   &value) { return bin_read_int(reader, value);  }
+inline bool bin_read(bin_reader_t &reader, long long &value) { return bin_read_int(reader, value);  }
+inline bool bin_read(bin_reader_t &reader, double    &value) { return reader.raw(&value, 8);        }
+
+inline bool
+bin_read(bin_reader_t &reader, float &value)
+{
+  double wide = 0;
+  if (reader.raw(&wide, 8) == false)
+    return false;
+  value = static_cast<float>(wide);
+  return true;
+}
+
+inline bool
+bin_read(bin_reader_t &reader, std::string &value)
+{
+  const char *data = nullptr;
+  size_t      size = 0;
+  if (reader.bytes(data, size) == false)
+    return false;
+  value.assign(data, size);
+  return true;
+}
+
+template<typename T> bool bin_read(bin_reader_t &reader, Optional<T>    &value);
+template<typename T> bool bin_read(bin_reader_t &reader, std::vector<T> &values);
+template<typename K, typename V> bool bin_read(bin_reader_t &reader, std::map<K, V> &values);
+
+template<typename T>
+struct bin_read_field_t
+{
+  bin_reader_t &reader;
+  T            &value;
+
+  template<typename FIELD> void operator()(const FIELD &field)
+  {
+    if (reader.ok() == true)
+      bin_read(reader, value.*(field.member));
+  }
+};
+
+template<typename T> typename std::enable_if<is_field_reflected<T>::value, bool>::type
+bin_read(bin_reader_t &reader, T &value)
+{
+  bin_reader_t block;
+  if (reader.block(block) == false)
+    return false;
+
+  bin_read_field_t<T> read{block, value};
+  for_each_field(field_reflect_t<T>::fields(), read);
+  return block.ok() == true ? true : reader.fail(block.error());
+}
+
+template<typename T> typename std::enable_if<!is_field_reflected<T>::value && std::is_class<T>::value, bool>::type
+bin_read(bin_reader_t &reader, T &value)
+{
+  bin_reader_t block;
+  if (reader.block(block) == false)
+    return false;
+
+  if (block.remain() == 0 || block.pos()[block.remain() - 1] != '\0')
+    return reader.fail("invalid JSON block");
+
+  rapidjson::Document doc;
+  if (doc.Parse(block.pos()).HasParseError() == true || doc.IsObject() == false)
+    return reader.fail("JSON parse error!");
+
+  try
+  {
+    set_value(value, doc);
+  }
+  catch (const std::string &e)
+  {
+    return reader.fail(e);
+  }
+  return true;
+}
+
+template<typename T> bool
+bin_read(bin_reader_t &reader, Optional<T> &value)
+{
+  char flag = 0;
+  if (reader.raw(&flag, 1) == false)
+    return false;
+
+  value = nullopt;
+  if (flag == 0)
+    return true;
+
+  T item;
+  if (bin_read(reader, item) == false)
+    return false;
+  value = std::move(item);
+  return true;
+}
+
+template<typename T> bool
+bin_read(bin_reader_t &reader, std::vector<T> &values)
+{
+  uint64_t count = 0;
+  if (reader.varint(count) == false)
+    return false;
+  if (count > reader.remain())  ///< 원소마다 최소 1 byte. 잘못된 개수로 큰 메모리를 잡지 않도록
+    return reader.fail("invalid count");
+
+  values.clear();
+  values.resize(static_cast<size_t>(count));
+  for (auto &value : values)
+    if (bin_read(reader, value) == false)
+      return false;
+  return true;
+}
+
+template<typename K, typename V> bool
+bin_read(bin_reader_t &reader, std::map<K, V> &values)
+{
+  uint64_t count = 0;
+  if (reader.varint(count) == false)
+    return false;
+  if (count > reader.remain())
+    return reader.fail("invalid count");
+
+  values.clear();
+  for (uint64_t index = 0; index < count; ++index)
+  {
+    K key;
+    if (bin_read(reader, key) == false || bin_read(reader, values[key]) == false)
+      return false;
+  }
+  return true;
+}
+
+/// 건너뛰기 (값을 만들지 않음) ////////////////////////////////////////////////////////////////////////////////////////
+inline bool bin_skip(bin_reader_t &reader, bin_tag<char>)        { return reader.skip(1); }
+inline bool bin_skip(bin_reader_t &reader, bin_tag<double>)      { return reader.skip(8); }
+inline bool bin_skip(bin_reader_t &reader, bin_tag<float>)       { return reader.skip(8); }
+inline bool bin_skip(bin_reader_t &reader, bin_tag<std::string>) { const char *data; size_t size; return reader.bytes(data, size); }
+
+template<typename T> typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, char>::value, bool>::type
+bin_skip(bin_reader_t &reader, bin_tag<T>)
+{
+  uint64_t value = 0;
+  return reader.varint(value);
+}
+
+template<typename T> typename std::enable_if<std::is_class<T>::value, bool>::type
+bin_skip(bin_reader_t &reader, bin_tag<T>)
+{
+  bin_reader_t block;
+  return reader.block(block);
+}
+
+template<typename T> bool
+bin_skip(bin_reader_t &reader, bin_tag<Optional<T>>)
+{
+  char flag = 0;
+  if (reader.raw(&flag, 1) == false)
+    return false;
+  return flag == 0 ? true : bin_skip(reader, bin_tag<T>());
+}
+
+template<typename T> bool
+bin_skip(bin_reader_t &reader, bin_tag<std::vector<T>>)
+{
+  uint64_t count = 0;
+  if (reader.varint(count) == false)
+    return false;
+  for (uint64_t index = 0; index < count; ++index)
+    if (bin_skip(reader, bin_tag<T>()) == false)
+      return false;
+  return true;
+}
+
+template<typename K, typename V> bool
+bin_skip(bin_reader_t &reader, bin_tag<std::map<K, V>>)
+{
+  uint64_t count = 0;
+  if (reader.varint(count) == false)
+    return false;
+  for (uint64_t index = 0; index < count; ++index)
+    if (bin_skip(reader, bin_tag<K>()) == false || bin_skip(reader, bin_tag<V>()) == false)
+      return false;
+  return true;
+}
+
+/// 스키마 해시 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+#define BIN_SCHEMA_KIND(TYPE, KIND) \
+  inline uint64_t bin_schema(bin_tag<TYPE>) { return field_key_hash(KIND, sizeof(KIND) - 1); }
+
+BIN_SCHEMA_KIND(char,        "char")
+BIN_SCHEMA_KIND(int16_t,     "int")
+BIN_SCHEMA_KIND(int32_t,     "int")
+BIN_SCHEMA_KIND(int64_t,     "int")
+BIN_SCHEMA_KIND(long long,   "int")
+BIN_SCHEMA_KIND(float,       "double")
+BIN_SCHEMA_KIND(double,      "double")
+BIN_SCHEMA_KIND(std::string, "string")
+
+#undef BIN_SCHEMA_KIND
+
+template<typename T> uint64_t bin_schema(bin_tag<Optional<T>>);
+template<typename T> uint64_t bin_schema(bin_tag<std::vector<T>>);
+template<typename K, typename V> uint64_t bin_schema(bin_tag<std::map<K, V>>);
+
+struct bin_schema_field_t
+{
+  uint64_t hash;
+
+  template<typename FIELD> void operator()(const FIELD &field)
+  {
+    hash = bin_schema_mix(hash, field.key.hash);
+    hash = bin_schema_mix(hash, bin_schema(bin_tag<typename FIELD::value_type>()));
+  }
+};
+
+template<typename T> typename std::enable_if<is_field_reflected<T>::value, uint64_t>::type
+bin_schema(bin_tag<T>)
+{
+  bin_schema_field_t schema{field_key_hash("struct", 6)};
+  for_each_field(field_reflect_t<T>::fields(), schema);
+  return schema.hash;
+}
+
+template<typename T> typename std::enable_if<!is_field_reflected<T>::value && std::is_class<T>::value, uint64_t>::type
+bin_schema(bin_tag<T>)
+{
+  return field_key_hash("json", 4);
+}
+
+template<typename T> uint64_t
+bin_schema(bin_tag<Optional<T>>)
+{
+  return bin_schema_mix(field_key_hash("optional", 8), bin_schema(bin_tag<T>()));
+}
+
+template<typename T> uint64_t
+bin_schema(bin_tag<std::vector<T>>)
+{
+  return bin_schema_mix(field_key_hash("vector", 6), bin_schema(bin_tag<T>()));
+}
+
+template<typename K, typename V> uint64_t
+bin_schema(bin_tag<std::map<K, V>>)
+{
+  return bin_schema_mix(bin_schema_mix(field_key_hash("map", 3), bin_schema(bin_tag<K>())), bin_schema(bin_tag<V>()));
+}
+
+/// T의 스키마 해시. 처음 한번만 계산
+template<typename T> uint64_t
+bin_schema_hash()
+{
+  static const uint64_t hash = bin_schema(bin_tag<T>());
+  return hash;
+}
+
+/// 메세지 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+constexpr char   bin_magic[]      = { '\0', 'S', 'F', 'B' };
+constexpr size_t bin_header_size  = sizeof(bin_magic) + 8;
+
+/// 바이너리 메세지인지 (JSON은 '\0'으로 시작하지 않음)
+inline bool
+is_binary_message(const std::string &message)
+{
+  return message.size() >= bin_header_size && std::memcmp(message.data(), bin_magic, sizeof(bin_magic)) == 0;
+}
+
+/// 헤더(magic, schema hash)와 값을 out 뒤에 추가
+template<typename T> void
+bin_encode(std::string &out, const T &value)
+{
+  uint64_t hash = bin_schema_hash<T>();
+  char     header[bin_header_size];
+  std::memcpy(header, bin_magic, sizeof(bin_magic));
+  for (size_t index = 0; index < 8; ++index)
+    header[sizeof(bin_magic) + index] = static_cast<char>(hash >> (8 * index));
+
+  bin_writer_t writer(out);
+  writer.raw(header, sizeof(header));
+  bin_write(writer, value);
+}
+
+/// 헤더를 확인하고 값 위치의 reader를 리턴. 실패시 reader.ok() == false
+template<typename T> bin_reader_t
+bin_open(const std::string &message)
+{
+  bin_reader_t reader(message.data(), message.data() + message.size());
+  if (is_binary_message(message) == false)
+  {
+    reader.fail("not binary message");
+    return reader;
+  }
+
+  uint8_t hash[8];
+  reader.skip(sizeof(bin_magic));
+  reader.raw(hash, 8);
+
+  uint64_t schema = 0;
+  for (size_t index = 0; index < 8; ++index)
+    schema |= static_cast<uint64_t>(hash[index]) << (8 * index);
+
+  if (schema != bin_schema_hash<T>())
+    reader.fail("binary schema mismatch");
+  return reader;
+}
+
+/// @return false : 형식 오류 (error에 사유)
+template<typename T> bool
+bin_decode(const std::string &message, T &value, std::string &error)
+{
+  bin_reader_t reader = bin_open<T>(message);
+  if (reader.ok() == true)
+    bin_read(reader, value);
+
+  if (reader.ok() == false)
+  {
+    error = reader.error();
+    return false;
+  }
+  return true;
+}
+
+template<typename FUNC>
+struct bin_seek_field_t
+{
+  bin_reader_t &reader;
+  size_t        index;
+  size_t        current;
+  FUNC         &func;
+  bool          found;
+
+  template<typename FIELD> void operator()(const FIELD &field)
+  {
+    if (found == true || reader.ok() == false)
+      return;
+
+    if (current++ < index)
+    {
+      bin_skip(reader, bin_tag<typename FIELD::value_type>());
+      return;
+    }
+
+    found = true;
+    func(field, reader);
+  }
+};
+
+/**
+ * @brief 등록된 구조체 T의 name 필드를 찾아서 func(field, reader) 호출
+ * @details reader는 T의 블록 위치여야 하며, func는 필드값 위치의 reader를 받습니다.
+ *          앞의 필드들은 값을 만들지 않고 건너뜁니다.
+ * @return false : 필드가 없거나 형식 오류
+ */
+template<typename T, typename FUNC> bool
+bin_seek(bin_reader_t &reader, const char *name, FUNC &func)
+{
+  size_t index = field_reflect_t<T>::find(name, std::strlen(name));
+  if (index == field_reflect_t<T>::size)
+    return false;
+
+  bin_reader_t block;
+  if (reader.block(block) == false)
+    return false;
+
+  bin_seek_field_t<FUNC> seek{block, index, 0, func, false};
+  for_each_field(field_reflect_t<T>::fields(), seek);
+  return seek.found == true && block.ok() == true;
+}
+
+/// 설정용. 전송 형식
+enum class wire_format_t : uint8_t
+{
+  json = 0,
+  binary,
+};
+
+inline const char *
+to_string(const wire_format_t &format)
+{
+  switch (format)
+  {
+    case wire_format_t::json  : return "json";
+    case wire_format_t::binary: return "binary";
+  }
+  return "unknown";
+}
+
+/// 설정 문자열을 wire_format_t로 변환. 모르는 이름이면 false
+inline bool
+to_wire_format(const std::string &name, wire_format_t &format)
+{
+  if (name == "json"  ) { format = wire_format_t::json;   return true; }
+  if (name == "binary") { format = wire_format_t::binary; return true; }
+  return false;
+}
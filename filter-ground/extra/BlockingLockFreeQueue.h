@@ -1,15 +1,42 @@
 #pragma once
 
 #include <extra/MSignal.h>
+#include <extra/BoundedRing.h>
+#include <extra/WaitStrategy.h>
 #include <boost/lockfree/queue.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
 #include <thread>
 
+/**
+ * @brief BlockingLockFreeQueue의 백엔드 선택 trait.
+ * @details
+ * 기본값은 boost::lockfree::queue(MPMC, 노드기반) 입니다.
+ * Options의 첫번째 인자가 queue_backend::bounded_ring이면 BoundedRing(배열기반 링버퍼)을 사용합니다.
+ * counted : 백엔드가 size를 직접 계산하지 못해 별도의 카운터(size_)가 필요한지 여부.
+ */
+template<typename T, typename... Options>
+struct lockfree_backend
+{
+  using type = boost::lockfree::queue<T, Options...>;
+  static constexpr bool counted = true;
+};
+
+template<typename T, typename... Options>
+struct lockfree_backend<T, queue_backend::bounded_ring, Options...>
+{
+  using type = BoundedRing<T>;
+  static constexpr bool counted = false;
+};
+
 /**
  * @class BlockingLockFreeQueue
  * @brief boost::lockfree::queue 를 사용하는 블럭킹 큐 클래스.
- * @tparam SIGNALED, 큐에서 처리할 데이터 타입. false는 스피닝기반, true는 signal기반
+ * @tparam SIGNALED, 기본 대기방식. false는 스피닝기반(adaptive), true는 signal기반
  * @tparam T, 큐에서 처리할 데이터 타입.
- * @tparam Options, boost::lockfree::queue의 옵션
+ * @tparam Options, boost::lockfree::queue의 옵션 또는 queue_backend::bounded_ring
  * @details
  * 기본동작
  *    블럭킹 큐는 큐가 비어있을때 pop을 호출하면 대기하다가 큐에 데이터가 들어오면 리턴합니다.
@@ -21,6 +48,15 @@
  *    큐가 꽉차면 push를 호출해도 EAGAIN을 리턴합니다. 보통 while문으로 처리합니다.
  * pop 동작
  *    pop은 adaptive하게 동작합니다. 큐가 비어있으면 spin하다가 일정시간이 지나면 sleep합니다.
+ *    timeout_ms(또는 pop_until의 deadline)가 지나면 ETIMEDOUT을 리턴합니다.(signal 방식 포함)
+ *    pop_bulk는 여러개를 한번에 꺼냅니다. 소비자가 배치단위로 처리할때 사용합니다.
+ * 백엔드
+ *    queue_backend::bounded_ring을 사용하면 single_producer/single_consumer로 SPSC, MPSC 모드를 지정할 수 있습니다.
+ *    반드시 쓰레드 시작 전에 설정해야 합니다. @see BoundedRing
+ * 대기방식
+ *    set_wait_strategy로 큐가 비었을때의 대기방식을 실행중에 선택할 수 있습니다.(쓰레드 시작 전에 설정)
+ *    SIGNALED는 기본값만 결정합니다. @see wait_strategy_t
+ *    큐가 꽉 찼을때 생산자는 wait_space로 소비자가 꺼낼때까지 대기할 수 있습니다.
  */
 template<bool SIGNALED, typename T, typename... Options>
 class BlockingLockFreeQueue
@@ -31,7 +67,15 @@ public:
 
   ~BlockingLockFreeQueue() {}
 
-  bool is_signaled() const { return SIGNALED; }
+  bool is_signaled() const { return wait_strategy() == wait_strategy_t::signal; }
+
+  /// 생산자/소비자가 동작하기 전에 설정해야 합니다.
+  void set_wait_strategy(const wait_strategy_t &strategy) { strategy_.store(strategy); }
+  wait_strategy_t wait_strategy() const { return strategy_.load(std::memory_order_relaxed); }
+
+  /// queue_backend::bounded_ring 백엔드에서만 사용할 수 있습니다.
+  void single_producer(const bool &single) { queue_.single_producer(single); }
+  void single_consumer(const bool &single) { queue_.single_consumer(single); }
 
   void open()
   {
@@ -41,8 +85,10 @@ public:
   void close()
   {
     open_ = false;
-    if (SIGNALED == true)
+    if (wait_strategy() == wait_strategy_t::signal)
       signal_.notify_one();
+    event_.notify_all();
+    space_.notify_all();
   }
 
   // 0 : 성공
@@ -56,27 +102,120 @@ public:
     if (queue_.push(item) == false)
       return EAGAIN;
 
-    ++size_;
+    if (backend_t::counted == true)
+      ++size_;
 
-    if (SIGNALED == true)
-      if (queue_.empty() == false)
-        signal_.notify_one();
+    switch (wait_strategy())
+    {
+      case wait_strategy_t::signal:
+        if (queue_.empty() == false)
+          signal_.notify_one();
+        break;
+      case wait_strategy_t::park:
+        event_.notify();  // 소비자가 대기중일 때만 syscall
+        break;
+      default:
+        break;
+    }
 
     return 0;
   }
 
+  /**
+   * @brief 큐에 자리가 날때까지 최대 timeout_ms 대기 (큐가 꽉 찼을때 생산자용)
+   * @return 0 : 자리 있음, ETIMEDOUT : 시간초과, -1 : 큐 닫힘
+   * @details 소비자는 꺼낼때 fence 없이 대기자를 확인하므로 깨움을 놓치면 timeout까지 기다립니다.
+   */
+  int wait_space(const int64_t &timeout_ms)
+  {
+    uint32_t key = space_.prepare_wait();
+    if (open_.load() == false)
+    {
+      space_.cancel_wait();
+      return -1;
+    }
+
+    if (size() < static_cast<int64_t>(capacity()))
+    {
+      space_.cancel_wait();
+      return 0;
+    }
+
+    space_.wait(key, timeout_ms);
+    return size() < static_cast<int64_t>(capacity()) ? 0 : ETIMEDOUT;
+  }
+
+  using time_point = std::chrono::steady_clock::time_point;
+
   // 0 : 정상수신
   // -1 : 큐 닫힘
-  // 양수 : 타임아웃(ETIMEDOUT = 110) <- 확장 예정.
+  // 양수 : 타임아웃(ETIMEDOUT = 110). timeout_ms가 0이면 무한대기
   // condition variable의 특성상 발생할 수 있는 "lost wakeup" 또는 "missed notification" 문제
   // 는 MSignal 클래스에서 처리되므로 상관이 없다.
   int pop(T &item, const int64_t &timeout_ms = 0)
   {
-    if (SIGNALED == true)
-      return signaled_pop(item);
+    return pop_until(item, to_deadline(timeout_ms));
+  }
+
+  /**
+   * @brief deadline까지 대기하며 큐에서 하나를 꺼냅니다.
+   * @return pop과 같음. deadline이 지나면 ETIMEDOUT
+   * @details 모든 대기방식(signal 포함)에서 동작합니다. 주기적인 작업이나 부분 배치 처리에 사용합니다.
+   */
+  int pop_until(T &item, const time_point &deadline)
+  {
+    int res = wait_pop(item, deadline);
+    if (res == 0)
+      sub_size(1);
+    return res;
+  }
+
+  /**
+   * @brief 대기없이 큐에서 하나를 꺼냅니다.
+   * @return 0 : 성공, EAGAIN : 큐 비었음
+   * @details 다른 쓰레드가 이 큐에서 꺼내가는 경우(work stealing)에 사용합니다.
+   * bounded_ring 백엔드는 single_consumer(false)로 설정되어 있어야 합니다.
+   */
+  int try_pop(T &item)
+  {
+    if (queue_.pop(item) == false)
+      return EAGAIN;
+
+    sub_size(1);
+    return 0;
+  }
+
+  /**
+   * @brief 큐에서 최대 max개를 한번에 꺼냅니다.
+   * @param out 꺼낸 항목을 저장할 배열. 최소 max개 크기여야 합니다.
+   * @param max 최대 개수
+   * @param timeout_ms 첫번째 항목을 기다리는 시간. 0이면 무한대기
+   * @return 꺼낸 개수(1 ~ max), 0 : 타임아웃, -1 : 큐 닫힘(남은 데이터 없음)
+   * @details
+   * 첫번째 항목은 pop과 같은 방식으로 기다리며, 이후 항목은 대기없이 큐에 있는 만큼만 꺼냅니다.
+   * size_ 조정은 호출당 한번만 합니다.
+   */
+  int pop_bulk(T *out, const size_t &max, const int64_t &timeout_ms = 0)
+  {
+    return pop_bulk_until(out, max, to_deadline(timeout_ms));
+  }
+
+  /// pop_bulk의 deadline 버전. 첫번째 항목을 deadline까지 기다립니다.
+  int pop_bulk_until(T *out, const size_t &max, const time_point &deadline)
+  {
+    if (max == 0)
+      return 0;
+
+    int res = wait_pop(out[0], deadline);
+    if (res < 0)  return -1;
+    if (res > 0)  return 0;
+
+    size_t count = 1;
+    while (count < max && queue_.pop(out[count]) == true)
+      ++count;
 
-    // ADAPTIVE SPIN처리
-    return adaptive_pop(item, timeout_ms);
+    sub_size(count);
+    return static_cast<int>(count);
   }
 
   bool empty() const
@@ -87,7 +226,7 @@ public:
   // lockfree 특성상 음수가 발생할 수도 있습니다.
   int64_t size() const
   {
-    return size_.load();
+    return backend_size(queue_, size_);
   }
 
   size_t capacity() const
@@ -95,26 +234,79 @@ public:
     return queue_.capacity();
   }
 
+  /// 큐 저장공간을 NUMA node로 옮깁니다. bounded_ring 백엔드만 지원하며 그 외는 false
+  bool move_to_node(const int &node)
+  {
+    return backend_move_to_node(queue_, node);
+  }
+
   bool is_open() const
   {
     return open_.load();
   }
 
 protected:
-  int signaled_pop(T &item)
+  static time_point to_deadline(const int64_t &timeout_ms)
+  {
+    if (timeout_ms <= 0)
+      return time_point::max();
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  }
+
+  /// deadline까지 남은 시간(ms, 올림). 0 이하이면 만료
+  static int64_t remain_ms(const time_point &deadline)
+  {
+    auto remain = std::chrono::duration_cast<std::chrono::microseconds>
+                    (deadline - std::chrono::steady_clock::now()).count();
+    return remain <= 0 ? 0 : (remain + 999) / 1000;
+  }
+
+  int wait_pop(T &item, const time_point &deadline)
+  {
+    switch (wait_strategy())
+    {
+      case wait_strategy_t::signal: return signaled_pop(item, deadline);
+      case wait_strategy_t::park  : return parked_pop  (item, deadline);
+      default                     : break;
+    }
+
+    // ADAPTIVE, SPIN, YIELD, BACKOFF 처리
+    return adaptive_pop(item, deadline);
+  }
+
+  /// 꺼낸 후 처리. 자리를 기다리는 생산자가 있으면 깨웁니다.(wait_space)
+  void sub_size(const size_t &count)
+  {
+    if (backend_t::counted == true)
+      size_.fetch_sub(static_cast<int64_t>(count));
+    space_.notify_all_relaxed();
+  }
+
+  // 0 : 정상수신
+  // -1 : 큐 닫힘
+  // 양수 : 타임아웃(ETIMEDOUT)
+  int signaled_pop(T &item, const time_point &deadline)
   {
     while (true)
     {
       if (queue_.pop(item) == true)
-      {
-        --size_;
         return 0;
-      }
 
       if (queue_.empty() == true && open_ == false)
         return -1;
 
-      signal_.wait();
+      if (deadline == time_point::max())
+      {
+        signal_.wait();
+        continue;
+      }
+
+      // MSignal::wait(msec)이 false(타임아웃)여도 큐를 한번 더 확인한 후 리턴한다.
+      int64_t remain = remain_ms(deadline);
+      if (remain <= 0)
+        return ETIMEDOUT;
+
+      signal_.wait(static_cast<uint32_t>(std::min<int64_t>(remain, UINT32_MAX)));
     }
 
     return 0;
@@ -122,39 +314,108 @@ protected:
 
   // 0 : 정상수신
   // -1 : 큐 닫힘
-  int adaptive_pop(T & item, const int64_t &timeout_ms = 0)
+  // 양수 : 타임아웃(ETIMEDOUT)
+  int adaptive_pop(T & item, const time_point &deadline)
   {
-     int fails = 0;
+     const wait_strategy_t strategy = wait_strategy();
+     const bool            timed    = deadline != time_point::max();
+     uint32_t fails = 0;
 
-     auto sta = std::chrono::steady_clock::now();
      while (queue_.pop(item) == false)
      {
        if (open_.load() == false)
          return -1;
 
-       // timeout_ms가 0보다 큰 경우에만 타임아웃 체크
-       if (timeout_ms > 0)
-       {
-         auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>
-                         (std::chrono::steady_clock::now() - sta).count();
-         if (elapsed >= timeout_ms)
-           return ETIMEDOUT;  // 타임아웃 발생
-       }
-
-       if (fails < 1000)
-         fails++;
-       else
-         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+       // deadline이 있는 경우에만 타임아웃 체크
+       if (timed == true && std::chrono::steady_clock::now() >= deadline)
+         return ETIMEDOUT;  // 타임아웃 발생
+
+       wait_idle(strategy, fails);
      }
 
-     --size_;
      return 0;
   }
 
+  // 0 : 정상수신
+  // -1 : 큐 닫힘
+  // 양수 : 타임아웃(ETIMEDOUT)
+  // 잠시 spin 후 EventCount로 대기합니다. 생산자는 대기중인 소비자가 있을때만 깨웁니다.
+  int parked_pop(T &item, const time_point &deadline)
+  {
+    static constexpr uint32_t spin_limit = 100;
+
+    const bool timed = deadline != time_point::max();
+    uint32_t fails = 0;
+    while (true)
+    {
+      if (queue_.pop(item) == true)
+        return 0;
+
+      if (open_.load() == false)
+        return -1;
+
+      int64_t remain = 0;
+      if (timed == true && (remain = remain_ms(deadline)) <= 0)
+        return ETIMEDOUT;
+
+      if (fails < spin_limit)
+      {
+        ++fails;
+        cpu_relax();
+        continue;
+      }
+
+      // 대기 등록 후 다시 확인해야 등록 전에 들어온 push를 놓치지 않는다.
+      uint32_t key = event_.prepare_wait();
+      if (queue_.pop(item) == true)
+      {
+        event_.cancel_wait();
+        return 0;
+      }
+
+      if (open_.load() == false)
+      {
+        event_.cancel_wait();
+        return -1;
+      }
+
+      event_.wait(key, remain);
+    }
+
+    return 0;
+  }
+
+  using backend_t = lockfree_backend<T, Options...>;
+
+  static int64_t backend_size(const BoundedRing<T> &queue, const std::atomic<int64_t> &)
+  {
+    return queue.size();
+  }
+
+  template<typename QUEUE>
+  static int64_t backend_size(const QUEUE &, const std::atomic<int64_t> &size)
+  {
+    return size.load();
+  }
+
+  static bool backend_move_to_node(const BoundedRing<T> &queue, const int &node)
+  {
+    return queue.move_to_node(node);
+  }
+
+  template<typename QUEUE>
+  static bool backend_move_to_node(const QUEUE &, const int &)
+  {
+    return false;
+  }
+
 private:
-  boost::lockfree::queue<T, Options...> queue_;
+  typename backend_t::type queue_;
   MSignal signal_;
+  EventCount event_;
+  EventCount space_;    ///< 큐가 꽉 찼을때 생산자 대기 (wait_space)
   std::atomic<bool> open_{false};
+  std::atomic<wait_strategy_t> strategy_{SIGNALED ? wait_strategy_t::signal : wait_strategy_t::adaptive};
   std::atomic<int64_t> size_{0};
 };
 
@@ -0,0 +1,190 @@
+/*
+ * BoundedRing.h
+ *
+ *  Created on: 2025. 3. 7.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <extra/CpuAffinity.h>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief BlockingLockFreeQueue의 백엔드 선택용 태그.
+ * @details Options의 첫번째 인자로 전달하면 boost::lockfree::queue 대신 BoundedRing을 사용합니다.
+ *
+ * example)
+ *  BlockingLockFreeQueue<false, queueable_str_t, queue_backend::bounded_ring> queue(10000);
+ *  LockFreeQueueThread  <false, queueable_str_t, queue_backend::bounded_ring>
+ */
+namespace queue_backend
+{
+  struct bounded_ring {};
+}
+
+/**
+ * @class BoundedRing
+ * @brief 고정 크기 배열 기반의 lock-free 링버퍼 큐 (Dmitry Vyukov bounded queue)
+ * @tparam T 큐에서 처리할 데이터 타입. boost::lockfree::queue와 마찬가지로 trivially copyable 해야 합니다.
+ * @details
+ * - 각 셀이 sequence 번호를 가지므로 생산자와 소비자는 서로의 카운터(head/tail)를 읽지 않습니다.
+ * - head(소비자)와 tail(생산자) 카운터는 서로 다른 캐시라인에 위치시켜 false sharing을 방지합니다.
+ * - 노드 할당이 없으며 push/pop은 셀 하나만 접근합니다.
+ *
+ * 생산자/소비자 모드
+ *    single_producer(true) : 생산자 쓰레드가 하나인 경우. tail 갱신에 CAS를 사용하지 않습니다.
+ *    single_consumer(true) : 소비자 쓰레드가 하나인 경우. head 갱신에 CAS를 사용하지 않습니다.
+ *    기본값은 MPSC(single_producer = false, single_consumer = true) 입니다.
+ *    모드는 반드시 큐를 사용하기 전(쓰레드 시작 전)에 설정해야 합니다.
+ *
+ * 주의사항
+ * - 용량은 2의 거듭제곱으로 올림됩니다.(10000 -> 16384)
+ */
+template<typename T>
+class BoundedRing
+{
+public:
+  static constexpr size_t cache_line = 64;
+
+  explicit BoundedRing(const size_t &capacity = 10000)
+  : mask_(round_up_pow2(capacity) - 1), cells_(new cell_t[mask_ + 1])
+  {
+    for (size_t index = 0; index <= mask_; ++index)
+      cells_[index].sequence.store(index, std::memory_order_relaxed);
+  }
+
+  BoundedRing(const BoundedRing &) = delete;
+  BoundedRing &operator=(const BoundedRing &) = delete;
+
+  void single_producer(const bool &single) { single_producer_ = single; }
+  void single_consumer(const bool &single) { single_consumer_ = single; }
+
+  bool is_single_producer() const { return single_producer_; }
+  bool is_single_consumer() const { return single_consumer_; }
+
+  // true : 성공, false : 큐 꽉참
+  bool push(const T &item)
+  {
+    cell_t *cell = nullptr;
+    size_t  pos  = tail_.load(std::memory_order_relaxed);
+
+    if (single_producer_ == true)
+    {
+      cell = &cells_[pos & mask_];
+      if (cell->sequence.load(std::memory_order_acquire) != pos)
+        return false;
+      tail_.store(pos + 1, std::memory_order_relaxed);
+    }
+    else
+    {
+      while (true)
+      {
+        cell = &cells_[pos & mask_];
+        intptr_t diff = static_cast<intptr_t>(cell->sequence.load(std::memory_order_acquire))
+                      - static_cast<intptr_t>(pos);
+        if (diff == 0)
+        {
+          if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) == true)
+            break;
+        }
+        else if (diff < 0)
+          return false;
+        else
+          pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->data = item;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // true : 성공, false : 큐 비었음
+  bool pop(T &item)
+  {
+    cell_t *cell = nullptr;
+    size_t  pos  = head_.load(std::memory_order_relaxed);
+
+    if (single_consumer_ == true)
+    {
+      cell = &cells_[pos & mask_];
+      if (cell->sequence.load(std::memory_order_acquire) != pos + 1)
+        return false;
+      head_.store(pos + 1, std::memory_order_relaxed);
+    }
+    else
+    {
+      while (true)
+      {
+        cell = &cells_[pos & mask_];
+        intptr_t diff = static_cast<intptr_t>(cell->sequence.load(std::memory_order_acquire))
+                      - static_cast<intptr_t>(pos + 1);
+        if (diff == 0)
+        {
+          if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) == true)
+            break;
+        }
+        else if (diff < 0)
+          return false;
+        else
+          pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+
+    item = cell->data;
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const
+  {
+    return size() <= 0;
+  }
+
+  /// 생산자/소비자가 동시에 동작중이면 근사값입니다.
+  int64_t size() const
+  {
+    return static_cast<int64_t>(tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_relaxed));
+  }
+
+  size_t capacity() const
+  {
+    return mask_ + 1;
+  }
+
+  /// 셀 배열을 NUMA node로 옮깁니다. 소비자 쓰레드가 고정된 node를 전달합니다. @see CpuAffinity::move_to_node
+  bool move_to_node(const int &node) const
+  {
+    return CpuAffinity::move_to_node(cells_.get(), (mask_ + 1) * sizeof(cell_t), node);
+  }
+
+protected:
+  static size_t round_up_pow2(const size_t &value)
+  {
+    size_t pow2 = 2;
+    while (pow2 < value) pow2 <<= 1;
+    return pow2;
+  }
+
+  struct cell_t
+  {
+    std::atomic<size_t> sequence{0};
+    T                   data;
+  };
+
+protected:
+  const size_t              mask_;
+  std::unique_ptr<cell_t[]> cells_;
+  bool                      single_producer_ = false;
+  bool                      single_consumer_ = true;
+
+  char                      pad0_[cache_line];
+  std::atomic<size_t>       tail_{0};   ///< 생산자 카운터
+  char                      pad1_[cache_line - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t>       head_{0};   ///< 소비자 카운터
+  char                      pad2_[cache_line - sizeof(std::atomic<size_t>)];
+};
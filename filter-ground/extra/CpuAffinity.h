@@ -0,0 +1,290 @@
+/*
+ * CpuAffinity.h
+ *
+ *  Created on: 2025. 3. 17.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+/**
+ * @class CpuAffinity
+ * @brief 쓰레드 CPU 고정(affinity) 정책. NUMA 정보는 sysfs(/sys/devices/system/node)에서 읽습니다.
+ * @details
+ * 설정 문자열(spec)
+ *  ""            : 고정하지 않음 (기본값)
+ *  "0-3,8"       : cpuset. 쓰레드는 목록의 CPU 중 어디서나 실행
+ *  "rr:0-7"      : round-robin. 이 정책으로 시작되는 쓰레드마다 목록의 CPU 하나씩 차례로 고정
+ *  "node:1"      : NUMA node 1의 CPU들
+ *  "same_node"   : 생산자와 같은 NUMA node. same_node_as(생산자 정책)로 생산자가 사용하는 node의 CPU들로 바뀝니다.
+ *                  생산자가 CPU를 지정하지 않았으면 바뀌지 않으며 apply는 실패합니다.(고정하지 않음)
+ *                  쓰레드를 시작하는 쓰레드(보통 main)는 생산자가 아니므로 그 node를 대신 쓰지 않습니다.
+ *
+ * - 복사본은 round-robin 순번을 공유합니다.(같은 설정으로 여러 쓰레드를 시작하는 경우)
+ * - apply는 호출한 쓰레드에 적용합니다. MThread는 run 전에 새 쓰레드에서 호출합니다.
+ *
+ * example)
+ *  CpuAffinity affinity;
+ *  if (CpuAffinity::parse("rr:0-7", affinity) == false) error();
+ *  thread.set_affinity(affinity);
+ *  thread.start();
+ */
+class CpuAffinity
+{
+public:
+  enum class policy_t { none, cpuset, round_robin, same_node };
+
+  CpuAffinity() : next_(std::make_shared<std::atomic<size_t>>(0)) {}
+
+  /**
+   * @brief 설정 문자열 파싱
+   * @return false : 형식 오류 또는 존재하지 않는 node
+   */
+  static bool parse(const std::string &spec, CpuAffinity &out)
+  {
+    CpuAffinity affinity;
+    affinity.spec_ = spec;
+
+    if (spec.empty() == true)
+    {
+      out = affinity;
+      return true;
+    }
+
+    if (spec == "same_node")
+    {
+      affinity.policy_ = policy_t::same_node;
+      out = affinity;
+      return true;
+    }
+
+    if (spec.compare(0, 5, "node:") == 0)
+    {
+      char *end  = nullptr;
+      long  node = std::strtol(spec.c_str() + 5, &end, 10);
+      if (end == spec.c_str() + 5 || *end != '\0' || node < 0)
+        return false;
+
+      affinity.policy_ = policy_t::cpuset;
+      affinity.cpus_   = cpus_of_node(static_cast<int>(node));
+      if (affinity.cpus_.empty() == true)
+        return false;
+
+      out = affinity;
+      return true;
+    }
+
+    std::string list = spec;
+    affinity.policy_ = policy_t::cpuset;
+    if (spec.compare(0, 3, "rr:") == 0)
+    {
+      affinity.policy_ = policy_t::round_robin;
+      list = spec.substr(3);
+    }
+
+    if (parse_cpulist(list, affinity.cpus_) == false || affinity.cpus_.empty() == true)
+      return false;
+
+    out = affinity;
+    return true;
+  }
+
+  /**
+   * @brief same_node 정책을 생산자가 사용하는 NUMA node의 CPU들로 바꿉니다.
+   * @param producer 이 쓰레드에 데이터를 넣는 쓰레드의 정책
+   * @details same_node가 아니거나 생산자의 CPU를 알 수 없으면 그대로 둡니다.(policy()로 확인)
+   */
+  CpuAffinity &same_node_as(const CpuAffinity &producer)
+  {
+    if (policy_ != policy_t::same_node || producer.cpus_.empty() == true)
+      return *this;
+
+    std::set<int> nodes;
+    for (auto &cpu : producer.cpus_)
+      nodes.insert(node_of_cpu(cpu));
+
+    std::vector<int> cpus;
+    for (auto &node : nodes)
+    {
+      auto node_cpus = cpus_of_node(node);
+      cpus.insert(cpus.end(), node_cpus.begin(), node_cpus.end());
+    }
+
+    if (cpus.empty() == false)
+    {
+      policy_ = policy_t::cpuset;
+      cpus_   = cpus;
+    }
+    return *this;
+  }
+
+  /**
+   * @brief 호출한 쓰레드에 적용
+   * @return true : 적용했거나 고정하지 않는 정책, false : 실패 또는 생산자 node를 모르는 same_node
+   */
+  bool apply() const
+  {
+    std::vector<int> cpus;
+    switch (policy_)
+    {
+      case policy_t::none       : return true;
+      case policy_t::cpuset     : cpus = cpus_; break;
+      case policy_t::round_robin: cpus.push_back(cpus_[next_->fetch_add(1) % cpus_.size()]); break;
+      case policy_t::same_node  : return false;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto &cpu : cpus)
+      if (cpu >= 0 && cpu < CPU_SETSIZE)
+        CPU_SET(cpu, &set);
+
+    if (CPU_COUNT(&set) == 0)
+      return false;
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+  }
+
+  bool               empty () const { return policy_ == policy_t::none; }
+  policy_t           policy() const { return policy_; }
+  const std::string &spec  () const { return spec_;   }
+
+public:
+  /// 호출한 쓰레드가 실행중인 NUMA node. 알 수 없으면 -1
+  static int current_node()
+  {
+    int cpu = sched_getcpu();
+    return cpu < 0 ? -1 : node_of_cpu(cpu);
+  }
+
+  /// cpu가 속한 NUMA node. NUMA 정보가 없으면 0
+  static int node_of_cpu(const int &cpu)
+  {
+    for (int node = 0; node < max_nodes; ++node)
+    {
+      std::vector<int> cpus;
+      if (read_node_cpus(node, cpus) == false)
+        continue;
+      for (auto &each : cpus)
+        if (each == cpu)
+          return node;
+    }
+    return 0;
+  }
+
+  /// NUMA node의 CPU 목록. NUMA 정보가 없으면 node 0은 온라인 CPU 전체
+  static std::vector<int> cpus_of_node(const int &node)
+  {
+    std::vector<int> cpus;
+    if (read_node_cpus(node, cpus) == true)
+      return cpus;
+
+    if (node == 0)
+    {
+      long count = sysconf(_SC_NPROCESSORS_ONLN);
+      for (long cpu = 0; cpu < count; ++cpu)
+        cpus.push_back(static_cast<int>(cpu));
+    }
+    return cpus;
+  }
+
+  /**
+   * @brief 메모리를 NUMA node로 옮깁니다.(mbind, MPOL_PREFERRED | MPOL_MF_MOVE)
+   * @details
+   * 페이지 단위로 동작하므로 앞뒤 페이지를 공유하는 다른 데이터도 같이 옮겨집니다.
+   * libnuma 없이 syscall을 직접 호출합니다. NUMA가 아니거나 실패하면 false이며 동작에는 영향이 없습니다.
+   */
+  static bool move_to_node(const void *addr, const size_t &bytes, const int &node)
+  {
+#ifdef SYS_mbind
+    static constexpr int      mpol_preferred = 1;
+    static constexpr unsigned mpol_mf_move   = 1u << 1;
+
+    if (addr == nullptr || bytes == 0 || node < 0 || node >= 64)
+      return false;
+
+    const uintptr_t page  = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(addr) & ~(page - 1);
+    const uintptr_t end   = (reinterpret_cast<uintptr_t>(addr) + bytes + page - 1) & ~(page - 1);
+
+    unsigned long nodemask = 1UL << node;
+    return syscall(SYS_mbind, begin, end - begin, mpol_preferred, &nodemask, 64UL, mpol_mf_move) == 0;
+#else
+    (void)addr; (void)bytes; (void)node;
+    return false;
+#endif
+  }
+
+  /// "0-3,8,10-11" 형식
+  static bool parse_cpulist(const std::string &list, std::vector<int> &cpus)
+  {
+    std::vector<int> result;
+    size_t pos = 0;
+    while (pos < list.size())
+    {
+      size_t comma = list.find(',', pos);
+      std::string item = list.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+      pos = comma == std::string::npos ? list.size() : comma + 1;
+
+      if (item.empty() == true)
+        continue;
+
+      char *end = nullptr;
+      long  sta = std::strtol(item.c_str(), &end, 10);
+      long  fin = sta;
+      if (end == item.c_str())
+        return false;
+      if (*end == '-')
+      {
+        const char *next = end + 1;
+        fin = std::strtol(next, &end, 10);
+        if (end == next)
+          return false;
+      }
+      if (*end != '\0' || sta < 0 || fin < sta || fin >= CPU_SETSIZE)
+        return false;
+
+      for (long cpu = sta; cpu <= fin; ++cpu)
+        result.push_back(static_cast<int>(cpu));
+    }
+
+    cpus = result;
+    return true;
+  }
+
+protected:
+  static constexpr int max_nodes = 64;
+
+  static bool read_node_cpus(const int &node, std::vector<int> &cpus)
+  {
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string   line;
+    if (file.is_open() == false || std::getline(file, line).fail() == true)
+      return false;
+
+    while (line.empty() == false && (line.back() == '\n' || line.back() == ' '))
+      line.pop_back();
+
+    return parse_cpulist(line, cpus);
+  }
+
+protected:
+  policy_t                             policy_ = policy_t::none;
+  std::vector<int>                     cpus_;
+  std::shared_ptr<std::atomic<size_t>> next_;  ///< round-robin 순번. 복사본끼리 공유
+  std::string                          spec_;
+};
@@ -0,0 +1,183 @@
+/*
+ * FieldReflect.h
+ *
+ *  Created on: 2025. 3. 19.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+/**
+ * @file FieldReflect.h
+ * @brief 구조체 필드 목록을 한번만 적어서 인코더/디코더가 같이 사용하는 컴파일 타임 필드 정보
+ * @details
+ * FIELD_REFLECT(구조체, FIELD(필드), ...)로 필드 이름, 멤버 포인터, 이름 해시(컴파일 타임)를 등록합니다.
+ * JSON 코덱은 rapidjson_helper.h 참조 (write_value, add_member, set_value를 자동으로 제공)
+ *
+ * example)
+ *  struct filtering_time_t
+ *  {
+ *    std::string filterName;
+ *    int64_t     startTime;
+ *    int64_t     endTime;
+ *  };
+ *
+ *  FIELD_REFLECT(filtering_time_t,
+ *                FIELD(filterName),
+ *                FIELD(startTime),
+ *                FIELD(endTime));
+ *
+ * - 구조체와 같은 namespace(전역)에서 사용합니다. ADL로 찾습니다.
+ * - 필드는 64개까지 가능합니다.
+ */
+
+/// 필드 이름 해시 (FNV-1a). 컴파일 타임과 실행중 모두 사용
+constexpr uint64_t
+field_key_hash(const char *str, size_t length, uint64_t hash = 0xcbf29ce484222325ULL)
+{
+  return length == 0 ? hash
+                     : field_key_hash(str + 1, length - 1, (hash ^ static_cast<unsigned char>(*str)) * 0x100000001b3ULL);
+}
+
+struct field_key_t
+{
+  const char *name;
+  size_t      length;
+  uint64_t    hash;
+
+  bool equals(const char *str, const size_t &str_length, const uint64_t &str_hash) const
+  {
+    return hash == str_hash && length == str_length && std::memcmp(name, str, length) == 0;
+  }
+};
+
+/// 필드 정보. 이름과 멤버 포인터
+template<typename CLASS, typename T>
+struct field_info_t
+{
+  using value_type = T;
+
+  field_key_t key;
+  T CLASS::*  member;
+};
+
+template<typename CLASS, typename T, size_t N>
+constexpr field_info_t<CLASS, T>
+make_field_info(const char (&name)[N], T CLASS::*member)
+{
+  return field_info_t<CLASS, T>{ field_key_t{ name, N - 1, field_key_hash(name, N - 1) }, member };
+}
+
+#define FIELD(NAME) make_field_info(#NAME, &type::NAME)
+
+#define FIELD_REFLECT(TYPE, ...)                                           \
+  struct TYPE##_field_reflect                                              \
+  {                                                                        \
+    using type = TYPE;                                                     \
+    static auto fields() -> decltype(std::make_tuple(__VA_ARGS__))         \
+    {                                                                      \
+      return std::make_tuple(__VA_ARGS__);                                 \
+    }                                                                      \
+  };                                                                       \
+  inline TYPE##_field_reflect field_reflect(const TYPE *) { return TYPE##_field_reflect(); }
+
+/// FIELD_REFLECT로 등록된 구조체인지
+template<typename T>
+struct is_field_reflected
+{
+  template<typename U> static auto test(int) -> decltype(field_reflect(static_cast<const U *>(nullptr)), std::true_type());
+  template<typename>   static std::false_type test(...);
+
+  static constexpr bool value = decltype(test<T>(0))::value;
+};
+
+/// 필드마다 func(field) 호출
+template<size_t I = 0, typename TUPLE, typename FUNC>
+inline typename std::enable_if<I == std::tuple_size<TUPLE>::value>::type
+for_each_field(const TUPLE &, FUNC &) {}
+
+template<size_t I = 0, typename TUPLE, typename FUNC>
+inline typename std::enable_if<(I < std::tuple_size<TUPLE>::value)>::type
+for_each_field(const TUPLE &fields, FUNC &func)
+{
+  func(std::get<I>(fields));
+  for_each_field<I + 1>(fields, func);
+}
+
+/// index 번째 필드로 func(field) 호출
+template<size_t I = 0, typename TUPLE, typename FUNC>
+inline typename std::enable_if<I == std::tuple_size<TUPLE>::value, bool>::type
+visit_field(const TUPLE &, const size_t &, FUNC &) { return false; }
+
+template<size_t I = 0, typename TUPLE, typename FUNC>
+inline typename std::enable_if<(I < std::tuple_size<TUPLE>::value), bool>::type
+visit_field(const TUPLE &fields, const size_t &index, FUNC &func)
+{
+  if (index != I)
+    return visit_field<I + 1>(fields, index, func);
+
+  func(std::get<I>(fields));
+  return true;
+}
+
+/**
+ * @brief 등록된 구조체의 필드 목록
+ * @details fields()는 처음 호출할때 한번 만들고, keys()는 이름 검색용으로 필드 순서대로 정렬된 배열입니다.
+ */
+template<typename T>
+struct field_reflect_t
+{
+  using reflect_t = decltype(field_reflect(static_cast<const T *>(nullptr)));
+  using fields_t  = decltype(reflect_t::fields());
+
+  static constexpr size_t size = std::tuple_size<fields_t>::value;
+  static_assert(size <= 64, "FIELD_REFLECT supports up to 64 fields");
+
+  static const fields_t &fields()
+  {
+    static const fields_t value = reflect_t::fields();
+    return value;
+  }
+
+  static const field_key_t *keys()
+  {
+    struct keys_t
+    {
+      field_key_t value[size];
+      keys_t() { collect_t collect{value, 0}; for_each_field(fields(), collect); }
+    };
+    static const keys_t keys;
+    return keys.value;
+  }
+
+  /// 이름으로 필드 index 검색. hint부터 찾으므로 필드 순서대로 들어오면 한번에 찾습니다. 없으면 size
+  static size_t find(const char *name, const size_t &length, const size_t &hint = 0)
+  {
+    const uint64_t     hash = field_key_hash(name, length);
+    const field_key_t *all  = keys();
+    for (size_t step = 0; step < size; ++step)
+    {
+      size_t index = (hint + step) % size;
+      if (all[index].equals(name, length, hash) == true)
+        return index;
+    }
+    return size;
+  }
+
+protected:
+  struct collect_t
+  {
+    field_key_t *keys;
+    size_t       index;
+
+    template<typename FIELD> void operator()(const FIELD &field) { keys[index++] = field.key; }
+  };
+};
+
+template<typename T> constexpr size_t field_reflect_t<T>::size;
@@ -0,0 +1,200 @@
+/*
+ * LatencyHistogram.h
+ *
+ *  Created on: 2025. 3. 12.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <extra/ThreadUniqueIndexer.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @class LatencyHistogram
+ * @brief lock-free 지연시간 히스토그램 (HDR 방식의 log-linear 버킷, 단위 us)
+ * @details
+ * - 2의 거듭제곱 구간마다 16개의 선형 버킷을 두므로 상대오차는 최대 1/16(약 6%) 입니다.
+ * - 0us ~ 2^36us(약 19시간)까지 기록하며, 그 이상은 마지막 버킷에 기록합니다.
+ * - record는 쓰레드별(thread_uindex) 샤드의 카운터 하나에 relaxed fetch_add 한번입니다.(락, 할당 없음)
+ * - 값은 누적됩니다. 구간별 통계는 snapshot의 차이(operator-)로 구합니다.
+ *
+ * example)
+ *  LatencyHistogram histogram;
+ *  auto sta = std::chrono::steady_clock::now();
+ *  ...
+ *  histogram.record(sta, std::chrono::steady_clock::now());
+ *
+ *  auto curr = histogram.snapshot();
+ *  auto diff = curr - prev;  // 지난 스냅샷 이후
+ *  diff.percentile(99);      // p99 (us)
+ */
+class LatencyHistogram
+{
+public:
+  static constexpr size_t   shard_count   = 8;    ///< 2의 거듭제곱
+  static constexpr int      sub_bits      = 4;
+  static constexpr uint64_t sub_count     = uint64_t(1) << sub_bits;
+  static constexpr int      max_bits      = 36;
+  static constexpr uint64_t max_value     = (uint64_t(1) << max_bits) - 1;
+  static constexpr size_t   bucket_count  = (max_bits - sub_bits + 1) * sub_count;
+
+  /**
+   * @class snapshot_t
+   * @brief 특정 시점의 버킷 카운트 복사본
+   */
+  class snapshot_t
+  {
+  public:
+    snapshot_t() : counts_(bucket_count, 0) {}
+
+    uint64_t count() const
+    {
+      uint64_t total = 0;
+      for (auto &count : counts_) total += count;
+      return total;
+    }
+
+    /// 백분위 값(us, 버킷 상한). 기록이 없으면 0
+    uint64_t percentile(const double &percent) const
+    {
+      uint64_t total = count();
+      if (total == 0)
+        return 0;
+
+      uint64_t rank = static_cast<uint64_t>(static_cast<double>(total) * percent / 100.0 + 0.5);
+      if (rank < 1)     rank = 1;
+      if (rank > total) rank = total;
+
+      uint64_t sum = 0;
+      for (size_t index = 0; index < bucket_count; ++index)
+        if ((sum += counts_[index]) >= rank)
+          return upper_bound(index);
+
+      return max_value;
+    }
+
+    /// 최대값(us, 버킷 상한)
+    uint64_t max() const
+    {
+      for (size_t index = bucket_count; index > 0; --index)
+        if (counts_[index - 1] > 0)
+          return upper_bound(index - 1);
+      return 0;
+    }
+
+    /// "n=100 p50=120us p99=900us max=1200us". 건수 등 다른 값을 기록한 경우 unit을 바꿉니다.
+    std::string to_string(const char *unit = "us") const
+    {
+      return "n="     + std::to_string(count())
+           + " p50="  + std::to_string(percentile(50)) + unit
+           + " p99="  + std::to_string(percentile(99)) + unit
+           + " max="  + std::to_string(max())          + unit;
+    }
+
+    snapshot_t operator-(const snapshot_t &rhs) const
+    {
+      snapshot_t diff;
+      for (size_t index = 0; index < bucket_count; ++index)
+        diff.counts_[index] = counts_[index] >= rhs.counts_[index] ? counts_[index] - rhs.counts_[index] : 0;
+      return diff;
+    }
+
+  protected:
+    friend class LatencyHistogram;
+    std::vector<uint64_t> counts_;
+  };
+
+public:
+  void record(const uint64_t &micros)
+  {
+    shards_[thread_uindex & (shard_count - 1)].counts[index_of(micros)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void record(const std::chrono::steady_clock::time_point &sta,
+              const std::chrono::steady_clock::time_point &end)
+  {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(end - sta).count();
+    record(micros < 0 ? 0 : static_cast<uint64_t>(micros));
+  }
+
+  /// 시작시간부터 지금까지
+  void record_since(const std::chrono::steady_clock::time_point &sta)
+  {
+    record(sta, std::chrono::steady_clock::now());
+  }
+
+  snapshot_t snapshot() const
+  {
+    snapshot_t result;
+    for (auto &shard : shards_)
+      for (size_t index = 0; index < bucket_count; ++index)
+        result.counts_[index] += shard.counts[index].load(std::memory_order_relaxed);
+    return result;
+  }
+
+  static size_t index_of(uint64_t value)
+  {
+    if (value > max_value) value = max_value;
+    if (value < sub_count) return static_cast<size_t>(value);
+
+    int msb   = 63 - __builtin_clzll(value);
+    int shift = msb - sub_bits;
+    return static_cast<size_t>((msb - sub_bits + 1) * sub_count + ((value >> shift) & (sub_count - 1)));
+  }
+
+  /// 버킷에 포함되는 최대값
+  static uint64_t upper_bound(const size_t &index)
+  {
+    if (index < sub_count) return index;
+
+    int msb   = static_cast<int>(index / sub_count) + sub_bits - 1;
+    int shift = msb - sub_bits;
+    return ((sub_count + index % sub_count + 1) << shift) - 1;
+  }
+
+protected:
+  struct shard_t
+  {
+    std::atomic<uint64_t> counts[bucket_count];
+    char                  pad[64];  ///< 인접 샤드와 캐시라인 분리
+
+    shard_t() { for (auto &count : counts) count.store(0, std::memory_order_relaxed); }
+  };
+
+  shard_t shards_[shard_count];
+};
+
+/**
+ * @class LatencyPercentileProbe
+ * @brief 지난 호출 이후 구간의 백분위 값(us)을 돌려주는 함수객체
+ * @details 복사하면 이전 스냅샷도 복사되므로 호출하는 쓰레드마다 복사본을 사용합니다. (ex. WorkerPool::autoscale_t::wait_probe)
+ *
+ * example)
+ *  std::function<uint64_t()> probe = LatencyPercentileProbe(histogram, 99);
+ *  probe();  // 지난 호출 이후 p99(us)
+ */
+class LatencyPercentileProbe
+{
+public:
+  LatencyPercentileProbe(const LatencyHistogram &histogram, const double &percent)
+  : histogram_(&histogram), percent_(percent), prev_(histogram.snapshot()) {}
+
+  uint64_t operator()()
+  {
+    auto curr = histogram_->snapshot();
+    auto diff = curr - prev_;
+    prev_ = std::move(curr);
+    return diff.percentile(percent_);
+  }
+
+protected:
+  const LatencyHistogram       *histogram_;
+  double                        percent_;
+  LatencyHistogram::snapshot_t  prev_;
+};
@@ -17,6 +17,7 @@
  *
  * 스피닝기반 : 속도가 빠르나 대기시 cpu점유율 5~10% 내외
  * 시그널기반 : 속도가 느리나 대기시 cpu점유율 0%
+ * 템플릿 인자는 기본값이며 set_wait_strategy로 배포환경에 맞게 바꿀 수 있습니다.(busy_spin, spin_yield, backoff, park 등)
  *
  * 아래 예제처럼 push는 직접 구현해야 합니다. 주의해야할 점은 push시 EAGAIN을 리턴하면 큐가 꽉 찬겁니다.
  * 각자 구현에 맞게 처리해야 합니다.
@@ -39,6 +40,13 @@ protected:
       d_log << data;
     }
     // 종료처리.
+
+    // 배치처리 하는 경우
+    // int items[bulk_size];
+    // int count = 0;
+    // while ((count = waiter_.pop_bulk(items, bulk_size)) >= 0)
+    //   for (int index = 0; index < count; ++index)
+    //     d_log << items[index];
   }
 };
 
@@ -59,6 +67,9 @@ template<bool SIGNALED, typename T, typename... Options>
 class LockFreeQueueThread : public MThread
 {
 public:
+  /// run에서 pop_bulk로 한번에 꺼낼 최대 개수 기본값
+  static constexpr size_t bulk_size = 64;
+
   /**
    * @brief LockFreeQueueThread 생성자.
    * @details 주의 큐는 시작시 close한 상태로 시작함.(open = false), start시 open됨.
@@ -72,12 +83,24 @@ public:
   virtual void run  () = 0;
 
   /// 락프리큐 특성상 size는 정확하지 않을 수 있습니다. 음수일 수 도 있습니다.
-  int64_t      size () const { return waiter_.size(); }
+  int64_t      size     () const { return waiter_.size(); }
+  size_t       capacity () const { return waiter_.capacity(); }
+
+  /// 큐가 비었을때의 대기방식. start 전에 설정해야 합니다. @see wait_strategy_t
+  void         set_wait_strategy(const wait_strategy_t &strategy) { waiter_.set_wait_strategy(strategy); }
+  wait_strategy_t wait_strategy() const { return waiter_.wait_strategy(); }
+
+protected:
+  /// 소비자(이 쓰레드)가 고정된 node로 큐 저장공간을 옮깁니다. @see MThread::set_affinity
+  void on_node_bound(const int &node) override { waiter_.move_to_node(node); }
 
 protected:
   BlockingLockFreeQueue<SIGNALED, T, Options...> waiter_; ///< Lock-Free 큐 객체.
 };
 
+template<bool SIGNALED, typename T, typename... Options>
+constexpr size_t LockFreeQueueThread<SIGNALED, T, Options...>::bulk_size;
+
 /**
  * @brief 쓰레드를 시작합니다.
  * @return 성공 시 true, 실패 시 false.
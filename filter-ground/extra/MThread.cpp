@@ -4,6 +4,14 @@
 void
 MThread::executor(MThread *thread)
 {
+  // start가 리턴되기 전에 CPU 고정과 메모리 이동을 마친다.
+  if (thread->affinity_.empty() == false)
+  {
+    if (thread->affinity_.apply() == false)
+      std::cerr << "Failed to set affinity: " << thread->affinity_.spec() << std::endl;
+    thread->on_node_bound(CpuAffinity::current_node());
+  }
+
   thread->run_signal_.notify_one([&]() { thread->run_ = true; } );
   thread->run();
   thread->run_signal_.notify_one([&]() { thread->run_ = false; } );
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MSignal.h"
+#include "CpuAffinity.h"
 #include <thread>
 #include <mutex>
 #include <memory>
@@ -35,10 +36,18 @@ public:
 
   virtual std::string error() const;
 
+  /// @brief CPU 고정 정책. start 전에 설정하며, 새 쓰레드에서 run 전에 적용된다. @see CpuAffinity
+  void                set_affinity(const CpuAffinity &affinity) { affinity_ = affinity; }
+  const CpuAffinity  &affinity() const { return affinity_; }
+
 protected:
   /// @brief 상속받아 구현하여야할 가상함수. 쓰레드가 시작되면 최초로 불려지는 함수
   virtual void run() = 0;
 
+  /// @brief affinity 적용 직후 새 쓰레드에서 호출된다.(start가 리턴되기 전)
+  /// 쓰레드가 사용할 메모리(큐 등)를 node로 옮길때 재정의한다. node를 알 수 없으면 -1
+  virtual void on_node_bound(const int &node) { (void)node; }
+
 protected:
   static  void executor(MThread *thread);
 
@@ -48,6 +57,7 @@ protected:
   mutable std::string thread_hex_;
 
 private:
+  CpuAffinity affinity_;
   std::mutex  lock_;
   bool        start_  = false;
   bool        run_    = false;
@@ -0,0 +1,608 @@
+/*
+ * ShmRing.h
+ *
+ *  Created on: 2025. 3. 24.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <extra/WaitStrategy.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2, "ShmRing requires lock-free atomics in shared memory");
+
+/**
+ * @class ShmRing
+ * @brief 같은 호스트의 프로세스간 공유메모리(shm_open) 링버퍼 (MPMC, Dmitry Vyukov bounded queue)
+ * @details
+ * - /dev/shm/이름 에 헤더와 고정 크기 슬롯 배열을 둡니다. 먼저 연 프로세스가 만들고 초기화합니다.
+ * - 슬롯마다 sequence 번호를 가지므로 생산자와 소비자는 슬롯 하나만 접근합니다.(BoundedRing과 같은 방식)
+ * - 메세지는 슬롯에 복사됩니다. slot_bytes보다 큰 메세지는 /dev/shm/이름~pos 에 따로 쓰고 슬롯에는 크기만 둡니다.(spill)
+ *   소비자가 읽은 후 지웁니다. 파일을 만들고 지우는 비용이 있으므로 slot_bytes는 대부분의 메세지가 들어가는 크기로 정합니다.
+ * - 소비자는 spin 후 공유 futex(SharedEventCount)로 대기하고, 생산자는 대기중인 소비자가 있을때만 깨웁니다.
+ *
+ * 죽은 프로세스 처리 (같은 pid namespace를 가정합니다. 부모가 거두기 전의 좀비는 살아있는 것으로 봅니다)
+ * - 만든 프로세스가 초기화 전에 죽어서 open_wait_ms 동안 초기화되지 않으면 지우고 다시 만듭니다.
+ *   만든 프로세스(creator pid)가 살아있으면 실패합니다.
+ * - 슬롯을 잡은 프로세스의 pid를 슬롯에 둡니다.(복사가 끝나면 0)
+ *   소비자(pop)는 생산자가 잡은 슬롯에서, 생산자(recover_tail)는 소비자가 잡은 슬롯에서 stuck_ms 이상 멈추면
+ *   잡은 프로세스가 죽었을때 그 슬롯을 버리고(dropped) 진행합니다. 살아있으면 EBUSY를 한번 알리고 계속 기다립니다.
+ * - pid는 슬롯을 잡는 CAS 다음에 씁니다. 그 사이에 멈춘 슬롯(owner 0)은 누가 잡았는지 알 수 없으므로
+ *   claim_grace_ms 동안은 살아있는 것으로 봅니다. 살아있는 프로세스가 그 사이에 선점된 경우 슬롯을 빼앗으면
+ *   나중에 release가 sequence를 되돌리므로, 선점보다 충분히 긴 시간으로 둡니다.
+ *
+ * 주의사항
+ * - 슬롯 수는 2의 거듭제곱으로 올림됩니다. 이미 있으면 만든 프로세스의 크기를 사용합니다.
+ * - 프로세스가 끝나도 남아있으므로 남은 메세지는 다음 소비자가 받습니다. 크기를 바꾸려면 unlink 후 다시 만듭니다.
+ * - 슬롯에 두는 pid는 open 할때의 값입니다. fork 한 자식 프로세스는 다시 open 합니다.
+ *
+ * example)
+ *  ShmRing     ring;
+ *  std::string error;
+ *  if (ring.open("sfs.auth", 8192, 8192, error) == false) ...
+ *  ring.try_push(message.data(), message.size());  // 0, EAGAIN(꽉참), 그 외 errno(spill 실패)
+ *  ring.pop(message, 100);                          // 0, ETIMEDOUT, EBUSY, EOWNERDEAD
+ */
+class ShmRing
+{
+public:
+  static constexpr size_t   cache_line = 64;
+  static constexpr uint32_t magic      = 0x53524E47;  ///< "SRNG"
+  static constexpr uint32_t version    = 2;
+  static constexpr uint32_t spin_limit = 1000;        ///< pop 대기전 spin 횟수
+  static constexpr int64_t  open_wait_ms = 1000;      ///< 다른 프로세스가 초기화중일때 최대 대기시간
+  static constexpr int64_t  stuck_ms     = 1000;      ///< 잡힌 슬롯에서 이만큼 멈추면 잡은 프로세스를 확인
+  static constexpr int64_t  claim_grace_ms = 60000;   ///< pid를 쓰기 전(owner 0)인 슬롯은 이만큼 멈춰야 죽은 것으로 봄
+
+  ShmRing() = default;
+  ~ShmRing() { close(); }
+
+  ShmRing(const ShmRing &) = delete;
+  ShmRing &operator=(const ShmRing &) = delete;
+
+  /**
+   * @brief 링을 열거나 없으면 만듭니다.
+   * @param name /dev/shm 아래의 이름 ('/' 제외)
+   * @param slots 만들때의 슬롯 수
+   * @param slot_bytes 만들때의 슬롯당 메세지 크기. 큰 메세지는 spill 합니다.
+   * @param error 실패 사유
+   * @return 성공 여부
+   */
+  bool open(const std::string &name, const size_t &slots, const size_t &slot_bytes, std::string &error)
+  {
+    int res = open_once(name, slots, slot_bytes, error);
+    if (res == ESTALE)  // 초기화 전에 죽은 프로세스가 남긴 공유메모리를 지웠으므로 다시 만든다.
+      res = open_once(name, slots, slot_bytes, error);
+    return res == 0;
+  }
+
+  void close()
+  {
+    if (base_ != nullptr)
+      munmap(base_, length_);
+
+    base_   = nullptr;
+    length_ = 0;
+    header_ = nullptr;
+  }
+
+  /// 공유메모리 삭제. 이미 열려있는 프로세스는 close 할때까지 계속 사용합니다.
+  static bool unlink(const std::string &name)
+  {
+    return shm_unlink(("/" + name).c_str()) == 0;
+  }
+
+  bool is_open() const { return header_ != nullptr; }
+
+  /**
+   * @brief 메세지를 슬롯에 복사합니다.(slot_bytes보다 크면 spill) 대기중인 소비자가 있으면 깨웁니다.
+   * @return 0 : 성공, EAGAIN : 꽉참, 그 외 : spill 실패 errno (슬롯은 소비자가 건너뜀)
+   */
+  int try_push(const char *data, const size_t &size)
+  {
+    uint64_t pos  = 0;
+    slot_t  *slot = claim(header_->tail, pos, 0);
+    if (slot == nullptr)
+      return EAGAIN;
+
+    int res = 0;
+    if (size <= header_->slot_bytes)
+    {
+      slot->kind = kind_inline;
+      std::memcpy(data_of(slot), data, size);
+    }
+    else
+      slot->kind = (res = write_spill(pos, data, size)) == 0 ? kind_spilled : kind_abandoned;
+
+    slot->size = size;
+    release(slot, pos + 1);
+
+    header_->not_empty.notify();
+    return res;
+  }
+
+  /// true : 성공, false : 비었음
+  bool try_pop(std::string &out)
+  {
+    while (true)
+    {
+      uint64_t pos  = 0;
+      slot_t  *slot = claim(header_->head, pos, 1);
+      if (slot == nullptr)
+        return false;
+
+      bool taken = take(slot, pos, out);
+      release(slot, pos + header_->slots);
+      if (taken == true)
+        return true;
+    }
+  }
+
+  /**
+   * @brief 꺼낼때까지 spin_limit 만큼 spin 후 timeout_ms 동안 futex로 대기
+   * @return 0 : 성공, ETIMEDOUT : 시간초과 또는 wake_all,
+   *         EBUSY : 살아있는 생산자가 stuck_ms 이상 슬롯을 잡고 있음(슬롯마다 한번),
+   *         EOWNERDEAD : 죽은 생산자가 잡은 슬롯을 버림
+   */
+  int pop(std::string &out, const int64_t &timeout_ms)
+  {
+    for (uint32_t spin = 0; spin < spin_limit; ++spin)
+    {
+      if (try_pop(out) == true)
+        return 0;
+      cpu_relax();
+    }
+
+    uint32_t key = header_->not_empty.prepare_wait();
+    if (try_pop(out) == true)
+    {
+      header_->not_empty.cancel_wait();
+      return 0;
+    }
+    header_->not_empty.wait(key, timeout_ms);
+
+    if (try_pop(out) == true)
+      return 0;
+
+    int res = recover_head();
+    return res == 0 ? ETIMEDOUT : res;
+  }
+
+  /**
+   * @brief 소비자가 잡은 채 멈춘 슬롯 확인. 생산자가 꽉참(EAGAIN)으로 기다리는 동안 주기적으로 호출합니다.
+   * @return 0 : 없음, EBUSY : 살아있는 소비자가 stuck_ms 이상 슬롯을 잡고 있음(슬롯마다 한번),
+   *         EOWNERDEAD : 죽은 소비자가 잡은 슬롯을 풀어줌
+   */
+  int recover_tail()
+  {
+    const uint64_t pos = header_->tail.load(std::memory_order_acquire);
+    if (pos < header_->slots)
+      return 0;
+
+    slot_t  *slot     = slot_at(pos);
+    uint64_t consumed = pos - header_->slots + 1;  ///< 한바퀴 전 소비자가 잡은 상태의 sequence
+    bool     claimed  = slot->sequence.load(std::memory_order_acquire) == consumed
+                     && header_->head.load(std::memory_order_acquire) > pos - header_->slots;
+
+    int res = stalled(push_stuck_, pos, claimed, slot);
+    if (res != EOWNERDEAD)
+      return res;
+
+    slot->owner.store(0, std::memory_order_relaxed);
+    if (slot->sequence.compare_exchange_strong(consumed, pos, std::memory_order_release) == false)
+      return 0;
+
+    shm_unlink(spill_path(pos - header_->slots).c_str());
+    header_->dropped.fetch_add(1, std::memory_order_relaxed);
+    return EOWNERDEAD;
+  }
+
+  /// pop 대기중인 모든 소비자를 깨웁니다.(종료시)
+  void wake_all() { header_->not_empty.notify_all(); }
+
+  /// 생산자/소비자가 동시에 동작중이면 근사값입니다.
+  int64_t size() const
+  {
+    return static_cast<int64_t>(header_->tail.load(std::memory_order_relaxed) - header_->head.load(std::memory_order_relaxed));
+  }
+
+  size_t   capacity  () const { return header_->slots;      }
+  size_t   slot_bytes() const { return header_->slot_bytes; }
+  uint64_t dropped   () const { return header_->dropped.load(std::memory_order_relaxed); }  ///< 모든 프로세스 합계
+
+  const std::string &name() const { return name_; }
+
+protected:
+  /// 슬롯의 메세지 위치
+  enum slot_kind_t : uint32_t
+  {
+    kind_inline    = 0,   ///< 슬롯 안
+    kind_spilled   = 1,   ///< /dev/shm/이름~pos
+    kind_abandoned = 2,   ///< spill 실패. 생산자가 에러를 리턴했으므로 소비자는 건너뜀
+  };
+
+  struct header_t
+  {
+    std::atomic<uint32_t> ready;        ///< 초기화가 끝나면 magic
+    uint32_t              version;
+    uint64_t              slots;
+    uint64_t              slot_bytes;
+    uint64_t              stride;       ///< 슬롯 간격 (slot_t + slot_bytes, 캐시라인 올림)
+    std::atomic<int32_t>  creator;      ///< 만든 프로세스 pid
+    uint32_t              reserved;
+    std::atomic<uint64_t> dropped;      ///< 죽은 프로세스가 잡고 있어서 버린 슬롯과 읽지 못한 spill 수
+    char                  pad0_[cache_line - 48];
+    std::atomic<uint64_t> tail;         ///< 생산자 카운터
+    char                  pad1_[cache_line - sizeof(std::atomic<uint64_t>)];
+    std::atomic<uint64_t> head;         ///< 소비자 카운터
+    char                  pad2_[cache_line - sizeof(std::atomic<uint64_t>)];
+    SharedEventCount      not_empty;    ///< 소비자 대기
+    char                  pad3_[cache_line - sizeof(SharedEventCount)];
+  };
+
+  struct slot_t
+  {
+    std::atomic<uint64_t> sequence;
+    uint64_t              size;
+    std::atomic<int32_t>  owner;        ///< 잡고 있는 프로세스 pid. 풀때 0
+    uint32_t              kind;         ///< slot_kind_t
+  };
+
+  /// 한 슬롯에서 멈춘 상태 (ShmRing 객체마다, 생산자/소비자 방향별)
+  struct stuck_t
+  {
+    bool                                  seen     = false;
+    bool                                  reported = false;
+    uint64_t                              pos      = 0;
+    std::chrono::steady_clock::time_point since;
+  };
+
+  int open_once(const std::string &name, const size_t &slots, const size_t &slot_bytes, std::string &error)
+  {
+    close();
+
+    const std::string path = "/" + name;
+    int  fd      = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+    bool creator = fd >= 0;
+    if (creator == false && errno == EEXIST)
+      fd = shm_open(path.c_str(), O_RDWR, 0);
+    if (fd < 0)
+      return fail(error, "shm_open " + path + ": " + strerror(errno));
+
+    size_t length = 0;
+    if (creator == true)
+    {
+      length = mapped_size(round_up_pow2(slots), stride_of(slot_bytes));
+      if (ftruncate(fd, static_cast<off_t>(length)) != 0)
+      {
+        std::string reason = strerror(errno);
+        ::close(fd);
+        shm_unlink(path.c_str());
+        return fail(error, "ftruncate " + path + ": " + reason);
+      }
+    }
+    else
+    {
+      // 만든 프로세스가 ftruncate 할때까지 기다린다.
+      struct stat st;
+      bool sized = wait_for([&]() { return fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(header_t); });
+      if (sized == false)
+        return stale(fd, path, error, "shm not sized: " + path);
+      length = static_cast<size_t>(st.st_size);
+    }
+
+    void *base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+    {
+      std::string reason = strerror(errno);
+      ::close(fd);
+      return fail(error, "mmap " + path + ": " + reason);
+    }
+
+    base_   = static_cast<char *>(base);
+    length_ = length;
+    header_ = reinterpret_cast<header_t *>(base_);
+    name_   = name;
+    pid_    = getpid();
+
+    if (creator == true)
+    {
+      ::close(fd);
+      init(round_up_pow2(slots), slot_bytes);
+      return 0;
+    }
+
+    // 만든 프로세스가 초기화를 끝낼때까지 기다린다.
+    if (wait_for([&]() { return header_->ready.load(std::memory_order_acquire) == magic; }) == false)
+    {
+      int32_t creator_pid = header_->creator.load(std::memory_order_acquire);
+      if (creator_pid == 0 || alive(creator_pid) == false)
+        return stale(fd, path, error, "shm not initialized: " + path);
+
+      ::close(fd);
+      return fail(error, "shm not initialized: " + path + " (creator pid " + std::to_string(creator_pid) + " alive)");
+    }
+    ::close(fd);
+
+    if (header_->version != version || mapped_size(header_->slots, header_->stride) != length_)
+      return fail(error, "shm layout mismatch: " + path);
+
+    return 0;
+  }
+
+  /// 초기화 전에 만든 프로세스가 죽은 공유메모리. 아직 같은 파일이면 지우고 ESTALE(open이 다시 만듦)
+  int stale(const int &fd, const std::string &path, std::string &error, const std::string &reason)
+  {
+    struct stat opened, current;
+    if (fstat(fd, &opened) == 0 && stat(("/dev/shm" + path).c_str(), &current) == 0 && opened.st_ino == current.st_ino)
+      shm_unlink(path.c_str());
+    ::close(fd);
+
+    fail(error, reason + " (stale, removed)");
+    return ESTALE;
+  }
+
+  static bool alive(const int32_t &pid)
+  {
+    return kill(pid, 0) == 0 || errno != ESRCH;
+  }
+
+  static size_t round_up_pow2(const size_t &value)
+  {
+    size_t pow2 = 2;
+    while (pow2 < value) pow2 <<= 1;
+    return pow2;
+  }
+
+  static size_t stride_of(const size_t &slot_bytes)
+  {
+    return (sizeof(slot_t) + slot_bytes + cache_line - 1) / cache_line * cache_line;
+  }
+
+  static size_t mapped_size(const size_t &slots, const size_t &stride)
+  {
+    return sizeof(header_t) + slots * stride;
+  }
+
+  /// ftruncate로 0이 채워진 공유메모리를 초기화합니다. ready는 마지막에 설정합니다.
+  void init(const size_t &slots, const size_t &slot_bytes)
+  {
+    new (header_) header_t();
+    header_->creator.store(pid_, std::memory_order_relaxed);
+    header_->version    = version;
+    header_->slots      = slots;
+    header_->slot_bytes = slot_bytes;
+    header_->stride     = stride_of(slot_bytes);
+    header_->tail.store(0, std::memory_order_relaxed);
+    header_->head.store(0, std::memory_order_relaxed);
+
+    for (uint64_t index = 0; index < slots; ++index)
+      new (slot_at(index)) slot_t();
+    for (uint64_t index = 0; index < slots; ++index)
+      slot_at(index)->sequence.store(index, std::memory_order_relaxed);
+
+    header_->ready.store(magic, std::memory_order_release);
+  }
+
+  /**
+   * @brief counter(tail/head)의 슬롯을 잡고 pid를 기록합니다.(Vyukov)
+   * @param offset 잡을 수 있는 sequence - pos (생산자 0, 소비자 1)
+   * @return 비었거나 꽉 찼으면 nullptr
+   */
+  slot_t *claim(std::atomic<uint64_t> &counter, uint64_t &pos, const uint64_t &offset)
+  {
+    pos = counter.load(std::memory_order_relaxed);
+    while (true)
+    {
+      slot_t  *slot = slot_at(pos);
+      intptr_t diff = static_cast<intptr_t>(slot->sequence.load(std::memory_order_acquire))
+                    - static_cast<intptr_t>(pos + offset);
+      if (diff == 0)
+      {
+        if (counter.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) == true)
+        {
+          slot->owner.store(pid_, std::memory_order_relaxed);
+          return slot;
+        }
+      }
+      else if (diff < 0)
+        return nullptr;
+      else
+        pos = counter.load(std::memory_order_relaxed);
+    }
+  }
+
+  static void release(slot_t *slot, const uint64_t &sequence)
+  {
+    slot->owner.store(0, std::memory_order_relaxed);
+    slot->sequence.store(sequence, std::memory_order_release);
+  }
+
+  /// 잡은 슬롯의 메세지를 꺼냅니다. false이면 건너뜁니다.
+  bool take(slot_t *slot, const uint64_t &pos, std::string &out)
+  {
+    switch (slot->kind)
+    {
+      case kind_inline:
+        out.assign(data_of(slot), slot->size);
+        return true;
+
+      case kind_spilled:
+        if (read_spill(pos, slot->size, out) == true)
+          return true;
+        header_->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+
+      default:
+        return false;
+    }
+  }
+
+  /// 생산자가 잡은 채 멈춘 head 슬롯 확인 (pop이 꺼내지 못했을때)
+  int recover_head()
+  {
+    const uint64_t pos     = header_->head.load(std::memory_order_acquire);
+    slot_t        *slot    = slot_at(pos);
+    bool           claimed = slot->sequence.load(std::memory_order_acquire) == pos
+                          && header_->tail.load(std::memory_order_acquire) > pos;
+
+    int res = stalled(pop_stuck_, pos, claimed, slot);
+    if (res != EOWNERDEAD)
+      return res;
+
+    uint64_t expected = pos;
+    if (header_->head.compare_exchange_strong(expected, pos + 1, std::memory_order_relaxed) == false)
+      return 0;
+
+    shm_unlink(spill_path(pos).c_str());
+    header_->dropped.fetch_add(1, std::memory_order_relaxed);
+    release(slot, pos + header_->slots);
+    return EOWNERDEAD;
+  }
+
+  /**
+   * @brief pos 슬롯이 잡힌 채(claimed) stuck_ms 이상 같은 상태인지 확인
+   * @return 0 : 아님, EBUSY : 잡은 프로세스가 살아있음(처음 한번), EOWNERDEAD : 잡은 프로세스가 죽음
+   * @details owner가 0이면 슬롯을 잡은 직후 pid를 쓰기 전입니다. claim_grace_ms 이상 그대로일때만 죽은 것으로 봅니다.
+   */
+  static int stalled(stuck_t &stuck, const uint64_t &pos, const bool &claimed, const slot_t *slot)
+  {
+    const int64_t timeout_ms = stuck_ms;
+    const auto    now        = std::chrono::steady_clock::now();
+    if (claimed == false || stuck.seen == false || stuck.pos != pos)
+    {
+      stuck.seen     = claimed;
+      stuck.reported = false;
+      stuck.pos      = pos;
+      stuck.since    = now;
+      return 0;
+    }
+
+    if (now - stuck.since < std::chrono::milliseconds(timeout_ms))
+      return 0;
+
+    int32_t owner = slot->owner.load(std::memory_order_relaxed);
+    bool    held  = owner == 0 ? now - stuck.since < std::chrono::milliseconds(claim_grace_ms) : alive(owner);
+    if (held == true)
+    {
+      if (stuck.reported == true)
+        return 0;
+      stuck.reported = true;
+      return EBUSY;
+    }
+
+    stuck.seen = false;
+    return EOWNERDEAD;
+  }
+
+  std::string spill_path(const uint64_t &pos) const
+  {
+    return "/" + name_ + "~" + std::to_string(pos);
+  }
+
+  /// tmpfs가 꽉 차면 mmap 쓰기는 SIGBUS 이므로 write로 씁니다.
+  int write_spill(const uint64_t &pos, const char *data, const size_t &size) const
+  {
+    const std::string path = spill_path(pos);
+    int fd = shm_open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0660);
+    if (fd < 0)
+      return errno;
+
+    int res = 0;
+    for (size_t done = 0; done < size; )
+    {
+      ssize_t written = ::write(fd, data + done, size - done);
+      if (written < 0 && errno == EINTR)
+        continue;
+      if (written <= 0)
+      {
+        res = written < 0 ? errno : ENOSPC;
+        break;
+      }
+      done += static_cast<size_t>(written);
+    }
+
+    ::close(fd);
+    if (res != 0)
+      shm_unlink(path.c_str());
+    return res;
+  }
+
+  bool read_spill(const uint64_t &pos, const size_t &size, std::string &out) const
+  {
+    const std::string path = spill_path(pos);
+    int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+      return false;
+
+    out.resize(size);
+    size_t done = 0;
+    while (done < size)
+    {
+      ssize_t count = ::read(fd, &out[done], size - done);
+      if (count < 0 && errno == EINTR)
+        continue;
+      if (count <= 0)
+        break;
+      done += static_cast<size_t>(count);
+    }
+
+    ::close(fd);
+    shm_unlink(path.c_str());
+    return done == size;
+  }
+
+  slot_t *slot_at(const uint64_t &pos) const
+  {
+    return reinterpret_cast<slot_t *>(base_ + sizeof(header_t) + (pos & (header_->slots - 1)) * header_->stride);
+  }
+
+  static char *data_of(slot_t *slot)
+  {
+    return reinterpret_cast<char *>(slot) + sizeof(slot_t);
+  }
+
+  template<typename FUNC>
+  static bool wait_for(FUNC done)
+  {
+    const int64_t timeout_ms = open_wait_ms;
+    const auto    deadline   = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (done() == false)
+    {
+      if (std::chrono::steady_clock::now() >= deadline)
+        return false;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+  }
+
+  int fail(std::string &error, const std::string &reason)
+  {
+    close();
+    error = reason;
+    return -1;
+  }
+
+protected:
+  char       *base_   = nullptr;
+  size_t      length_ = 0;
+  header_t   *header_ = nullptr;
+  std::string name_;
+  int32_t     pid_    = 0;
+
+  stuck_t     pop_stuck_;
+  stuck_t     push_stuck_;
+};
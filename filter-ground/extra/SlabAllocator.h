@@ -0,0 +1,155 @@
+/*
+ * SlabAllocator.h
+ *
+ *  Created on: 2025. 3. 4.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <extra/CpuAffinity.h>
+#include <boost/lockfree/stack.hpp>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @class SlabArena
+ * @brief 고정 크기 블럭을 미리 할당해두고 재사용하는 thread-safe 메모리 풀.
+ * @details
+ * - 생성시 block_size * block_count 만큼의 메모리를 한번에 할당합니다.
+ *   (페이지는 실제로 사용될때 커널이 매핑하므로 RSS는 사용한 만큼만 증가합니다.)
+ * - 빈 블럭 목록은 boost::lockfree::stack(fixed_sized)으로 관리하므로
+ *   allocate/deallocate 모두 락과 힙 할당이 없습니다.
+ * - LIFO로 재사용하므로 최근 반환된(캐시에 남아있는) 블럭이 먼저 사용됩니다.
+ * - 블럭이 모두 사용중이거나 요청 크기가 블럭보다 크면 ::operator new로 대체합니다.(misses 증가)
+ *
+ * 주의사항
+ * - boost::lockfree fixed_sized 특성상 block_count는 65535를 넘을 수 없습니다.(넘으면 잘라냄)
+ */
+class SlabArena
+{
+public:
+  static constexpr size_t cache_line  = 64;
+  static constexpr size_t max_blocks  = 65535;
+
+  SlabArena(const size_t &block_size, const size_t &block_count)
+  : block_size_ (round_up(block_size < sizeof(void *) ? sizeof(void *) : block_size)),
+    block_count_(block_count > max_blocks ? max_blocks : block_count),
+    buffer_     (new char[block_size_ * block_count_ + cache_line]),
+    free_       (block_count_)
+  {
+    // 블럭 시작 주소를 캐시라인에 정렬. 인접 블럭간 false sharing 방지.
+    uintptr_t addr = reinterpret_cast<uintptr_t>(buffer_.get());
+    begin_ = reinterpret_cast<char *>((addr + cache_line - 1) & ~(uintptr_t)(cache_line - 1));
+    end_   = begin_ + block_size_ * block_count_;
+
+    for (size_t index = 0; index < block_count_; ++index)
+      free_.bounded_push(begin_ + index * block_size_);
+  }
+
+  SlabArena(const SlabArena &) = delete;
+  SlabArena &operator=(const SlabArena &) = delete;
+
+  void *allocate(const size_t &bytes)
+  {
+    void *block = nullptr;
+    if (bytes <= block_size_ && free_.pop(block) == true)
+      return block;
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(bytes);
+  }
+
+  void deallocate(void *block)
+  {
+    if (owns(block) == false)
+    {
+      ::operator delete(block);
+      return;
+    }
+
+    free_.bounded_push(block);
+  }
+
+  bool owns(const void *block) const
+  {
+    return block >= begin_ && block < end_;
+  }
+
+  size_t    block_size  () const { return block_size_;  }
+  size_t    block_count () const { return block_count_; }
+
+  /// 블럭 메모리를 NUMA node로 옮깁니다. @see CpuAffinity::move_to_node
+  bool      move_to_node(const int &node) const { return CpuAffinity::move_to_node(begin_, end_ - begin_, node); }
+
+  /// 풀에서 블럭을 얻지 못해 힙 할당으로 대체된 횟수
+  uint64_t  misses      () const { return misses_.load(std::memory_order_relaxed); }
+
+protected:
+  static size_t round_up(const size_t &size)
+  {
+    return (size + cache_line - 1) & ~(cache_line - 1);
+  }
+
+protected:
+  const size_t            block_size_;
+  const size_t            block_count_;
+  std::unique_ptr<char[]> buffer_;
+  char                   *begin_ = nullptr;
+  char                   *end_   = nullptr;
+
+  boost::lockfree::stack<void *, boost::lockfree::fixed_sized<true>> free_;
+  std::atomic<uint64_t>   misses_{0};
+};
+
+/**
+ * @class SlabAllocator
+ * @brief SlabArena를 사용하는 표준 allocator.
+ * @details
+ * std::allocate_shared와 함께 사용하면 shared_ptr의 control block과 객체가
+ * 하나의 slab 블럭에 생성되므로 힙 할당 없이 shared_ptr을 만들 수 있습니다.
+ *
+ * allocator는 arena를 포인터로만 참조합니다.(복사시 레퍼런스 카운팅 비용을 없애기 위함)
+ * 따라서 arena는 이 allocator로 만든 모든 shared_ptr보다 오래 살아있어야 합니다.
+ *
+ * example)
+ *  SlabArena arena(256, 10000);
+ *  auto sptr = std::allocate_shared<std::string>(SlabAllocator<std::string>(&arena), "abcd");
+ */
+template<typename T>
+class SlabAllocator
+{
+public:
+  using value_type = T;
+
+  template<typename U> struct rebind { using other = SlabAllocator<U>; };
+
+  explicit SlabAllocator(SlabArena *arena) : arena_(arena) {}
+
+  template<typename U>
+  SlabAllocator(const SlabAllocator<U> &rhs) : arena_(rhs.arena()) {}
+
+  T *allocate(const size_t &n)
+  {
+    return static_cast<T *>(arena_->allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T *ptr, const size_t &n)
+  {
+    (void)n;
+    arena_->deallocate(ptr);
+  }
+
+  SlabArena *arena() const { return arena_; }
+
+protected:
+  SlabArena *arena_ = nullptr;
+};
+
+template<typename T, typename U> bool
+operator==(const SlabAllocator<T> &lhs, const SlabAllocator<U> &rhs) { return lhs.arena() == rhs.arena(); }
+
+template<typename T, typename U> bool
+operator!=(const SlabAllocator<T> &lhs, const SlabAllocator<U> &rhs) { return lhs.arena() != rhs.arena(); }
@@ -0,0 +1,61 @@
+/*
+ * TokenBucket.h
+ *
+ *  Created on: 2025. 3. 13.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @class TokenBucket
+ * @brief lock-free 유입 제어(admission control) 클래스. GCRA(Generic Cell Rate Algorithm) 방식
+ * @details
+ * - 초당 rate개, 최대 burst개까지 연속 허용하는 토큰버킷과 같습니다.
+ * - 상태는 다음 허용 예정시간(TAT, ns) atomic 하나뿐이므로 try_acquire는 CAS 한번입니다.(락, 할당 없음)
+ * - rate/burst는 호출시마다 전달하므로 설정이 실행중에 바뀌어도 바로 적용됩니다.
+ * - 카운트 기반(1초간 건수 >= 임계치)과 달리 임계치를 넘어도 rate만큼은 계속 통과하므로
+ *   남은 1초 동안 모두 버려지는 현상이 없습니다.
+ *
+ * example)
+ *  TokenBucket bucket;
+ *  if (bucket.try_acquire(1000, 100) == false)  // 초당 1000건, 순간 100건
+ *    discard();
+ */
+class TokenBucket
+{
+public:
+  /**
+   * @param rate 초당 허용 건수. 0이면 모두 거절
+   * @param burst 연속으로 허용할 최대 건수. 0이면 rate(1초분량)
+   * @return true : 허용, false : 거절
+   */
+  bool try_acquire(const uint32_t &rate, const uint32_t &burst = 0)
+  {
+    if (rate == 0)
+      return false;
+
+    const int64_t interval = 1000000000LL / rate;
+    const int64_t limit    = interval * static_cast<int64_t>(burst == 0 ? rate : burst);
+    const int64_t now      = std::chrono::duration_cast<std::chrono::nanoseconds>
+                             (std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    int64_t tat = tat_.load(std::memory_order_relaxed);
+    while (true)
+    {
+      int64_t next = (tat > now ? tat : now) + interval;
+      if (next - now > limit)
+        return false;
+
+      if (tat_.compare_exchange_weak(tat, next, std::memory_order_relaxed) == true)
+        return true;
+    }
+  }
+
+protected:
+  std::atomic<int64_t> tat_{0};  ///< theoretical arrival time(ns, steady_clock)
+};
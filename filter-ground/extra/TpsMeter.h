@@ -7,43 +7,197 @@
 
 #pragma once
 
+#include <extra/ThreadUniqueIndexer.h>
+#include <atomic>
 #include <chrono>
-#include <set>
-#include <mutex>
+#include <cstdint>
+#include <cstddef>
 
-class TpsMeter
+/**
+ * @class RateMeter
+ * @brief 최근 BUCKET_MS * BUCKET_COUNT 구간의 트랜잭션 수를 측정하는 lock-free 클래스
+ * @tparam BUCKET_MS 버킷 하나의 시간(ms)
+ * @tparam BUCKET_COUNT 버킷 수. 구간 = BUCKET_MS * BUCKET_COUNT
+ * @details
+ * - 구간을 BUCKET_MS 버킷 BUCKET_COUNT개의 링으로 나누어 집계합니다.(sliding window, BUCKET_MS 단위)
+ * - 버킷은 쓰레드별(thread_uindex)로 샤딩되어 있어 쓰레드간 캐시라인 경합이 없습니다.
+ * - 버킷 하나는 (tick << 24 | count) 형태의 64bit atomic 입니다. tick이 다르면 만료된 버킷이므로
+ *   새 tick으로 덮어쓰며, 정리 작업과 메모리 할당이 없습니다.
+ * - get_count는 지난 버킷의 합을 tick마다 한번만 계산하여 캐시하고, 현재 버킷만 샤드별로 더합니다.
+ *   모든 샤드를 읽으므로 기록 경로(add, TpsMeter::add_transaction)에서는 호출하지 않습니다.
+ *
+ * 주의사항
+ * - 버킷당 최대 16,777,215건, 샤드 수를 넘는 쓰레드는 샤드를 공유합니다.(CAS로 처리되므로 정확성은 같음)
+ */
+template<int64_t BUCKET_MS, size_t BUCKET_COUNT>
+class RateMeter
 {
 public:
-  // return tps
-  size_t add_transaction()
+  static constexpr size_t   shard_count   = 16;   ///< 2의 거듭제곱
+  static constexpr size_t   bucket_count  = BUCKET_COUNT;
+  static constexpr int64_t  bucket_ms     = BUCKET_MS;
+  static constexpr int64_t  window_ms     = BUCKET_MS * static_cast<int64_t>(BUCKET_COUNT);
+
+  /// @return 기록한 버킷값 (tick << 24 | 현재 쓰레드 샤드의 버킷 건수)
+  uint64_t add()
   {
-    std::lock_guard<std::mutex> guard(mutex_);
-    transactions_.insert(std::chrono::system_clock::now());
-    return get_tps_nolock();
+    const uint64_t tick = now_tick();
+    std::atomic<uint64_t> &bucket = shards_[thread_uindex & (shard_count - 1)].buckets[tick % bucket_count];
+
+    uint64_t old_value = bucket.load(std::memory_order_relaxed);
+    uint64_t new_value = 0;
+    do
+    {
+      new_value = (bucket_tick(old_value) == tick) ? old_value + 1 : pack(tick, 1);
+    } while (bucket.compare_exchange_weak(old_value, new_value, std::memory_order_relaxed) == false);
+    return new_value;
   }
 
-  size_t get_tps()
+  /// 구간내 트랜잭션 수
+  size_t get_count()
   {
-    std::lock_guard<std::mutex> guard(mutex_);
-    return get_tps_nolock();
+    return get_count(now_tick());
+  }
+
+  /// 구간내 초당 평균
+  double get_rate()
+  {
+    return static_cast<double>(get_count()) * 1000.0 / static_cast<double>(window_ms);
   }
 
 protected:
-  size_t get_tps_nolock()
+  static constexpr int      count_bits  = 24;
+  static constexpr uint64_t count_mask  = (uint64_t(1) << count_bits) - 1;
+
+  static uint64_t pack          (const uint64_t &tick, const uint64_t &count) { return (tick << count_bits) | (count & count_mask); }
+  static uint64_t bucket_tick   (const uint64_t &value) { return value >> count_bits; }
+  static uint64_t bucket_count_of(const uint64_t &value) { return value &  count_mask; }
+
+  static uint64_t now_tick()
   {
-    cleanup_cutoff();
-    return transactions_.size();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>
+           (std::chrono::steady_clock::now().time_since_epoch()).count() / bucket_ms);
   }
 
-  void cleanup_cutoff()
+  /**
+   * @brief 현재 쓰레드 샤드의 구간내 건수. 다른 샤드는 읽지 않습니다.
+   * @param value add()가 리턴한 버킷값
+   * @details 지난 버킷의 합은 샤드에 tick마다 한번만 계산하여 캐시합니다.
+   */
+  size_t get_shard_count(const uint64_t &value)
   {
-    auto cutoff = std::chrono::system_clock::now() - std::chrono::seconds(1);
-    transactions_.erase(transactions_.lower_bound(cutoff), transactions_.end());
+    const uint64_t tick  = bucket_tick(value);
+    shard_t       &shard = shards_[thread_uindex & (shard_count - 1)];
+
+    uint64_t cached = shard.past.load(std::memory_order_relaxed);
+    if (bucket_tick(cached) == tick)
+      return static_cast<size_t>(bucket_count_of(cached) + bucket_count_of(value));
+
+    uint64_t past = 0;
+    for (size_t index = 0; index < bucket_count; ++index)
+    {
+      uint64_t bucket = shard.buckets[index].load(std::memory_order_relaxed);
+      uint64_t at     = bucket_tick(bucket);
+      if (at < tick && at + bucket_count > tick)
+        past += bucket_count_of(bucket);
+    }
+
+    if (past > count_mask) past = count_mask;
+    shard.past.store(pack(tick, past), std::memory_order_relaxed);
+    return static_cast<size_t>(past + bucket_count_of(value));
   }
 
+  size_t get_count(const uint64_t &tick)
+  {
+    // 현재 버킷
+    uint64_t current = 0;
+    for (auto &shard : shards_)
+    {
+      uint64_t value = shard.buckets[tick % bucket_count].load(std::memory_order_relaxed);
+      if (bucket_tick(value) == tick)
+        current += bucket_count_of(value);
+    }
+
+    // 지난 버킷. tick당 한번만 계산
+    uint64_t cached = cached_.load(std::memory_order_relaxed);
+    if (bucket_tick(cached) == tick)
+      return static_cast<size_t>(bucket_count_of(cached) + current);
+
+    uint64_t past = 0;
+    for (auto &shard : shards_)
+    {
+      for (size_t index = 0; index < bucket_count; ++index)
+      {
+        uint64_t value = shard.buckets[index].load(std::memory_order_relaxed);
+        uint64_t at    = bucket_tick(value);
+        if (at < tick && at + bucket_count > tick)
+          past += bucket_count_of(value);
+      }
+    }
+
+    if (past > count_mask) past = count_mask;
+    cached_.store(pack(tick, past), std::memory_order_relaxed);
+    return static_cast<size_t>(past + current);
+  }
+
+  struct shard_t
+  {
+    std::atomic<uint64_t> buckets[bucket_count];
+    std::atomic<uint64_t> past{0};  ///< (tick << 24 | 이 샤드의 지난 버킷 합) @see get_shard_count
+    char                  pad[64];  ///< 인접 샤드와 캐시라인 분리
+
+    shard_t() { for (auto &bucket : buckets) bucket.store(0, std::memory_order_relaxed); }
+  };
+
 protected:
-  mutable std::mutex mutex_;
-  std::multiset<std::chrono::system_clock::time_point,
-                std::greater<std::chrono::system_clock::time_point>> transactions_;
+  shard_t               shards_[shard_count];
+  char                  pad_[64];
+  std::atomic<uint64_t> cached_{0};  ///< (tick << 24 | 지난 버킷 합)
 };
 
+/**
+ * @class TpsMeter
+ * @brief 최근 1초간의 트랜잭션 수(TPS). 10ms 버킷 100개. @see RateMeter
+ */
+class TpsMeter : public RateMeter<10, 100>
+{
+public:
+  /**
+   * @brief 현재 쓰레드의 샤드에 기록하고 그 샤드의 TPS를 리턴합니다.
+   * @details 다른 쓰레드의 샤드는 읽지 않으므로(쓰기만 함) 리턴값은 근사치입니다.
+   *          기록하는 쓰레드가 하나면 TPS와 같고, 여럿이면 이 쓰레드(샤드)의 몫입니다. 전체 TPS는 get_tps()로 읽습니다.
+   */
+  size_t add_transaction()
+  {
+    return get_shard_count(add());
+  }
+
+  size_t get_tps()
+  {
+    return get_count();
+  }
+};
+
+/**
+ * @class MultiTpsMeter
+ * @brief TpsMeter(1초)에 10초, 60초 평균 TPS를 추가한 클래스
+ * @details 순간 TPS(get_tps)는 TpsMeter와 같으며, 지속 처리량을 보기 위해 10초/60초 구간 평균을 제공합니다.
+ */
+class MultiTpsMeter : public TpsMeter
+{
+public:
+  /// @copydoc TpsMeter::add_transaction
+  size_t add_transaction()
+  {
+    tps_10s_.add();
+    tps_60s_.add();
+    return TpsMeter::add_transaction();
+  }
+
+  double get_tps_10s() { return tps_10s_.get_rate(); }
+  double get_tps_60s() { return tps_60s_.get_rate(); }
+
+protected:
+  RateMeter<100, 100> tps_10s_; ///< 100ms * 100
+  RateMeter<600, 100> tps_60s_; ///< 600ms * 100
+};
@@ -0,0 +1,228 @@
+/*
+ * WaitStrategy.h
+ *
+ *  Created on: 2025. 3. 10.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * @brief 큐가 비어있을때 소비자의 대기 방식
+ * @details
+ * CPU 사용량과 지연시간의 trade-off 이므로 배포 환경에 맞게 선택합니다.
+ *
+ *  adaptive   : 1000회 spin 후 1ms씩 sleep (기존 SIGNALED=false 동작). 유휴시 cpu 5~10%, 최대 1ms 지연
+ *  signal     : MSignal(mutex + condition_variable) 대기 (기존 SIGNALED=true 동작). push마다 mutex
+ *  busy_spin  : 계속 spin. 지연 최소, 유휴시에도 cpu 100%
+ *  spin_yield : spin 후 sched_yield. 다른 쓰레드에 cpu를 양보하지만 유휴시에도 cpu를 사용
+ *  backoff    : spin 후 1us부터 2배씩 최대 1ms까지 sleep
+ *  park       : spin 후 futex로 대기(EventCount). 생산자는 소비자가 실제로 대기중일때만 깨우므로
+ *               대기중이 아니면 push 비용은 fence 한번. 유휴시 cpu 0%
+ */
+enum class wait_strategy_t : uint8_t
+{
+  adaptive = 0,
+  signal,
+  busy_spin,
+  spin_yield,
+  backoff,
+  park,
+};
+
+inline const char *
+to_string(const wait_strategy_t &strategy)
+{
+  switch (strategy)
+  {
+    case wait_strategy_t::adaptive  : return "adaptive";
+    case wait_strategy_t::signal    : return "signal";
+    case wait_strategy_t::busy_spin : return "busy_spin";
+    case wait_strategy_t::spin_yield: return "spin_yield";
+    case wait_strategy_t::backoff   : return "backoff";
+    case wait_strategy_t::park      : return "park";
+  }
+  return "unknown";
+}
+
+/// 설정 문자열을 wait_strategy_t로 변환. 모르는 이름이면 false
+inline bool
+to_wait_strategy(const std::string &name, wait_strategy_t &strategy)
+{
+  static const wait_strategy_t all[] = { wait_strategy_t::adaptive,   wait_strategy_t::signal,
+                                         wait_strategy_t::busy_spin,  wait_strategy_t::spin_yield,
+                                         wait_strategy_t::backoff,    wait_strategy_t::park };
+  for (const auto &item : all)
+  {
+    if (name != to_string(item))
+      continue;
+    strategy = item;
+    return true;
+  }
+  return false;
+}
+
+/// spin 루프용 pause 명령. 하이퍼쓰레드 형제 코어에 자원을 양보하고 전력소모를 줄입니다.
+inline void
+cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+/**
+ * @class EventCount
+ * @brief futex 기반 EventCount. lock-free 큐의 소비자를 잠재우고 깨우는데 사용합니다.
+ * @details
+ * 소비자
+ *   auto key = ec.prepare_wait();       // 대기 등록
+ *   if (queue.pop(item) == true) { ec.cancel_wait(); ... }  // 등록 후 한번 더 확인(lost wakeup 방지)
+ *   else ec.wait(key, timeout_ms);      // key 이후 notify가 있었으면 바로 리턴
+ *
+ * 생산자
+ *   queue.push(item);
+ *   ec.notify();                        // 대기중인 소비자가 없으면 syscall 없음
+ *
+ * waiters_ 증가 후 큐 확인(소비자)과 큐 추가 후 waiters_ 확인(생산자) 사이에
+ * seq_cst fence를 두어 둘 중 하나는 반드시 상대방을 보게 됩니다.
+ *
+ * PROCESS_SHARED가 true이면 공유메모리에 두고 여러 프로세스가 사용할 수 있습니다.(SharedEventCount, @see ShmRing)
+ */
+template<bool PROCESS_SHARED = false>
+class BasicEventCount
+{
+public:
+  BasicEventCount() = default;
+  BasicEventCount(const BasicEventCount &) = delete;
+  BasicEventCount &operator=(const BasicEventCount &) = delete;
+
+  uint32_t prepare_wait()
+  {
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return epoch_.load(std::memory_order_acquire);
+  }
+
+  void cancel_wait()
+  {
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /// timeout_ms가 0 이하이면 notify까지 무한대기. 가짜깨움이 있을 수 있으므로 호출자는 큐를 다시 확인해야 합니다.
+  void wait(const uint32_t &key, const int64_t &timeout_ms = 0)
+  {
+    struct timespec  timeout;
+    struct timespec *timeout_ptr = nullptr;
+    if (timeout_ms > 0)
+    {
+      timeout.tv_sec  = timeout_ms / 1000;
+      timeout.tv_nsec = (timeout_ms % 1000) * 1000000;
+      timeout_ptr = &timeout;
+    }
+
+    if (epoch_.load(std::memory_order_acquire) == key)
+      futex(PROCESS_SHARED ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE, key, timeout_ptr);
+
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void notify()
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) == 0)
+      return;
+
+    epoch_.fetch_add(1, std::memory_order_release);
+    futex(PROCESS_SHARED ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, 1, nullptr);
+  }
+
+  void notify_all()
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) == 0)
+      return;
+
+    epoch_.fetch_add(1, std::memory_order_release);
+    futex(PROCESS_SHARED ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, INT_MAX, nullptr);
+  }
+
+  /**
+   * @brief fence 없이 대기자를 확인하는 notify_all
+   * @details 호출이 잦은 쪽(ex. pop마다)에서 사용합니다. 대기 등록과 겹치면 깨움을 놓칠 수 있으므로
+   * 대기자는 반드시 timeout을 두고 기다려야 합니다.
+   */
+  void notify_all_relaxed()
+  {
+    if (waiters_.load(std::memory_order_relaxed) == 0)
+      return;
+
+    epoch_.fetch_add(1, std::memory_order_release);
+    futex(PROCESS_SHARED ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, INT_MAX, nullptr);
+  }
+
+protected:
+  long futex(const int &op, const uint32_t &value, const struct timespec *timeout)
+  {
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex requires 32bit atomic");
+    return syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch_), op, value, timeout, nullptr, 0);
+  }
+
+protected:
+  std::atomic<uint32_t> epoch_  {0};
+  std::atomic<uint32_t> waiters_{0};
+};
+
+using EventCount       = BasicEventCount<false>;
+using SharedEventCount = BasicEventCount<true>;   ///< 프로세스간 공유메모리용
+
+/**
+ * @brief 큐가 비었을때 strategy에 따라 한번 대기합니다.(park, signal 제외)
+ * @param fails 연속 실패 횟수. 호출자가 0으로 초기화하고 pop 성공시까지 유지합니다.
+ */
+inline void
+wait_idle(const wait_strategy_t &strategy, uint32_t &fails)
+{
+  static constexpr uint32_t spin_limit = 100;
+
+  switch (strategy)
+  {
+    case wait_strategy_t::busy_spin:
+      cpu_relax();
+      return;
+
+    case wait_strategy_t::spin_yield:
+      if (fails < spin_limit) { ++fails; cpu_relax(); return; }
+      std::this_thread::yield();
+      return;
+
+    case wait_strategy_t::backoff:
+      if (fails < spin_limit) { ++fails; cpu_relax(); return; }
+      {
+        // 1us, 2us, 4us ... 1024us
+        uint32_t shift = fails - spin_limit;
+        if (shift < 10) ++fails;
+        std::this_thread::sleep_for(std::chrono::microseconds(1 << shift));
+      }
+      return;
+
+    case wait_strategy_t::adaptive:
+    default:
+      if (fails < 1000) { ++fails; return; }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      return;
+  }
+}
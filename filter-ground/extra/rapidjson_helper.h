@@ -12,7 +12,9 @@
 #include <rapidjson/writer.h>
 #include <rapidjson/prettywriter.h>   // PrettyWriter 포함
 #include <extra/Optional.h>
+#include <extra/FieldReflect.h>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <functional>
 
@@ -220,7 +222,7 @@ add_member(R &obj, const std::string &name, const char (&value)[N][M], rapid_al
  * 
  * @details 벡터의 각 요소를 JSON 배열로 변환하여 객체의 멤버로 추가
  */
-template<typename RAPID_OBJECT, typename T> RAPID_OBJECT &
+template<typename RAPID_OBJECT, typename T> typename std::enable_if<!is_field_reflected<T>::value, RAPID_OBJECT &>::type
 add_member(RAPID_OBJECT &obj, const std::string &name, const std::vector<T> &values, rapidjson::Document::AllocatorType &al)
 {
   rapid_value array(rapidjson::kArrayType);
@@ -320,7 +322,7 @@ template<typename R> void set_value(long long   &val, const R &obj, const std::s
 template<typename R> void set_value(float       &val, const R &obj, const std::string &name ) { if (is_valid(val, obj, name) == false) throw std::string("Not found or Invalid type ") + name; val << obj[name.c_str()];}
 template<typename R> void set_value(double      &val, const R &obj, const std::string &name ) { if (is_valid(val, obj, name) == false) throw std::string("Not found or Invalid type ") + name; val << obj[name.c_str()];}
 template<typename R> void set_value(std::string &val, const R &obj, const std::string &name ) { if (is_valid(val, obj, name) == false) throw std::string("Not found or Invalid type ") + name; val << obj[name.c_str()];}
-template<typename R, typename T> void
+template<typename R, typename T> typename std::enable_if<!is_field_reflected<T>::value>::type
 set_value(std::vector<T> &vals, const R &obj, const std::string &name)
 {
   if (obj.HasMember(name.c_str()) == false)
@@ -415,7 +417,7 @@ set_value(char (&val)[N][M], const R &obj, const std::string &name)
 }
 
 /// optional /////////////////////////////////////////////////////////////////////////
-template<typename R, typename T> void
+template<typename R, typename T> typename std::enable_if<!is_field_reflected<T>::value>::type
 set_value(Optional<std::vector<T>> &vals_opt, const R &obj, const std::string &name)
 {
   vals_opt = nullopt;
@@ -512,3 +514,261 @@ set_value(Optional<int64_t> &val_opt, const R &obj, const std::string &name)
 
   val_opt = obj[name.c_str()].GetInt64();
 }
+
+/// write_member (SAX) ///////////////////////////////////////////////////////////////////////////////////////////////////
+// add_member는 Document(DOM)에 이름과 값을 복사한 후 출력하지만 write_member는 rapidjson::Writer로 바로 출력한다.
+// 구조체는 FIELD_REFLECT로 등록하거나 write_value(WRITER &, const 구조체 &) 를 정의하면 write_member로 출력할 수 있다.
+//
+// example)
+//  rapidjson::StringBuffer buffer;
+//  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+//  writer.StartObject();
+//  write_member(writer, "smppResult", value.smppResult);
+//  write_member(writer, "spamPattern2", value.spamPattern2); // nullopt이면 출력 안함
+//  writer.EndObject();
+
+template<typename W> void write_value(W &writer, const char        &value) { writer.String(&value, value == 0x00 ? 0 : 1); }
+template<typename W> void write_value(W &writer, const int16_t     &value) { writer.Int(value); }
+template<typename W> void write_value(W &writer, const int32_t     &value) { writer.Int(value); }
+template<typename W> void write_value(W &writer, const int64_t     &value) { writer.Int64(value); }
+template<typename W> void write_value(W &writer, const long long   &value) { writer.Int64(static_cast<int64_t>(value)); }
+template<typename W> void write_value(W &writer, const float       &value) { writer.Double(value); }
+template<typename W> void write_value(W &writer, const double      &value) { writer.Double(value); }
+template<typename W> void write_value(W &writer, const std::string &value) { writer.String(value.data(), static_cast<rapidjson::SizeType>(value.size())); }
+
+template<typename W, typename T> void
+write_value(W &writer, const std::vector<T> &values)
+{
+  writer.StartArray();
+  for (auto &value : values)
+    write_value(writer, value);
+  writer.EndArray();
+}
+
+/**
+ * @brief write_value가 없는 타입은 add_member로 DOM을 만든 후 출력
+ * @details 느리므로 자주 출력하는 구조체는 write_value를 정의하거나 FIELD_REFLECT로 등록해야 한다.
+ */
+template<typename W, typename T> typename std::enable_if<!is_field_reflected<T>::value>::type
+write_value(W &writer, const T &value)
+{
+  rapid_doc doc(rapidjson::kObjectType);
+  add_member(doc, "v", value, doc.GetAllocator());
+
+  auto member = doc.FindMember("v");
+  if (member == doc.MemberEnd())
+    writer.Null();
+  else
+    member->value.Accept(writer);
+}
+
+template<typename W, typename T> void
+write_member(W &writer, const char *name, const T &value)
+{
+  writer.Key(name);
+  write_value(writer, value);
+}
+
+/// nullopt이면 출력하지 않음 (add_member와 같음)
+template<typename W, typename T> void
+write_member(W &writer, const char *name, const Optional<T> &value)
+{
+  if (value.has_value() == false)
+    return;
+
+  writer.Key(name);
+  write_value(writer, value.value());
+}
+
+/// FIELD_REFLECT 구조체 코덱 ////////////////////////////////////////////////////////////////////////////////////////////
+// FIELD_REFLECT(extra/FieldReflect.h)로 등록한 필드 목록 하나로 write_value(SAX), add_member(DOM), set_value(파싱)를 만든다.
+// 인코더와 디코더가 같은 목록을 사용하므로 필드가 어긋나지 않는다.
+// set_value는 객체 멤버를 한번만 순회하며 미리 계산된 이름 해시로 필드를 찾는다.
+// (필드마다 HasMember + operator[]로 멤버를 두번씩 선형 검색하지 않음)
+// Optional 필드는 없으면 nullopt, 그 외 필드는 없으면 예외(std::string)
+
+[[noreturn]] inline void
+json_type_error(const char *name)
+{
+  throw std::string("Not found or Invalid type ") + name;
+}
+
+/// 값 단위 읽기. 타입이 다르면 예외
+template<typename V> void read_value(char        &out, const V &value, const char *name) { if (value.IsString() == false) json_type_error(name); out = value.GetStringLength() == 0 ? 0x00 : value.GetString()[0]; }
+template<typename V> void read_value(int16_t     &out, const V &value, const char *name) { if (value.IsInt()    == false) json_type_error(name); out = static_cast<int16_t>(value.GetInt()); }
+template<typename V> void read_value(int32_t     &out, const V &value, const char *name) { if (value.IsInt()    == false) json_type_error(name); out = value.GetInt();   }
+template<typename V> void read_value(int64_t     &out, const V &value, const char *name) { if (value.IsInt64()  == false) json_type_error(name); out = value.GetInt64(); }
+template<typename V> void read_value(long long   &out, const V &value, const char *name) { if (value.IsInt64()  == false) json_type_error(name); out = value.GetInt64(); }
+template<typename V> void read_value(float       &out, const V &value, const char *name) { if (value.IsNumber() == false) json_type_error(name); out = static_cast<float>(value.GetDouble()); }
+template<typename V> void read_value(double      &out, const V &value, const char *name) { if (value.IsNumber() == false) json_type_error(name); out = value.GetDouble(); }
+template<typename V> void read_value(std::string &out, const V &value, const char *name) { if (value.IsString() == false) json_type_error(name); out.assign(value.GetString(), value.GetStringLength()); }
+
+template<typename V, typename T> void
+read_value(std::vector<T> &out, const V &value, const char *name)
+{
+  if (value.IsArray() == false)
+    json_type_error(name);
+
+  out.clear();
+  out.resize(value.Size());
+  for (rapidjson::SizeType index = 0; index < value.Size(); ++index)
+    read_value(out[index], value[index], name);
+}
+
+template<typename V, typename T> void
+read_value(Optional<T> &out, const V &value, const char *name)
+{
+  T item;
+  read_value(item, value, name);
+  out = std::move(item);
+}
+
+template<typename V, typename T> typename std::enable_if<is_field_reflected<T>::value>::type
+read_value(T &out, const V &value, const char *name)
+{
+  if (value.IsObject() == false)
+    json_type_error(name);
+  set_value(out, value);
+}
+
+/// 없는 필드. Optional이면 nullopt, 그 외는 예외
+template<typename T> void missing_value(T           &,   const char *name) { json_type_error(name); }
+template<typename T> void missing_value(Optional<T> &out, const char *)    { out = nullopt; }
+
+template<typename W, typename T>
+struct write_field_t
+{
+  W       &writer;
+  const T &value;
+
+  template<typename FIELD> void operator()(const FIELD &field) { write_member(writer, field.key.name, value.*(field.member)); }
+};
+
+template<typename T>
+struct add_field_t
+{
+  rapid_value &obj;
+  const T     &value;
+  rapid_al    &al;
+
+  template<typename FIELD> void operator()(const FIELD &field) { add_member(obj, field.key.name, value.*(field.member), al); }
+};
+
+template<typename T, typename V>
+struct read_field_t
+{
+  T       &out;
+  const V &value;
+
+  template<typename FIELD> void operator()(const FIELD &field) { read_value(out.*(field.member), value, field.key.name); }
+};
+
+template<typename T>
+struct missing_field_t
+{
+  T        &out;
+  uint64_t  seen;
+  size_t    index;
+
+  template<typename FIELD> void operator()(const FIELD &field)
+  {
+    if ((seen & (1ULL << index++)) == 0)
+      missing_value(out.*(field.member), field.key.name);
+  }
+};
+
+template<typename W, typename T> typename std::enable_if<is_field_reflected<T>::value>::type
+write_value(W &writer, const T &value)
+{
+  writer.StartObject();
+  write_field_t<W, T> write{writer, value};
+  for_each_field(field_reflect_t<T>::fields(), write);
+  writer.EndObject();
+}
+
+/// 객체(obj)에 value의 필드들을 멤버로 추가
+template<typename T> typename std::enable_if<is_field_reflected<T>::value>::type
+add_fields(rapid_value &obj, const T &value, rapid_al &al)
+{
+  add_field_t<T> add{obj, value, al};
+  for_each_field(field_reflect_t<T>::fields(), add);
+}
+
+template<typename RAPID_OBJECT, typename T> typename std::enable_if<is_field_reflected<T>::value, RAPID_OBJECT &>::type
+add_member(RAPID_OBJECT &obj, const std::string &name, const T &value, rapid_al &al)
+{
+  rapid_value sub(rapidjson::kObjectType);
+  add_fields(sub, value, al);
+  obj.AddMember(rapid_value(name.c_str(), al).Move(), sub, al);
+  return obj;
+}
+
+template<typename RAPID_OBJECT, typename T> typename std::enable_if<is_field_reflected<T>::value, RAPID_OBJECT &>::type
+add_member(RAPID_OBJECT &obj, const std::string &name, const std::vector<T> &values, rapid_al &al)
+{
+  rapid_value array(rapidjson::kArrayType);
+  for (auto &value : values)
+  {
+    rapid_value sub(rapidjson::kObjectType);
+    add_fields(sub, value, al);
+    array.PushBack(sub, al);
+  }
+  obj.AddMember(rapid_value(name.c_str(), al).Move(), array, al);
+  return obj;
+}
+
+/// 객체(obj)의 멤버를 한번 순회하며 필드를 채운다.
+template<typename T, typename R> typename std::enable_if<is_field_reflected<T>::value>::type
+set_value(T &value, const R &obj)
+{
+  using reflect_t = field_reflect_t<T>;
+
+  if (obj.IsObject() == false)
+    throw std::string("Invalid type object");
+
+  uint64_t seen = 0;
+  size_t   hint = 0;  ///< 보통 필드 순서대로 들어오므로 다음 필드부터 찾는다.
+  for (auto member = obj.MemberBegin(); member != obj.MemberEnd(); ++member)
+  {
+    size_t index = reflect_t::find(member->name.GetString(), member->name.GetStringLength(), hint);
+    if (index == reflect_t::size)
+      continue;
+
+    read_field_t<T, typename std::decay<decltype(member->value)>::type> read{value, member->value};
+    visit_field(reflect_t::fields(), index, read);
+
+    seen |= 1ULL << index;
+    hint  = index + 1;
+  }
+
+  missing_field_t<T> missing{value, seen, 0};
+  for_each_field(reflect_t::fields(), missing);
+}
+
+template<typename T, typename R> typename std::enable_if<is_field_reflected<T>::value>::type
+set_value(T &value, const R &obj, const std::string &name)
+{
+  auto member = obj.FindMember(name.c_str());
+  if (member == obj.MemberEnd())
+    json_type_error(name.c_str());
+  read_value(value, member->value, name.c_str());
+}
+
+template<typename R, typename T> typename std::enable_if<is_field_reflected<T>::value>::type
+set_value(std::vector<T> &values, const R &obj, const std::string &name)
+{
+  auto member = obj.FindMember(name.c_str());
+  if (member == obj.MemberEnd())
+    json_type_error(name.c_str());
+  read_value(values, member->value, name.c_str());
+}
+
+template<typename R, typename T> typename std::enable_if<is_field_reflected<T>::value>::type
+set_value(Optional<std::vector<T>> &values, const R &obj, const std::string &name)
+{
+  values = nullopt;
+  auto member = obj.FindMember(name.c_str());
+  if (member == obj.MemberEnd())
+    return;
+  read_value(values, member->value, name.c_str());
+}
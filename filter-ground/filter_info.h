@@ -11,6 +11,7 @@
 #include <filter_info/message_info.h>
 #include <filter_info/result_info.h>
 #include <extra/rapidjson_helper.h>
+#include <extra/BinaryCodec.h>
 #include <extra/Expected.h>
 
 /**
@@ -25,17 +26,47 @@ struct filter_info_t
   result_info_t   resultInfo;
 };
 
+FIELD_REFLECT(filter_info_t,
+              FIELD(messageInfo),
+              FIELD(customerInfo),
+              FIELD(resultInfo));
+
+template<typename WRITER> void
+write_json(WRITER &writer, const filter_info_t &info)
+{
+  writer.StartObject();
+  write_member(writer, "messageInfo",  info.messageInfo);
+  write_member(writer, "customerInfo", info.customerInfo);
+  write_member(writer, "resultInfo",   info.resultInfo);
+  writer.EndObject();
+}
+
+/**
+ * @brief filter_info_t를 JSON으로 출력
+ * @details
+ * Document(DOM)를 만들지 않고 rapidjson::Writer로 바로 출력한다.(write_value)
+ * 출력 버퍼와 writer는 쓰레드별로 재사용하므로 호출마다의 할당은 리턴하는 문자열 하나이다.
+ * 같은 내용을 로그와 발행에 쓰는 경우 한번만 호출해서 같이 사용한다.
+ */
 inline std::string
 to_json(const filter_info_t &info, bool pretty = false)
 {
-  rapidjson::Document doc(rapidjson::kObjectType);
-  rapidjson::Document::AllocatorType &al = doc.GetAllocator();
+  static thread_local rapidjson::StringBuffer buffer;
+  buffer.Clear(); ///< 용량은 유지
 
-  add_member(doc, "messageInfo",  info.messageInfo,  al);
-  add_member(doc, "customerInfo", info.customerInfo, al);
-  add_member(doc, "resultInfo",   info.resultInfo,   al);
+  if (pretty == true)
+  {
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    write_json(writer, info);
+  }
+  else
+  {
+    static thread_local rapidjson::Writer<rapidjson::StringBuffer> writer;
+    writer.Reset(buffer);
+    write_json(writer, info);
+  }
 
-  return to_json(doc, pretty);
+  return std::string(buffer.GetString(), buffer.GetSize());
 }
 
 inline Expected<filter_info_t, std::string> // success, error str
@@ -79,3 +110,43 @@ from_filter_info_json(const std::string &json)
 
   return value;
 }
+
+/**
+ * @brief filter_info_t를 바이너리로 출력 (extra/BinaryCodec.h)
+ * @details 다음 필터가 바이너리를 받을 수 있을때만 사용합니다.(nats.next.format)
+ *          FIELD_REFLECT로 등록되지 않은 섹션은 블록 안에 JSON으로 들어갑니다.
+ */
+inline std::string
+to_binary(const filter_info_t &info)
+{
+  static thread_local size_t capacity = 1024; ///< 최근 크기로 미리 할당
+  std::string out;
+  out.reserve(capacity);
+  bin_encode(out, info);
+  capacity = out.size();
+  return out;
+}
+
+inline Expected<filter_info_t, std::string> // success, error str
+from_filter_info_binary(const std::string &message)
+{
+  filter_info_t value;
+  std::string   error;
+  if (bin_decode(message, value, error) == false)
+    return make_unexpected(error);
+  return value;
+}
+
+/// 수신 메세지. 바이너리(magic)이면 바이너리로, 아니면 JSON으로 파싱
+inline Expected<filter_info_t, std::string> // success, error str
+from_filter_info_message(const std::string &message)
+{
+  return is_binary_message(message) ? from_filter_info_binary(message) : from_filter_info_json(message);
+}
+
+/// 설정한 전송 형식으로 출력
+inline std::string
+to_wire(const filter_info_t &info, const wire_format_t &format)
+{
+  return format == wire_format_t::binary ? to_binary(info) : to_json(info);
+}
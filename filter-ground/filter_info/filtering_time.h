@@ -20,37 +20,48 @@ struct filtering_time_t
   int64_t     endTime;
 };
 
+FIELD_REFLECT(filtering_time_t,
+              FIELD(filterName),
+              FIELD(startTime),
+              FIELD(endTime));
+
+/// 필터 이름(filterName)별 처리 시간. JSON에서는 배열
 using filtering_time_objs = std::map<std::string, filtering_time_t>;
 
 template<typename RAPID_OBJECT> RAPID_OBJECT &
-add_member(RAPID_OBJECT &obj, const std::string &name, const filtering_time_t &value, rapidjson::Document::AllocatorType &al)
+add_member(RAPID_OBJECT &obj, const std::string &name, const filtering_time_objs &filtering_times, rapidjson::Document::AllocatorType &al)
 {
-  rapid_value sub(rapidjson::kObjectType);
-
-  add_member(sub, "filterName", value.filterName, al);
-  add_member(sub, "startTime",  value.startTime, al);
-  add_member(sub, "endTime",    value.endTime,   al);
+  rapid_value array(rapidjson::kArrayType);
+  for (auto &filtering_time : filtering_times)
+  {
+    rapid_value sub(rapidjson::kObjectType);
+    add_fields(sub, filtering_time.second, al);
+    array.PushBack(sub, al);
+  }
+  obj.AddMember(rapid_value(name.c_str(), al).Move(), array, al);
   return obj;
 }
 
-template<typename RAPID_OBJECT> void
-set_value(filtering_time_objs &filtering_times, const RAPID_OBJECT &obj, const std::string &name)
+template<typename WRITER> void
+write_value(WRITER &writer, const filtering_time_objs &filtering_times)
 {
-  if (!obj.HasMember(name.c_str()))
-    throw std::string("Not found or Invalid type ") + name;
+  writer.StartArray();
+  for (auto &filtering_time : filtering_times)
+    write_value(writer, filtering_time.second);
+  writer.EndArray();
+}
 
-  if (!obj[name.c_str()].IsArray())
-    throw std::string("Not found or Invalid type ") + name;
+template<typename V> void
+read_value(filtering_time_objs &filtering_times, const V &value, const char *name)
+{
+  if (value.IsArray() == false)
+    json_type_error(name);
 
-  const auto &items = obj[name.c_str()];
-  for (rapidjson::SizeType index = 0; index < items.Size(); ++index)
+  filtering_times.clear();
+  for (rapidjson::SizeType index = 0; index < value.Size(); ++index)
   {
-    const rapid_value &item = items[index];
-
-    filtering_time_t &filtering_time = filtering_times[name];
-    set_value(filtering_time.filterName,  item, "filterName");
-    set_value(filtering_time.startTime,   item, "startTime");
-    set_value(filtering_time.endTime,     item, "endTime");
+    filtering_time_t filtering_time;
+    read_value(filtering_time, value[index], name);
+    filtering_times[filtering_time.filterName] = std::move(filtering_time);
   }
 }
-
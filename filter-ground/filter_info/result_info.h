@@ -55,56 +55,14 @@ struct result_info_t
   filtering_time_objs   filteringTime;
 };
 
-template<typename RAPID_OBJECT> void
-add_member(RAPID_OBJECT &obj, const std::string &name, const filtering_time_objs &filtering_times, rapidjson::Document::AllocatorType &al);
-
-template<typename RAPID_OBJECT> RAPID_OBJECT &
-add_member(RAPID_OBJECT &obj, const std::string &name, const result_info_t &value, rapidjson::Document::AllocatorType &al)
-{
-  rapid_value sub(rapidjson::kObjectType);
-
-  add_member(sub, "smppResult",       value.smppResult,     al);
-  add_member(sub, "resultCode",       value.resultCode,     al);
-  add_member(sub, "reasonCode",       value.reasonCode,     al);
-  add_member(sub, "spamPattern1",     value.spamPattern1,   al);
-  add_member(sub, "spamPattern2",     value.spamPattern2,   al);
-  add_member(sub, "spamPattern3",     value.spamPattern3,   al);
-  add_member(sub, "imageFileName",    value.imageFileName,   al);
-  add_member(sub, "filterStartTime",  value.filterStartTime,al);
-  add_member(sub, "filterEndTime",    value.filterEndTime,  al);
-  add_member(sub, "filteringTime",    value.filteringTime,  al);
-
-  obj.AddMember(rapid_value(name.c_str(), al).Move(), sub, al);
-  return obj;
-}
-
-template<typename RAPID_OBJECT> void
-add_member(RAPID_OBJECT &obj, const std::string &name, const filtering_time_objs &filtering_times, rapidjson::Document::AllocatorType &al)
-{
-  rapid_value array(rapidjson::kArrayType);
-  for (auto &filtering_time : filtering_times)
-  {
-    rapid_value sub(rapidjson::kObjectType);
-    add_member(sub, "filterName", filtering_time.first,             al);
-    add_member(sub, "startTime",  filtering_time.second.startTime,  al);
-    add_member(sub, "endTime",    filtering_time.second.endTime,    al);
-    array.PushBack(sub, al);
-  }
-  obj.AddMember(rapid_value(name.c_str(), al).Move(), array, al);
-}
-
-template<typename RAPID_OBJECT> void
-set_value(result_info_t &value, RAPID_OBJECT &obj)
-{
-  set_value(value.smppResult,     obj,  "smppResult");
-  set_value(value.resultCode,     obj,  "resultCode");
-  set_value(value.reasonCode,     obj,  "reasonCode");
-  set_value(value.spamPattern1,   obj,  "spamPattern1");
-  set_value(value.spamPattern2,   obj,  "spamPattern2");
-  set_value(value.spamPattern3,   obj,  "spamPattern3");
-  set_value(value.filterStartTime,obj,  "filterStartTime");
-  set_value(value.filterEndTime,  obj,  "filterEndTime");
-  set_value(value.filteringTime,  obj,  "filteringTime");
-}
-
-
+FIELD_REFLECT(result_info_t,
+              FIELD(smppResult),
+              FIELD(resultCode),
+              FIELD(reasonCode),
+              FIELD(spamPattern1),
+              FIELD(spamPattern2),
+              FIELD(spamPattern3),
+              FIELD(imageFileName),
+              FIELD(filterStartTime),
+              FIELD(filterEndTime),
+              FIELD(filteringTime));
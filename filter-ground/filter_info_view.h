@@ -0,0 +1,462 @@
+/*
+ * filter_info_view.h
+ *
+ *  Created on: 2025. 3. 18.
+ *      Author: tys
+ */
+
+#pragma once
+
+#include <filter_info.h>
+#include <rapidjson/reader.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 원본 버퍼의 일부를 가리키는 문자열 (C++17 std::string_view 대용)
+ * @details 가리키는 버퍼(filter_info_view)가 살아있고 이동되지 않는 동안만 유효합니다.
+ */
+class json_str_ref
+{
+public:
+  json_str_ref() = default;
+  json_str_ref(const char *data, const size_t &size) : data_(data), size_(size) {}
+
+  const char *data () const { return data_; }
+  size_t      size () const { return size_; }
+  bool        empty() const { return size_ == 0; }
+  std::string str  () const { return std::string(data_, size_); }
+
+  bool operator==(const std::string &rhs) const { return rhs.size() == size_ && std::memcmp(rhs.data(), data_, size_) == 0; }
+  bool operator!=(const std::string &rhs) const { return !(*this == rhs); }
+
+protected:
+  const char *data_ = "";
+  size_t      size_ = 0;
+};
+
+/**
+ * @class filter_info_view
+ * @brief NATS로 받은 필터 JSON 원문 위의 지연(lazy) 파싱 뷰
+ * @details
+ * from_filter_info_json은 rapidjson::Document를 만들고 모든 필드를 filter_info_t로 복사합니다.
+ * 필터가 수신번호 하나만 보고 결과를 결정하는 경우(ex. 트랩 번호) 대부분의 파싱 비용이 낭비됩니다.
+ *
+ * - get()   : SAX(rapidjson::Reader)로 원문을 읽다가 요청한 필드를 찾으면 바로 멈춥니다.
+ *             DOM을 만들지 않으며, 문자열 값은 원문 버퍼를 가리킵니다.(이스케이프가 있는 값만 복사)
+ *             찾은 값은 캐시하므로 같은 필드를 다시 읽을때는 파싱하지 않습니다.
+ * - mutate(): 필드를 수정하거나 결과를 발행해야 할때 한번만 전체 파싱하여 filter_info_t를 만듭니다.
+ *             이후의 수정은 filter_info_t에만 반영되며 get()은 여전히 원문 값을 리턴합니다.
+ *             (destination_mdn, filter_start_time은 mutate 이후 filter_info_t의 값을 리턴)
+ *
+ * 바이너리 메세지(extra/BinaryCodec.h)도 같은 방식으로 읽습니다. 앞의 섹션/필드는 길이만 보고 건너뛰며,
+ * 문자열은 항상 원문 버퍼를 가리킵니다. FIELD_REFLECT로 등록되지 않은 섹션은 블록 안의 JSON을 SAX로 읽습니다.
+ *
+ * insitu 파싱은 원문 버퍼를 고쳐쓰므로(문자열 끝에 '\0', 이스케이프 해제) 사용하지 않습니다.
+ * 원문은 mutate()의 전체 파싱과 수신 로그에 그대로 필요합니다.
+ *
+ * example)
+ *  filter_info_view view(std::move(message));
+ *  if (trap_info_list.contains(view.destination_mdn().str()) == false)
+ *    return;
+ *  filter_info_t *filter = view.mutate();
+ *  if (filter == nullptr) error(view.error());
+ */
+class filter_info_view
+{
+public:
+  filter_info_view() = default;
+  explicit filter_info_view(std::string &&raw) : raw_(std::move(raw)) {}
+  explicit filter_info_view(const std::string &raw) : raw_(raw) {}
+
+  /**
+   * @brief section.field 값 (ex. "messageInfo", "destinationMdn")
+   * @return false : 필드가 없거나 타입이 다름, JSON 오류
+   */
+  bool get(const char *section, const char *field, json_str_ref &value) const
+  {
+    const field_t &found = lookup(section, field);
+    if (found.type != field_t::type_t::string)
+      return false;
+
+    value = found.copied ? json_str_ref(found.copy.data(), found.copy.size())
+                         : json_str_ref(raw_.data() + found.offset, found.size);
+    return true;
+  }
+
+  /// @copydoc get. 정수 필드
+  bool get(const char *section, const char *field, int64_t &value) const
+  {
+    const field_t &found = lookup(section, field);
+    if (found.type != field_t::type_t::number)
+      return false;
+
+    value = found.number;
+    return true;
+  }
+
+  /// 수신번호(messageInfo.destinationMdn). 없으면 빈 문자열
+  json_str_ref destination_mdn() const
+  {
+    if (materialized_ == true)
+      return json_str_ref(info_.messageInfo.destinationMdn.data(), info_.messageInfo.destinationMdn.size());
+
+    json_str_ref value;
+    get("messageInfo", "destinationMdn", value);
+    return value;
+  }
+
+  /// gwrecv 수신시간(resultInfo.filterStartTime). 없으면 0
+  int64_t filter_start_time() const
+  {
+    if (materialized_ == true)
+      return info_.resultInfo.filterStartTime;
+
+    int64_t value = 0;
+    get("resultInfo", "filterStartTime", value);
+    return value;
+  }
+
+  /**
+   * @brief 수정할 필터 정보. 처음 호출할때 원문 전체를 파싱합니다.
+   * @return nullptr : 파싱 오류 (error() 참조)
+   */
+  filter_info_t *mutate()
+  {
+    if (materialized_ == true)
+      return &info_;
+
+    if (error_.empty() == false)
+      return nullptr;
+
+    auto parsed = from_filter_info_message(raw_);
+    if (parsed == false)
+    {
+      error_ = parsed.error();
+      return nullptr;
+    }
+
+    info_         = std::move(parsed).value();
+    materialized_ = true;
+    return &info_;
+  }
+
+  /**
+   * @brief 형식 확인 (수신 쓰레드에서 유입 제어 전에 사용)
+   * @details 수신번호(messageInfo.destinationMdn)를 읽어 캐시합니다. 첫 섹션이므로 원문 앞부분만 SAX로 읽으며,
+   *          워커에서 destination_mdn()을 다시 읽을때는 파싱하지 않습니다.(ex. AuthFilterWorker::pre_filter)
+   *          수신번호가 없으면(필드 누락 또는 그 앞의 형식 오류) 전체 파싱(mutate)으로 확인합니다.
+   *          수신번호 뒤쪽이 잘린 메세지는 통과하며 워커의 전체 파싱에서 확인됩니다.
+   * @return false : 형식 오류 (error() 참조)
+   */
+  bool check_format()
+  {
+    json_str_ref value;
+    if (get("messageInfo", "destinationMdn", value) == true)
+      return true;
+
+    return mutate() != nullptr;
+  }
+
+  bool               materialized() const { return materialized_; }
+  const std::string &error       () const { return error_;        }
+  const std::string &raw         () const { return raw_;          }
+
+  bool               binary      () const { return is_binary_message(raw_); }
+
+  /**
+   * @brief 원문(raw)에서 section.field 문자열 값을 찾습니다. 뷰를 만들지 않고 캐시하지 않습니다.
+   * @details 이스케이프가 없으면 value는 raw를 가리키고, 있으면 false입니다.(ex. 선택기 키 추출)
+   */
+  static bool peek(const std::string &raw, const char *section, const char *field, json_str_ref &value)
+  {
+    field_t found = scan(raw, section, field);
+    if (found.type != field_t::type_t::string || found.copied == true)
+      return false;
+
+    value = json_str_ref(raw.data() + found.offset, found.size);
+    return true;
+  }
+
+  /**
+   * @brief @copybrief peek. 이스케이프가 있는 값은 해제하여 buffer에 두고 value는 buffer를 가리킵니다.
+   * @details 같은 값이 이스케이프 여부와 관계없이 같은 문자열이 되어야 할때 사용합니다.(ex. keyed_selector 키)
+   */
+  static bool peek(const std::string &raw, const char *section, const char *field, json_str_ref &value, std::string &buffer)
+  {
+    field_t found = scan(raw, section, field);
+    if (found.type != field_t::type_t::string)
+      return false;
+
+    if (found.copied == true)
+    {
+      buffer = std::move(found.copy);
+      value  = json_str_ref(buffer.data(), buffer.size());
+    }
+    else
+      value = json_str_ref(raw.data() + found.offset, found.size);
+    return true;
+  }
+
+  /// 원문을 돌려받습니다.(큐 추가 실패시 재시도용) 이후 뷰는 비어있습니다.
+  std::string release()
+  {
+    fields_.clear();
+    return std::move(raw_);
+  }
+
+protected:
+  /// 찾은 필드. 문자열은 원문의 위치(offset)로 저장하므로 뷰가 이동되어도 유효합니다.
+  struct field_t
+  {
+    enum class type_t { none, string, number, other };
+
+    const char *section = nullptr;
+    const char *field   = nullptr;
+    type_t      type    = type_t::none;
+    size_t      offset  = 0;
+    size_t      size    = 0;
+    bool        copied  = false;  ///< 이스케이프가 있는 문자열. copy에 해제된 값
+    std::string copy;
+    int64_t     number  = 0;
+  };
+
+  /// section.field 값을 만나면 파싱을 멈추는 SAX 핸들러. section 객체가 끝나면 찾지 못한 것으로 멈춥니다.
+  /// section이 nullptr이면 최상위 객체의 field (바이너리 메세지 안의 JSON 섹션)
+  struct finder_t : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, finder_t>
+  {
+    finder_t(const std::string &raw, const size_t &begin, const rapidjson::StringStream &stream, const char *section, const char *field)
+    : raw_(raw), begin_(begin), stream_(stream),
+      section_(section), field_(field), field_depth_(section == nullptr ? 1 : 2), in_section_(section == nullptr) {}
+
+    bool Key(const char *str, rapidjson::SizeType length, bool)
+    {
+      if (depth_ == field_depth_ && in_section_ == true)
+        wanted_ = match(field_, str, length);
+      else if (depth_ == 1)
+        section_key_ = match(section_, str, length);
+      return true;
+    }
+
+    bool StartObject() { return open(true);  }
+    bool StartArray () { return open(false); }
+    bool EndObject  (rapidjson::SizeType) { return close(); }
+    bool EndArray   (rapidjson::SizeType) { return close(); }
+
+    bool String(const char *str, rapidjson::SizeType length, bool)
+    {
+      if (wanted_ == false)
+        return scalar();
+      found.type = field_t::type_t::string;
+      found.size = length;
+
+      // 호출 시점의 stream은 여는 따옴표(rapidjson은 StringStream을 지역 복사하여 읽음) 또는 닫는 따옴표 다음입니다.
+      // 그 자리의 원문이 해제된 값과 같으면(이스케이프 없음) 원문을 가리키고, 아니면 복사합니다.
+      const size_t pos = begin_ + stream_.Tell();
+      if (in_raw(pos + 1, str, length) == false && (pos < length + 1 || in_raw(pos - length - 1, str, length) == false))
+      {
+        found.copied = true;
+        found.copy.assign(str, length);
+      }
+      return false;
+    }
+
+    bool Int   (int      value) { return integer(value); }
+    bool Uint  (unsigned value) { return integer(value); }
+    bool Int64 (int64_t  value) { return integer(value); }
+    bool Uint64(uint64_t value) { return value > static_cast<uint64_t>(INT64_MAX) ? other() : integer(static_cast<int64_t>(value)); }
+    bool Double(double)         { return other(); }
+    bool Bool  (bool)           { return other(); }
+    bool Null  ()               { return other(); }
+
+    field_t found;
+
+  protected:
+    bool in_raw(const size_t &offset, const char *str, const rapidjson::SizeType &length)
+    {
+      if (offset + length > raw_.size() || std::memcmp(raw_.data() + offset, str, length) != 0)
+        return false;
+      found.offset = offset;
+      return true;
+    }
+
+    static bool match(const char *name, const char *str, const rapidjson::SizeType &length)
+    {
+      return std::strlen(name) == length && std::memcmp(name, str, length) == 0;
+    }
+
+    bool open(const bool &object)
+    {
+      if (wanted_ == true)
+        return other();
+
+      ++depth_;
+      in_section_  = in_section_ || (depth_ == 2 && section_key_ == true && object == true);
+      section_key_ = false;
+      return true;
+    }
+
+    bool close()
+    {
+      if (depth_ == field_depth_ && in_section_ == true)
+        return false; ///< section을 다 봤지만 없음
+      --depth_;
+      return true;
+    }
+
+    bool scalar()
+    {
+      section_key_ = false;
+      return true;
+    }
+
+    bool integer(const int64_t &value)
+    {
+      if (wanted_ == false)
+        return scalar();
+      found.type   = field_t::type_t::number;
+      found.number = value;
+      return false;
+    }
+
+    bool other()
+    {
+      if (wanted_ == false)
+        return scalar();
+      found.type = field_t::type_t::other;
+      return false;
+    }
+
+  protected:
+    const std::string             &raw_;
+    const size_t                   begin_;   ///< stream 시작 위치(raw 기준)
+    const rapidjson::StringStream &stream_;
+    const char *section_;
+    const char *field_;
+    int         field_depth_;          ///< field 키가 있는 깊이
+    int         depth_       = 0;
+    bool        section_key_ = false;  ///< 최상위 객체에서 section 키 다음
+    bool        in_section_;
+    bool        wanted_      = false;  ///< section 객체에서 field 키 다음
+  };
+
+  /// 쓰레드별로 재사용하는 Reader. 내부 스택을 메세지마다 할당하지 않는다.
+  static rapidjson::Reader &sax_reader()
+  {
+    static thread_local rapidjson::Reader reader;
+    return reader;
+  }
+
+  /// 바이너리 필드값을 field_t로 읽는 함수들. 문자열은 원문 위치
+  struct bin_value_t
+  {
+    const std::string &raw;
+    field_t           &found;
+
+    template<typename FIELD> void operator()(const FIELD &, bin_reader_t &reader)
+    {
+      read(reader, bin_tag<typename FIELD::value_type>());
+    }
+
+    void read(bin_reader_t &reader, bin_tag<std::string>)
+    {
+      const char *data = nullptr;
+      if (reader.bytes(data, found.size) == false)
+        return;
+      found.type   = field_t::type_t::string;
+      found.offset = static_cast<size_t>(data - raw.data());
+    }
+
+    template<typename T> void read(bin_reader_t &reader, bin_tag<Optional<T>>)
+    {
+      char flag = 0;
+      if (reader.raw(&flag, 1) == true && flag != 0)
+        read(reader, bin_tag<T>());
+    }
+
+    template<typename T> typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, char>::value>::type
+    read(bin_reader_t &reader, bin_tag<T>)
+    {
+      if (reader.zigzag(found.number) == true)
+        found.type = field_t::type_t::number;
+    }
+
+    template<typename T> typename std::enable_if<!std::is_integral<T>::value || std::is_same<T, char>::value>::type
+    read(bin_reader_t &, bin_tag<T>)
+    {
+      found.type = field_t::type_t::other;
+    }
+  };
+
+  /// 바이너리 섹션에서 field를 찾는 함수. 등록된 구조체이면 바이너리로, 아니면 블록 안의 JSON에서 찾는다.
+  struct bin_section_t
+  {
+    const std::string &raw;
+    const char        *field;
+    field_t           &found;
+
+    template<typename FIELD> void operator()(const FIELD &, bin_reader_t &reader)
+    {
+      seek(reader, bin_tag<typename FIELD::value_type>());
+    }
+
+    template<typename T> typename std::enable_if<is_field_reflected<T>::value>::type
+    seek(bin_reader_t &reader, bin_tag<T>)
+    {
+      bin_value_t value{raw, found};
+      bin_seek<T>(reader, field, value);
+    }
+
+    template<typename T> typename std::enable_if<!is_field_reflected<T>::value>::type
+    seek(bin_reader_t &reader, bin_tag<T>)
+    {
+      bin_reader_t block;
+      if (reader.block(block) == true && block.remain() > 0 && block.pos()[block.remain() - 1] == '\0')
+        found = scan_json(raw, static_cast<size_t>(block.pos() - raw.data()), nullptr, field);
+    }
+  };
+
+  /// 원문의 begin 위치부터 JSON을 SAX로 읽어서 section.field를 찾는다.
+  static field_t scan_json(const std::string &raw, const size_t &begin, const char *section, const char *field)
+  {
+    rapidjson::StringStream stream(raw.c_str() + begin);
+    finder_t                finder(raw, begin, stream, section, field);
+    sax_reader().Parse(stream, finder);
+    return std::move(finder.found);
+  }
+
+  /// 원문에서 section.field를 찾는다. JSON, 바이너리 모두
+  static field_t scan(const std::string &raw, const char *section, const char *field)
+  {
+    if (is_binary_message(raw) == false)
+      return scan_json(raw, 0, section, field);
+
+    field_t       found;
+    bin_reader_t  reader = bin_open<filter_info_t>(raw);
+    bin_section_t finder{raw, field, found};
+    if (reader.ok() == true)
+      bin_seek<filter_info_t>(reader, section, finder);
+    return found;
+  }
+
+  const field_t &lookup(const char *section, const char *field) const
+  {
+    for (auto &each : fields_)
+      if (std::strcmp(each.section, section) == 0 && std::strcmp(each.field, field) == 0)
+        return each;
+
+    fields_.push_back(scan(raw_, section, field));
+    fields_.back().section = section;
+    fields_.back().field   = field;
+    return fields_.back();
+  }
+
+protected:
+  std::string                  raw_;
+  mutable std::vector<field_t> fields_;  ///< get()으로 찾은 필드 캐시
+  filter_info_t                info_;
+  bool                         materialized_ = false;
+  std::string                  error_;
+};
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <extra/SlabAllocator.h>
 #include <memory>
 #include <string>
 
@@ -28,11 +29,14 @@ boost 락프리큐는 소멸자가 없는 정적인 데이터만 가능.
 
 사용:
 - 기본 생성자: 빈 shared_ptr 생성
-- value 생성자: 값을 가진 shared_ptr 생성
+- value 생성자: 값을 가진 shared_ptr 생성 (rvalue는 이동 생성)
+- pool 생성자: queueable_pool_t의 slab 블럭에 shared_ptr 생성 (힙 할당 없음)
 - get(): 저장된 shared_ptr 참조 반환
 - move(): shared_ptr을 반환하고 현재 객체 파괴
 - destroy(): shared_ptr 리셋 (레퍼런스 카운트 감소)
 */
+template<typename T> class queueable_pool_t;
+
 template<typename T>
 struct queueable_t
 {
@@ -49,6 +53,21 @@ struct queueable_t
     new (item) std::shared_ptr<T>(std::make_shared<T>(value));
   }
 
+  explicit queueable_t(T &&value)
+  {
+    new (item) std::shared_ptr<T>(std::make_shared<T>(std::move(value)));
+  }
+
+  queueable_t(queueable_pool_t<T> &pool, const T &value)
+  {
+    new (item) std::shared_ptr<T>(pool.make(value));
+  }
+
+  queueable_t(queueable_pool_t<T> &pool, T &&value)
+  {
+    new (item) std::shared_ptr<T>(pool.make(std::move(value)));
+  }
+
   explicit queueable_t(std::shared_ptr<T> &value)
   {
     new (item) std::shared_ptr<T>(value);
@@ -82,5 +101,42 @@ struct queueable_t
   }
 };
 
+/**
+ * @class queueable_pool_t
+ * @brief queueable_t에 담을 shared_ptr<T>를 힙 할당 없이 생성하기 위한 큐 단위 풀
+ * @details
+ * std::allocate_shared + SlabAllocator를 사용하여 control block과 T를
+ * 미리 할당된 slab 블럭 하나에 생성합니다. shared_ptr의 레퍼런스가 0이 되면
+ * 블럭은 자동으로 풀에 반환되므로 소비자는 기존처럼 take()/destroy()만 하면 됩니다.
+ *
+ * - 블럭 크기는 sizeof(T) + control block 여유분(slack)으로 정합니다.
+ *   control block 크기는 구현(libstdc++/libc++)마다 다르며 여유분보다 크거나
+ *   풀이 바닥나면 일반 힙 할당으로 대체되므로 동작에는 문제가 없습니다.(misses로 확인)
+ * - 큐 크기 + 처리중인 항목 수 만큼의 블럭이 필요하므로 capacity는 큐 크기보다 약간 크게 잡습니다.
+ * - 풀은 이 풀로 만든 모든 shared_ptr보다 오래 살아있어야 합니다.(Worker의 멤버로 사용)
+ */
+template<typename T>
+class queueable_pool_t
+{
+public:
+  static constexpr size_t slack = 64;
+
+  explicit queueable_pool_t(const size_t &capacity)
+  : arena_(sizeof(T) + slack, capacity) {}
+
+  template<typename... ARGS>
+  std::shared_ptr<T> make(ARGS&&... args)
+  {
+    return std::allocate_shared<T>(SlabAllocator<T>(&arena_), std::forward<ARGS>(args)...);
+  }
+
+  size_t   capacity() const { return arena_.block_count(); }
+  bool     move_to_node(const int &node) const { return arena_.move_to_node(node); }
+  uint64_t misses  () const { return arena_.misses(); }
+
+protected:
+  SlabArena arena_;
+};
+
 using queueable_str_t = queueable_t<std::string>;
 
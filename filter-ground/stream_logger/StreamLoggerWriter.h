@@ -49,17 +49,27 @@ public:
 protected:
   void run() override
   {
-    queueable_t<StreamLoggerData> item;
-    while (waiter_.pop(item) >= 0)
+    queueable_t<StreamLoggerData> items[bulk_size];
+    int count = 0;
+    while ((count = waiter_.pop_bulk(items, bulk_size)) >= 0)
     {
-      auto data = item.take();
-
-      if (user_log_func != nullptr)
-        if (user_log_func(*(data.get())) == false)
-          continue;
-
-      /// 요구사항이 표준출력임.
-      std::cout << data->to_json() << std::endl;
+      bool written = false;
+      for (int index = 0; index < count; ++index)
+      {
+        auto data = items[index].take();
+
+        if (user_log_func != nullptr)
+          if (user_log_func(*(data.get())) == false)
+            continue;
+
+        /// 요구사항이 표준출력임.
+        std::cout << data->to_json() << '\n';
+        written = true;
+      }
+
+      /// 배치당 한번만 flush
+      if (written == true)
+        std::cout.flush();
     }
   }
 };